@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @file     cert-server-bundle.h
+ * @version  1.0
+ * @brief    ca-certificate bundle maintainer.
+ */
+
+#ifndef CERT_SERVER_BUNDLE_H_
+#define CERT_SERVER_BUNDLE_H_
+
+#include <stdbool.h>
+
+#include <cert-svc/ccert.h>
+
+/*
+ * In-memory image of the bundle file (TZ_SYS_CA_BUNDLE) with the byte range
+ * of each certificate, keyed by store type and gname.
+ *   - bundle_append/bundle_remove only change the image.
+ *   - bundle_flush writes the changes at once. Appended certificates are
+ *     written with one append, otherwise the whole image is written to a
+ *     temporary file with the owner, mode and smack label of the bundle,
+ *     which is renamed over it.
+ *   - After each flush the byte ranges are saved to CERTSVC_BUNDLE_INDEX
+ *     with the size, inode and mtime of the bundle, so the next server
+ *     loads the image with bundle_load instead of rebuilding it. Lookups
+ *     by store type and gname go through a hash of the loaded index.
+ *
+ * It is not thread-safe. Only the writer of the store should use it.
+ */
+
+/* Start a new image which replaces the bundle on the next flush. */
+int bundle_reset(void);
+
+/* Load the image from the saved index if it still matches the bundle. */
+int bundle_load(void);
+
+/* Drop the image. The bundle should be rebuilt before the next change. */
+void bundle_unload(void);
+
+bool bundle_is_loaded(void);
+bool bundle_contains(CertStoreType storeType, const char *gname);
+
+int bundle_append(CertStoreType storeType, const char *gname, const char *cert);
+int bundle_remove(CertStoreType storeType, const char *gname);
+
+/* On failure the image is dropped, since it does not match the file. */
+int bundle_flush(void);
+
+#endif // CERT_SERVER_BUNDLE_H_
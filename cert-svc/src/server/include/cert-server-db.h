@@ -26,7 +26,8 @@
 #include <sqlite3.h>
 #include <cert-svc/cerror.h>
 
-extern sqlite3 *cert_store_db;
+/* Each thread which touches the store has its own connection. */
+extern __thread sqlite3 *cert_store_db;
 
 typedef enum schema_version_t {
 	TIZEN_2_4 =  1,
@@ -34,7 +35,10 @@ typedef enum schema_version_t {
 } schema_version;
 
 int initialize_db(void);
+/* Close the connection of the calling thread. */
 void deinitialize_db(void);
+/* Close the connections of all threads, e.g. at shutdown. */
+void deinitialize_all_db(void);
 int execute_insert_update_query(const char *query);
 int execute_select_query(const char *query, sqlite3_stmt **stmt);
 int get_schema_version(schema_version *version);
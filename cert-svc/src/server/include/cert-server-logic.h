@@ -58,6 +58,11 @@ int loadCertificatesFromStore(CertStoreType storeType, const char *gname,
 							  char **ppCertBlockBuffer,
 							  size_t *bufferLen, size_t *certBlockCount);
 
-int update_ca_certificate_file(char *cert);
+/* Rebuild the bundle with every enabled root certificate. */
+int update_ca_certificate_file(void);
+
+/* Add or remove the certificate in the bundle according to the store. */
+int update_ca_certificate_entry(CertStoreType storeType, const char *gname,
+								const char *cert);
 
 #endif
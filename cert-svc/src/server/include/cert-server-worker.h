@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @file     cert-server-worker.h
+ * @version  1.0
+ * @brief    cert-server worker threads.
+ */
+
+#ifndef CERT_SERVER_WORKER_H_
+#define CERT_SERVER_WORKER_H_
+
+#include <stddef.h>
+
+/* db_result is the result of opening the database connection of the thread. */
+typedef void (*worker_handler)(void *job, int db_result);
+
+typedef struct worker_pool_t worker_pool;
+
+/*
+ * Jobs are handled in FIFO order by the threads of the pool.
+ * Each thread opens its own database connection, so a pool with a single
+ * thread serializes the jobs pushed to it. If the connection cannot be
+ * opened, it is retried for the next job and the handler gets the failure.
+ */
+worker_pool *worker_pool_create(size_t threads, worker_handler handler);
+int worker_pool_push(worker_pool *pool, void *job);
+
+/* Handle the remaining jobs, then join the threads and free the pool. */
+void worker_pool_destroy(worker_pool *pool);
+
+#endif // CERT_SERVER_WORKER_H_
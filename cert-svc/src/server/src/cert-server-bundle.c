@@ -0,0 +1,729 @@
+/**
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @file     cert-server-bundle.c
+ * @version  1.0
+ * @brief    ca-certificate bundle maintainer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+
+#include <cert-svc/cerror.h>
+
+#include <cert-server-debug.h>
+#include <cert-server-bundle.h>
+
+#define BUNDLE_TEMP_SUFFIX ".tmp"
+#define BUNDLE_SMACK_LABEL "security.SMACK64"
+#define BUNDLE_SMACK_LABEL_MAX 256
+#define BUNDLE_INDEX_MAGIC 0x58444943 /* "CIDX" */
+#define BUNDLE_INDEX_VERSION 1
+
+/* On-disk index: a header followed by a record and the gname per entry. */
+typedef struct bundle_index_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+	uint64_t ino;
+	int64_t mtimeSec;
+	int64_t mtimeNsec;
+	uint64_t count;
+} bundle_index_header;
+
+typedef struct bundle_index_entry_t {
+	int32_t storeType;
+	uint32_t gnameLen;
+	uint64_t offset;
+	uint64_t length;
+} bundle_index_entry;
+
+typedef struct bundle_entry_t {
+	CertStoreType storeType;
+	char *gname;
+	size_t offset;
+	size_t length;
+} bundle_entry;
+
+typedef struct bundle_t {
+	bool loaded;
+
+	char *data;
+	size_t size;
+	size_t capacity;
+
+	bundle_entry *entries;
+	size_t count;
+	size_t entryCapacity;
+
+	/* open addressing on (storeType, gname). a slot is an entry index + 1. */
+	size_t *slots;
+	size_t slotCount;
+
+	/* data[0, flushed) is the same as the file if not compacted. */
+	size_t flushed;
+	bool compacted;
+} bundle;
+
+static bundle ca_bundle = {
+	false, NULL, 0, 0, NULL, 0, 0, NULL, 0, 0, false
+};
+
+static int reserve_data(size_t size)
+{
+	if (size <= ca_bundle.capacity)
+		return CERTSVC_SUCCESS;
+
+	size_t capacity = ca_bundle.capacity ? ca_bundle.capacity : 64 * 1024;
+
+	while (capacity < size)
+		capacity *= 2;
+
+	char *data = (char *)realloc(ca_bundle.data, capacity);
+
+	if (data == NULL) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	ca_bundle.data = data;
+	ca_bundle.capacity = capacity;
+	return CERTSVC_SUCCESS;
+}
+
+static int reserve_entry(void)
+{
+	if (ca_bundle.count < ca_bundle.entryCapacity)
+		return CERTSVC_SUCCESS;
+
+	size_t capacity = ca_bundle.entryCapacity ? ca_bundle.entryCapacity * 2 : 256;
+	bundle_entry *entries = (bundle_entry *)realloc(ca_bundle.entries,
+							capacity * sizeof(bundle_entry));
+
+	if (entries == NULL) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	ca_bundle.entries = entries;
+	ca_bundle.entryCapacity = capacity;
+	return CERTSVC_SUCCESS;
+}
+
+static size_t hash_entry(CertStoreType storeType, const char *gname)
+{
+	/* FNV-1a */
+	size_t hash = 2166136261u ^ (size_t)storeType;
+
+	while (*gname != '\0') {
+		hash ^= (unsigned char)*gname++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static void insert_slot(size_t index)
+{
+	const bundle_entry *entry = ca_bundle.entries + index;
+	size_t mask = ca_bundle.slotCount - 1;
+	size_t slot = hash_entry(entry->storeType, entry->gname) & mask;
+
+	while (ca_bundle.slots[slot] != 0)
+		slot = (slot + 1) & mask;
+
+	ca_bundle.slots[slot] = index + 1;
+}
+
+/* Rebuild the slots of all entries, growing them to keep the load under half. */
+static int rebuild_slots(size_t count)
+{
+	size_t slotCount = ca_bundle.slotCount ? ca_bundle.slotCount : 512;
+	size_t i;
+
+	while (slotCount < count * 2)
+		slotCount *= 2;
+
+	if (slotCount != ca_bundle.slotCount) {
+		size_t *slots = (size_t *)realloc(ca_bundle.slots, slotCount * sizeof(size_t));
+
+		if (slots == NULL) {
+			SLOGE("Failed to allocate memory.");
+			return CERTSVC_BAD_ALLOC;
+		}
+
+		ca_bundle.slots = slots;
+		ca_bundle.slotCount = slotCount;
+	}
+
+	memset(ca_bundle.slots, 0x00, ca_bundle.slotCount * sizeof(size_t));
+
+	for (i = 0; i < ca_bundle.count; i++)
+		insert_slot(i);
+
+	return CERTSVC_SUCCESS;
+}
+
+static bundle_entry *find_entry(CertStoreType storeType, const char *gname)
+{
+	if (ca_bundle.slotCount == 0)
+		return NULL;
+
+	size_t mask = ca_bundle.slotCount - 1;
+	size_t slot = hash_entry(storeType, gname) & mask;
+
+	while (ca_bundle.slots[slot] != 0) {
+		bundle_entry *entry = ca_bundle.entries + ca_bundle.slots[slot] - 1;
+
+		if (entry->storeType == storeType && strcmp(entry->gname, gname) == 0)
+			return entry;
+
+		slot = (slot + 1) & mask;
+	}
+
+	return NULL;
+}
+
+static void clear_entries(void)
+{
+	size_t i;
+
+	for (i = 0; i < ca_bundle.count; i++)
+		free(ca_bundle.entries[i].gname);
+
+	ca_bundle.count = 0;
+	ca_bundle.size = 0;
+	ca_bundle.flushed = 0;
+
+	if (ca_bundle.slots != NULL)
+		memset(ca_bundle.slots, 0x00, ca_bundle.slotCount * sizeof(size_t));
+}
+
+int bundle_reset(void)
+{
+	clear_entries();
+
+	ca_bundle.loaded = true;
+	ca_bundle.compacted = true;
+	return CERTSVC_SUCCESS;
+}
+
+void bundle_unload(void)
+{
+	clear_entries();
+
+	free(ca_bundle.data);
+	free(ca_bundle.entries);
+	free(ca_bundle.slots);
+
+	ca_bundle.data = NULL;
+	ca_bundle.capacity = 0;
+	ca_bundle.entries = NULL;
+	ca_bundle.entryCapacity = 0;
+	ca_bundle.slots = NULL;
+	ca_bundle.slotCount = 0;
+	ca_bundle.compacted = false;
+	ca_bundle.loaded = false;
+}
+
+bool bundle_is_loaded(void)
+{
+	return ca_bundle.loaded;
+}
+
+bool bundle_contains(CertStoreType storeType, const char *gname)
+{
+	if (!ca_bundle.loaded || gname == NULL)
+		return false;
+
+	return find_entry(storeType, gname) != NULL;
+}
+
+int bundle_append(CertStoreType storeType, const char *gname, const char *cert)
+{
+	if (!ca_bundle.loaded || gname == NULL || cert == NULL || strlen(cert) == 0) {
+		SLOGE("Invalid input parameter passed.");
+		return CERTSVC_WRONG_ARGUMENT;
+	}
+
+	/* adding empty line at the end */
+	size_t cert_len = strlen(cert);
+	size_t length = cert_len + 1;
+
+	if (reserve_data(ca_bundle.size + length) != CERTSVC_SUCCESS ||
+			reserve_entry() != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	if ((ca_bundle.count + 1) * 2 > ca_bundle.slotCount &&
+			rebuild_slots(ca_bundle.count + 1) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	char *name = strdup(gname);
+
+	if (name == NULL) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	bundle_entry *entry = ca_bundle.entries + ca_bundle.count++;
+	entry->storeType = storeType;
+	entry->gname = name;
+	entry->offset = ca_bundle.size;
+	entry->length = length;
+	insert_slot(ca_bundle.count - 1);
+
+	memcpy(ca_bundle.data + ca_bundle.size, cert, cert_len);
+	ca_bundle.data[ca_bundle.size + cert_len] = '\n';
+	ca_bundle.size += length;
+
+	return CERTSVC_SUCCESS;
+}
+
+int bundle_remove(CertStoreType storeType, const char *gname)
+{
+	if (!ca_bundle.loaded || gname == NULL) {
+		SLOGE("Invalid input parameter passed.");
+		return CERTSVC_WRONG_ARGUMENT;
+	}
+
+	bundle_entry *entry = find_entry(storeType, gname);
+
+	if (entry == NULL)
+		return CERTSVC_SUCCESS;
+
+	size_t offset = entry->offset;
+	size_t length = entry->length;
+	size_t index = entry - ca_bundle.entries;
+	size_t i;
+
+	memmove(ca_bundle.data + offset, ca_bundle.data + offset + length,
+			ca_bundle.size - offset - length);
+	ca_bundle.size -= length;
+
+	free(entry->gname);
+	memmove(entry, entry + 1, (ca_bundle.count - index - 1) * sizeof(bundle_entry));
+	ca_bundle.count--;
+
+	for (i = index; i < ca_bundle.count; i++)
+		ca_bundle.entries[i].offset -= length;
+
+	ca_bundle.compacted = true;
+
+	/* the following entries moved down, so their slots are stale. */
+	return rebuild_slots(ca_bundle.count);
+}
+
+static int write_all(int fd, const char *data, size_t length)
+{
+	while (length > 0) {
+		ssize_t res = write(fd, data, length);
+
+		if (res < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return CERTSVC_FAIL;
+		}
+
+		data += res;
+		length -= res;
+	}
+
+	return CERTSVC_SUCCESS;
+}
+
+static int read_all(int fd, char *data, size_t length)
+{
+	while (length > 0) {
+		ssize_t res = read(fd, data, length);
+
+		if (res < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return CERTSVC_FAIL;
+		}
+
+		if (res == 0)
+			return CERTSVC_FAIL;
+
+		data += res;
+		length -= res;
+	}
+
+	return CERTSVC_SUCCESS;
+}
+
+static void to_index_stat(const struct stat *st, bundle_index_header *header)
+{
+	header->size = (uint64_t)st->st_size;
+	header->ino = (uint64_t)st->st_ino;
+	header->mtimeSec = (int64_t)st->st_mtim.tv_sec;
+	header->mtimeNsec = (int64_t)st->st_mtim.tv_nsec;
+}
+
+static void remove_index(void)
+{
+	if (unlink(CERTSVC_BUNDLE_INDEX) != 0 && errno != ENOENT)
+		SLOGE("Failed to remove the index, [%s]. errno[%d]", CERTSVC_BUNDLE_INDEX, errno);
+}
+
+/*
+ * The index is only valid for the bundle file it was written with.
+ * It is written to a temporary file in the same directory and renamed,
+ * so a partially written index is never loaded.
+ */
+static int save_index(void)
+{
+	struct stat st;
+	bundle_index_header header;
+	char *temp = NULL;
+	size_t i;
+
+	if (stat(TZ_SYS_CA_BUNDLE, &st) != 0) {
+		SLOGE("Failed to stat the file, [%s]. errno[%d]", TZ_SYS_CA_BUNDLE, errno);
+		return CERTSVC_FAIL;
+	}
+
+	memset(&header, 0x00, sizeof(header));
+	header.magic = BUNDLE_INDEX_MAGIC;
+	header.version = BUNDLE_INDEX_VERSION;
+	header.count = ca_bundle.count;
+	to_index_stat(&st, &header);
+
+	if (asprintf(&temp, "%s%s", CERTSVC_BUNDLE_INDEX, BUNDLE_TEMP_SUFFIX) < 0) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+
+	if (fd < 0) {
+		SLOGE("Failed to open the file for writing, [%s]. errno[%d]", temp, errno);
+		free(temp);
+		return CERTSVC_FAIL;
+	}
+
+	int result = write_all(fd, (const char *)&header, sizeof(header));
+
+	for (i = 0; i < ca_bundle.count && result == CERTSVC_SUCCESS; i++) {
+		const bundle_entry *entry = ca_bundle.entries + i;
+		bundle_index_entry record;
+
+		memset(&record, 0x00, sizeof(record));
+		record.storeType = (int32_t)entry->storeType;
+		record.gnameLen = (uint32_t)strlen(entry->gname);
+		record.offset = entry->offset;
+		record.length = entry->length;
+
+		result = write_all(fd, (const char *)&record, sizeof(record));
+
+		if (result == CERTSVC_SUCCESS)
+			result = write_all(fd, entry->gname, record.gnameLen);
+	}
+
+	if (result == CERTSVC_SUCCESS && fsync(fd) != 0)
+		result = CERTSVC_FAIL;
+
+	if (result != CERTSVC_SUCCESS)
+		SLOGE("Fail to write into file. errno[%d]", errno);
+
+	close(fd);
+
+	if (result == CERTSVC_SUCCESS && rename(temp, CERTSVC_BUNDLE_INDEX) != 0) {
+		SLOGE("Failed to replace the file, [%s]. errno[%d]", CERTSVC_BUNDLE_INDEX, errno);
+		result = CERTSVC_FAIL;
+	}
+
+	if (result != CERTSVC_SUCCESS)
+		unlink(temp);
+
+	free(temp);
+	return result;
+}
+
+static int load_index(int fd)
+{
+	bundle_index_header header;
+	struct stat st;
+	bundle_index_header current;
+	uint64_t i;
+
+	if (read_all(fd, (char *)&header, sizeof(header)) != CERTSVC_SUCCESS ||
+			header.magic != BUNDLE_INDEX_MAGIC ||
+			header.version != BUNDLE_INDEX_VERSION) {
+		SLOGD("The index is not readable.");
+		return CERTSVC_FAIL;
+	}
+
+	if (stat(TZ_SYS_CA_BUNDLE, &st) != 0) {
+		SLOGD("Failed to stat the file, [%s]. errno[%d]", TZ_SYS_CA_BUNDLE, errno);
+		return CERTSVC_FAIL;
+	}
+
+	/* the bundle was changed after the index was written. */
+	memset(&current, 0x00, sizeof(current));
+	to_index_stat(&st, &current);
+
+	if (header.size != current.size || header.ino != current.ino ||
+			header.mtimeSec != current.mtimeSec || header.mtimeNsec != current.mtimeNsec) {
+		SLOGD("The index does not match the bundle.");
+		return CERTSVC_FAIL;
+	}
+
+	if (reserve_data(header.size) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	int bundleFd = open(TZ_SYS_CA_BUNDLE, O_RDONLY | O_CLOEXEC);
+
+	if (bundleFd < 0) {
+		SLOGE("Failed to open the file for reading, [%s]. errno[%d]", TZ_SYS_CA_BUNDLE, errno);
+		return CERTSVC_FAIL;
+	}
+
+	int result = read_all(bundleFd, ca_bundle.data, header.size);
+	close(bundleFd);
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Fail to read the file, [%s]. errno[%d]", TZ_SYS_CA_BUNDLE, errno);
+		return CERTSVC_FAIL;
+	}
+
+	ca_bundle.size = header.size;
+
+	/* entries cover the bundle from the beginning to the end in order. */
+	size_t offset = 0;
+
+	for (i = 0; i < header.count; i++) {
+		bundle_index_entry record;
+
+		if (read_all(fd, (char *)&record, sizeof(record)) != CERTSVC_SUCCESS ||
+				record.gnameLen == 0 || record.offset != offset ||
+				record.length == 0 || record.length > header.size - offset)
+			return CERTSVC_FAIL;
+
+		if (reserve_entry() != CERTSVC_SUCCESS)
+			return CERTSVC_BAD_ALLOC;
+
+		char *name = (char *)malloc(record.gnameLen + 1);
+
+		if (name == NULL) {
+			SLOGE("Failed to allocate memory.");
+			return CERTSVC_BAD_ALLOC;
+		}
+
+		if (read_all(fd, name, record.gnameLen) != CERTSVC_SUCCESS) {
+			free(name);
+			return CERTSVC_FAIL;
+		}
+
+		name[record.gnameLen] = '\0';
+
+		bundle_entry *entry = ca_bundle.entries + ca_bundle.count++;
+		entry->storeType = (CertStoreType)record.storeType;
+		entry->gname = name;
+		entry->offset = record.offset;
+		entry->length = record.length;
+
+		offset += record.length;
+	}
+
+	if (offset != header.size)
+		return CERTSVC_FAIL;
+
+	return rebuild_slots(ca_bundle.count);
+}
+
+int bundle_load(void)
+{
+	if (ca_bundle.loaded)
+		return CERTSVC_SUCCESS;
+
+	int fd = open(CERTSVC_BUNDLE_INDEX, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0) {
+		if (errno != ENOENT)
+			SLOGE("Failed to open the file for reading, [%s]. errno[%d]",
+				  CERTSVC_BUNDLE_INDEX, errno);
+
+		return CERTSVC_FAIL;
+	}
+
+	int result = load_index(fd);
+	close(fd);
+
+	if (result != CERTSVC_SUCCESS) {
+		clear_entries();
+		remove_index();
+		return result;
+	}
+
+	ca_bundle.flushed = ca_bundle.size;
+	ca_bundle.compacted = false;
+	ca_bundle.loaded = true;
+
+	SLOGD("Successfully loaded bundle index. cert num[%zu], size[%zu]",
+		  ca_bundle.count, ca_bundle.size);
+	return CERTSVC_SUCCESS;
+}
+
+static int append_file(void)
+{
+	int fd = open(TZ_SYS_CA_BUNDLE, O_WRONLY | O_APPEND | O_CLOEXEC);
+
+	if (fd < 0) {
+		SLOGE("Failed to open the file for writing, [%s]. errno[%d]",
+			  TZ_SYS_CA_BUNDLE, errno);
+		return CERTSVC_FAIL;
+	}
+
+	int result = write_all(fd, ca_bundle.data + ca_bundle.flushed,
+						   ca_bundle.size - ca_bundle.flushed);
+
+	if (result == CERTSVC_SUCCESS && fsync(fd) != 0)
+		result = CERTSVC_FAIL;
+
+	if (result != CERTSVC_SUCCESS)
+		SLOGE("Fail to write into file. errno[%d]", errno);
+
+	close(fd);
+	return result;
+}
+
+/*
+ * The bundle is owned by the ca-certificates package, so the temporary file
+ * takes over its owner, mode and smack label before it replaces the bundle.
+ */
+static int copy_attributes(int fd, const char *path)
+{
+	struct stat st;
+	char label[BUNDLE_SMACK_LABEL_MAX];
+
+	if (stat(path, &st) != 0) {
+		if (errno == ENOENT)
+			return CERTSVC_SUCCESS;
+
+		SLOGE("Failed to stat the file, [%s]. errno[%d]", path, errno);
+		return CERTSVC_FAIL;
+	}
+
+	if (fchown(fd, st.st_uid, st.st_gid) != 0 || fchmod(fd, st.st_mode & 07777) != 0) {
+		SLOGE("Failed to copy the owner and mode of [%s]. errno[%d]", path, errno);
+		return CERTSVC_FAIL;
+	}
+
+	ssize_t len = getxattr(path, BUNDLE_SMACK_LABEL, label, sizeof(label));
+
+	if (len < 0) {
+		if (errno == ENODATA || errno == ENOTSUP)
+			return CERTSVC_SUCCESS;
+
+		SLOGE("Failed to get the smack label of [%s]. errno[%d]", path, errno);
+		return CERTSVC_FAIL;
+	}
+
+	if (fsetxattr(fd, BUNDLE_SMACK_LABEL, label, (size_t)len, 0) != 0) {
+		SLOGE("Failed to set the smack label of [%s]. errno[%d]", path, errno);
+		return CERTSVC_FAIL;
+	}
+
+	return CERTSVC_SUCCESS;
+}
+
+/*
+ * The image is written to a temporary file in the same directory and renamed
+ * over the bundle, so readers and a crash only see the old or the new bundle.
+ */
+static int rewrite_file(void)
+{
+	char *temp = NULL;
+
+	if (asprintf(&temp, "%s%s", TZ_SYS_CA_BUNDLE, BUNDLE_TEMP_SUFFIX) < 0) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	if (fd < 0) {
+		SLOGE("Failed to open the file for writing, [%s]. errno[%d]", temp, errno);
+		free(temp);
+		return CERTSVC_FAIL;
+	}
+
+	int result = write_all(fd, ca_bundle.data, ca_bundle.size);
+
+	if (result == CERTSVC_SUCCESS && fsync(fd) != 0)
+		result = CERTSVC_FAIL;
+
+	if (result != CERTSVC_SUCCESS)
+		SLOGE("Fail to write into file. errno[%d]", errno);
+	else
+		result = copy_attributes(fd, TZ_SYS_CA_BUNDLE);
+
+	close(fd);
+
+	if (result == CERTSVC_SUCCESS && rename(temp, TZ_SYS_CA_BUNDLE) != 0) {
+		SLOGE("Failed to replace the file, [%s]. errno[%d]", TZ_SYS_CA_BUNDLE, errno);
+		result = CERTSVC_FAIL;
+	}
+
+	if (result != CERTSVC_SUCCESS)
+		unlink(temp);
+
+	free(temp);
+	return result;
+}
+
+int bundle_flush(void)
+{
+	if (!ca_bundle.loaded) {
+		SLOGE("Bundle is not loaded.");
+		return CERTSVC_FAIL;
+	}
+
+	if (!ca_bundle.compacted && ca_bundle.flushed == ca_bundle.size)
+		return CERTSVC_SUCCESS;
+
+	/* a stale index must not outlive a partially written bundle. */
+	remove_index();
+
+	int result = ca_bundle.compacted ? rewrite_file() : append_file();
+
+	if (result != CERTSVC_SUCCESS) {
+		bundle_unload();
+		return result;
+	}
+
+	ca_bundle.flushed = ca_bundle.size;
+	ca_bundle.compacted = false;
+
+	/* without the index the next server rebuilds the bundle once. */
+	if (save_index() != CERTSVC_SUCCESS)
+		remove_index();
+
+	SLOGD("Successfully flushed bundle file. cert num[%zu], size[%zu]",
+		  ca_bundle.count, ca_bundle.size);
+	return CERTSVC_SUCCESS;
+}
@@ -20,10 +20,66 @@
  * @brief    cert server db utils.
  */
 
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <cert-server-debug.h>
 #include <cert-server-db.h>
 
-sqlite3 *cert_store_db = NULL;
+/* Wait for the lock of the other connections instead of failing at once. */
+#define CERT_STORE_DB_BUSY_TIMEOUT 5000 // ms
+
+__thread sqlite3 *cert_store_db = NULL;
+
+/* The connections of all threads, so that they are closed at shutdown. */
+static pthread_mutex_t open_dbs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sqlite3 **open_dbs = NULL;
+static size_t open_dbs_count = 0;
+static size_t open_dbs_capacity = 0;
+
+static int register_db(sqlite3 *db)
+{
+	int result = CERTSVC_SUCCESS;
+
+	pthread_mutex_lock(&open_dbs_mutex);
+
+	if (open_dbs_count == open_dbs_capacity) {
+		size_t capacity = open_dbs_capacity ? open_dbs_capacity * 2 : 8;
+		sqlite3 **dbs = (sqlite3 **)realloc(open_dbs, capacity * sizeof(sqlite3 *));
+
+		if (dbs == NULL) {
+			SLOGE("Failed to allocate memory.");
+			result = CERTSVC_BAD_ALLOC;
+			goto exit;
+		}
+
+		open_dbs = dbs;
+		open_dbs_capacity = capacity;
+	}
+
+	open_dbs[open_dbs_count++] = db;
+
+exit:
+	pthread_mutex_unlock(&open_dbs_mutex);
+	return result;
+}
+
+static void unregister_db(sqlite3 *db)
+{
+	size_t i;
+
+	pthread_mutex_lock(&open_dbs_mutex);
+
+	for (i = 0; i < open_dbs_count; i++) {
+		if (open_dbs[i] == db) {
+			open_dbs[i] = open_dbs[--open_dbs_count];
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&open_dbs_mutex);
+}
 
 int initialize_db(void)
 {
@@ -34,10 +90,25 @@ int initialize_db(void)
 
 	if (result != SQLITE_OK) {
 		SLOGE("opening %s failed!", CERTSVC_SYSTEM_STORE_DB);
+		sqlite3_close(cert_store_db);
 		cert_store_db = NULL;
 		return CERTSVC_FAIL;
 	}
 
+	if (register_db(cert_store_db) != CERTSVC_SUCCESS) {
+		sqlite3_close(cert_store_db);
+		cert_store_db = NULL;
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	sqlite3_busy_timeout(cert_store_db, CERT_STORE_DB_BUSY_TIMEOUT);
+
+	/* With the write-ahead log, readers do not wait for the writer. */
+	result = sqlite3_exec(cert_store_db, "PRAGMA journal_mode=WAL", NULL, NULL, NULL);
+
+	if (result != SQLITE_OK)
+		SLOGE("Failed to set journal mode to WAL. result[%d]", result);
+
 	return CERTSVC_SUCCESS;
 }
 
@@ -46,10 +117,31 @@ void deinitialize_db(void)
 	if (cert_store_db == NULL)
 		return;
 
+	unregister_db(cert_store_db);
 	sqlite3_close(cert_store_db);
 	cert_store_db = NULL;
 }
 
+void deinitialize_all_db(void)
+{
+	size_t i;
+
+	pthread_mutex_lock(&open_dbs_mutex);
+
+	/* a connection of another thread may still have a statement. */
+	for (i = 0; i < open_dbs_count; i++)
+		sqlite3_close_v2(open_dbs[i]);
+
+	free(open_dbs);
+	open_dbs = NULL;
+	open_dbs_count = 0;
+	open_dbs_capacity = 0;
+
+	pthread_mutex_unlock(&open_dbs_mutex);
+
+	cert_store_db = NULL;
+}
+
 int execute_insert_update_query(const char *query)
 {
 	if (!cert_store_db) {
@@ -63,7 +155,7 @@ int execute_insert_update_query(const char *query)
 	}
 
 	/* Begin transaction */
-	int result = sqlite3_exec(cert_store_db, "BEGIN EXCLUSIVE", NULL, NULL, NULL);
+	int result = sqlite3_exec(cert_store_db, "BEGIN IMMEDIATE", NULL, NULL, NULL);
 
 	if (result != SQLITE_OK) {
 		SLOGE("Failed to begin transaction.");
@@ -75,6 +167,8 @@ int execute_insert_update_query(const char *query)
 
 	if (result != SQLITE_OK) {
 		SLOGE("Failed to execute query (%s).", query);
+		/* Do not keep the write lock, the other connections wait for it. */
+		sqlite3_exec(cert_store_db, "ROLLBACK", NULL, NULL, NULL);
 		return CERTSVC_FAIL;
 	}
 
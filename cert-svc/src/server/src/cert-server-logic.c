@@ -43,6 +43,7 @@
 #include <cert-server-debug.h>
 #include <cert-server-logic.h>
 #include <cert-server-db.h>
+#include <cert-server-bundle.h>
 
 static CertStatus int_to_CertStatus(int intval)
 {
@@ -210,48 +211,6 @@ out:
 	return ret;
 }
 
-int write_to_ca_cert_crt_file(const char *mode, const char *cert)
-{
-	int result = CERTSVC_SUCCESS;
-	FILE *fp = NULL;
-
-	if (cert == NULL || strlen(cert) == 0) {
-		SLOGE("Input buffer is NULL.");
-		return CERTSVC_WRONG_ARGUMENT;
-	}
-
-	if (!(fp = fopen(TZ_SYS_CA_BUNDLE, mode))) {
-		SLOGE("Failed to open the file for writing, [%s].", TZ_SYS_CA_BUNDLE);
-		return CERTSVC_FAIL;
-	}
-
-	/* if mode of writing is to append, then goto end of file */
-	if (strcmp(mode, "ab") == 0) {
-		if (fseek(fp, 0L, SEEK_END) != 0) {
-			SLOGE("Fail in fseek.");
-			result = CERTSVC_FAIL;
-			goto error;
-		}
-	}
-
-	size_t cert_len = strlen(cert);
-
-	if (fwrite(cert, sizeof(char), cert_len, fp) != cert_len) {
-		SLOGE("Fail to write into file.");
-		result = CERTSVC_FAIL;
-		goto error;
-	}
-
-	/* adding empty line at the end */
-	fwrite("\n", sizeof(char), 1, fp);
-error:
-
-	if (fp)
-		fclose(fp);
-
-	return result;
-}
-
 int saveCertificateToStore(const char *gname, const char *cert)
 {
 	if (!gname || !cert) {
@@ -374,37 +333,24 @@ error:
 	return result;
 }
 
-int update_ca_certificate_file(char *cert)
+int update_ca_certificate_file(void)
 {
 	int result = CERTSVC_SUCCESS;
 	int records = 0;
-	int counter = 0;
 	char *gname = NULL;
+	char *cert = NULL;
 	char *query = NULL;
 	const char *text;
 	sqlite3_stmt *stmt = NULL;
 	CertStoreType storeType;
 
-	/*
-	 * During install of a root certificate, the root certificate gets appended at
-	 * the end to optimise the write operation onto ca-certificate.crt file.
-	 */
-	if (cert != NULL && strlen(cert) > 0) {
-		result = write_to_ca_cert_crt_file("ab", cert);
-
-		if (result != CERTSVC_SUCCESS) {
-			SLOGE("Failed to write to file. result[%d]", result);
-			return result;
-		}
-
-		SLOGD("Successfully update bundle file.");
-		return CERTSVC_SUCCESS;
-	}
+	/* every certificate is collected in memory, then written at once. */
+	bundle_reset();
 
 	for (storeType = VPN_STORE; storeType != NONE_STORE;
 			storeType = nextStore(storeType)) {
 		if (storeType == SYSTEM_STORE)
-			query = sqlite3_mprintf("select certificate from ssl where enabled=%d and is_root_app_enabled=%d",
+			query = sqlite3_mprintf("select gname, certificate from ssl where enabled=%d and is_root_app_enabled=%d",
 									ENABLED, ENABLED);
 		else
 			query = sqlite3_mprintf("select gname from %Q where is_root_cert=%d and enabled=%d and is_root_app_enabled=%d",
@@ -437,23 +383,24 @@ int update_ca_certificate_file(char *cert)
 
 			cert = NULL;
 			gname = NULL;
+			text = (const char *)sqlite3_column_text(stmt, 0);
+
+			if (text) {
+				gname = strndup(text, strlen(text));
+
+				if (!gname) {
+					SLOGE("Memory allocation failed");
+					result = CERTSVC_BAD_ALLOC;
+					goto error_and_exit;
+				}
+			}
 
 			if (storeType == SYSTEM_STORE) {
-				text = (const char *)sqlite3_column_text(stmt, 0);
+				text = (const char *)sqlite3_column_text(stmt, 1);
 
 				if (text)
 					cert = strndup(text, strlen(text));
 			} else {
-				text = (const char *)sqlite3_column_text(stmt, 0);
-
-				if (text) {
-					gname = strndup(text, strlen(text));
-					if (!gname) {
-						SLOGE("Memory allocation failed");
-						goto error_and_exit;
-					}
-				}
-
 				result = get_certificate_buffer_from_store(storeType, gname, &cert);
 
 				if (result != CERTSVC_SUCCESS) {
@@ -461,38 +408,175 @@ int update_ca_certificate_file(char *cert)
 					free(gname);
 					goto error_and_exit;
 				}
-				free(gname);
 			}
 
-			if (cert == NULL) {
+			if (cert == NULL || gname == NULL) {
 				SLOGE("Failed to extract cert buffer to update ca-certificate.");
+				free(gname);
+				free(cert);
 				result = CERTSVC_FAIL;
 				goto error_and_exit;
 			}
 
-			if (counter++ == 0)
-				result = write_to_ca_cert_crt_file("wb", cert);
-			else
-				result = write_to_ca_cert_crt_file("ab", cert);
+			result = bundle_append(storeType, gname, cert);
+			free(gname);
 			free(cert);
 
 			if (result != CERTSVC_SUCCESS) {
-				SLOGE("Failed to write to file.");
-				result = CERTSVC_FAIL;
+				SLOGE("Failed to add certificate to bundle.");
 				goto error_and_exit;
 			}
 		}
+
+		sqlite3_finalize(stmt);
+		stmt = NULL;
+	}
+
+	result = bundle_flush();
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Failed to write to file.");
+		goto error_and_exit;
 	}
 
-	SLOGD("Successfully updated ca-certificate.crt file. added cert num[%d]",
-		  counter);
+	SLOGD("Successfully updated ca-certificate.crt file.");
 error_and_exit:
 
+	if (result != CERTSVC_SUCCESS)
+		bundle_unload();
+
 	sqlite3_finalize(stmt);
 
 	return result;
 }
 
+/*
+ * Check whether the certificate should be in the bundle.
+ * The certificate is returned only if pcert is given.
+ */
+static int get_bundle_certificate(CertStoreType storeType, const char *gname,
+								  bool *exist, char **pcert)
+{
+	int result = CERTSVC_SUCCESS;
+	const char *text = NULL;
+	char *query = NULL;
+	sqlite3_stmt *stmt = NULL;
+
+	if (storeType == SYSTEM_STORE)
+		query = sqlite3_mprintf("select certificate from ssl where gname=%Q and enabled=%d and is_root_app_enabled=%d",
+								gname, ENABLED, ENABLED);
+	else
+		query = sqlite3_mprintf("select gname from %Q where gname=%Q and is_root_cert=%d and enabled=%d and is_root_app_enabled=%d",
+								storetype_to_string(storeType), gname, ENABLED, ENABLED, ENABLED);
+
+	if (!query) {
+		SLOGE("Failed to generate query");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	result = execute_select_query(query, &stmt);
+	sqlite3_free(query);
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Querying database failed.");
+		return result;
+	}
+
+	result = sqlite3_step(stmt);
+
+	if (result == SQLITE_DONE) {
+		*exist = false;
+		result = CERTSVC_SUCCESS;
+		goto exit;
+	}
+
+	if (result != SQLITE_ROW) {
+		SLOGE("DB query error when select. result[%d].", result);
+		result = CERTSVC_FAIL;
+		goto exit;
+	}
+
+	*exist = true;
+	result = CERTSVC_SUCCESS;
+
+	if (pcert == NULL)
+		goto exit;
+
+	if (storeType == SYSTEM_STORE) {
+		text = (const char *)sqlite3_column_text(stmt, 0);
+
+		if (!text || !(*pcert = strdup(text))) {
+			SLOGE("Failed to extract cert buffer to update ca-certificate.");
+			result = CERTSVC_FAIL;
+		}
+	} else {
+		result = get_certificate_buffer_from_store(storeType, gname, pcert);
+	}
+
+exit:
+	sqlite3_finalize(stmt);
+
+	return result;
+}
+
+int update_ca_certificate_entry(CertStoreType storeType, const char *gname,
+								const char *cert)
+{
+	int result = CERTSVC_SUCCESS;
+	char *buffer = NULL;
+	bool exist = false;
+
+	if (!gname) {
+		SLOGE("Invalid input parameter passed.");
+		return CERTSVC_WRONG_ARGUMENT;
+	}
+
+	/*
+	 * the bundle is built once, then changed by the certificate.
+	 * the index saved by the previous server saves the rebuild.
+	 */
+	if (!bundle_is_loaded() && bundle_load() != CERTSVC_SUCCESS)
+		return update_ca_certificate_file();
+
+	bool contained = bundle_contains(storeType, gname);
+	result = get_bundle_certificate(storeType, gname, &exist,
+									(cert == NULL && !contained) ? &buffer : NULL);
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Failed to get certificate for bundle. gname[%s]", gname);
+		return result;
+	}
+
+	if (exist == contained) {
+		SLOGD("Bundle is already up to date. gname[%s]", gname);
+		free(buffer);
+		return CERTSVC_SUCCESS;
+	}
+
+	if (exist)
+		result = bundle_append(storeType, gname, cert != NULL ? cert : buffer);
+	else
+		result = bundle_remove(storeType, gname);
+
+	free(buffer);
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Failed to change bundle. gname[%s]", gname);
+		bundle_unload();
+		return result;
+	}
+
+	result = bundle_flush();
+
+	if (result != CERTSVC_SUCCESS) {
+		SLOGE("Failed to write to file. result[%d]", result);
+		return result;
+	}
+
+	SLOGD("Successfully update bundle file. gname[%s]", gname);
+	return CERTSVC_SUCCESS;
+}
+
 int enable_disable_cert_status(
 	CertStoreType storeType,
 	int is_root_app,
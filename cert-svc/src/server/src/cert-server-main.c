@@ -22,29 +22,94 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/un.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/time.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <systemd/sd-daemon.h>
 
 #include <cert-svc/cerror.h>
 #include <cert-svc/ccert.h>
 #include <vcore/Client.h>
+#include <vcore/ClientProtocol.h>
 
 #include <cert-server-debug.h>
 #include <cert-server-logic.h>
 #include <cert-server-db.h>
+#include <cert-server-worker.h>
+
+/* The server exits when no request comes during this time. */
+#define CERT_SERVER_IDLE_TIMEOUT    10 // sec
+/* A client should send the whole request within this time. */
+#define CERT_SERVER_RECV_TIMEOUT    10 // sec
+#define CERT_SERVER_SEND_TIMEOUT    10 // sec
+#define CERT_SERVER_MAX_EVENTS      32
+#define CERT_SERVER_MAX_READERS     4
+
+/*
+ * A connection is read on the main thread without blocking,
+ * then it is passed to a worker as a job when the request is complete.
+ *   - read-only requests are handled by the reader pool concurrently.
+ *   - requests which change the store are handled by the single writer
+ *     in the order they arrived.
+ *
+ * A client speaks the fixed-size protocol (VcoreRequestData) or the framed
+ * one (vcore/ClientProtocol.h), which is told by the first bytes.
+ * A framed connection returns to the main thread after the response
+ * to wait for the next request.
+ */
+typedef enum {
+	READ_HEADER,
+	READ_FIXED,
+	READ_FRAME
+} read_state;
+
+typedef struct connection_t {
+	int fd;
+	read_state state;
+	bool framed;
+	size_t received;
+	time_t deadline;
+	char *payload;
+	size_t payloadLen;
+	VcoreRequestData request;
+	struct connection_t *prev;
+	struct connection_t *next;
+} connection;
+
+typedef struct response_t {
+	VcoreResponseData data;
+	char *certList;      /* array of VcoreCertResponseData */
+	size_t certListLen;
+	char *certBlocks;    /* array of ResponseCertBlock */
+	size_t certBlocksLen;
+} response;
+
+/* Connections of which the request is not received completely. */
+static connection *pending_head = NULL;
+/* Connections which are handed over to the workers. */
+static int in_flight = 0;
+
+/* Framed connections which are returned by the workers. */
+static pthread_mutex_t returned_mutex = PTHREAD_MUTEX_INITIALIZER;
+static connection *returned_head = NULL;
+static int returned_event = -1;
 
 void CertSigHandler(int signo)
 {
 	SLOGD("Got Signal %d, exiting now.", signo);
-	deinitialize_db();
+	deinitialize_all_db();
 	exit(1);
 }
 
@@ -83,37 +148,592 @@ static int sendBuffer(int socket, const char *buffer, size_t length)
 	return length;
 }
 
-void CertSvcServerComm(void)
+static time_t monotonic_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
+
+static int is_write_request(VcoreRequestType reqType)
+{
+	switch (reqType) {
+	case CERTSVC_DELETE_CERT:
+	case CERTSVC_SET_CERTIFICATE_STATUS:
+	case CERTSVC_INSTALL_CERTIFICATE:
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+static void process_request(VcoreRequestData *recv_data, response *resp)
+{
+	VcoreResponseData *send_data = &resp->data;
+
+	memset(resp, 0x00, sizeof(response));
+	SLOGD("revc request: reqType=%d", recv_data->reqType);
+
+	switch (recv_data->reqType) {
+	case CERTSVC_EXTRACT_CERT: {
+		send_data->result = getCertificateDetailFromStore(
+								recv_data->storeType,
+								recv_data->certType,
+								recv_data->gname,
+								send_data->dataBlock);
+		send_data->dataBlockLen = strlen(send_data->dataBlock);
+		break;
+	}
+
+	case CERTSVC_EXTRACT_SYSTEM_CERT: {
+		send_data->result = getCertificateDetailFromSystemStore(
+								recv_data->gname,
+								send_data->dataBlock);
+		send_data->dataBlockLen = strlen(send_data->dataBlock);
+		break;
+	}
+
+	case CERTSVC_DELETE_CERT: {
+		send_data->result = deleteCertificateFromStore(
+								recv_data->storeType,
+								recv_data->gname);
+
+		if (send_data->result == CERTSVC_SUCCESS)
+			send_data->result = update_ca_certificate_entry(recv_data->storeType,
+								recv_data->gname, NULL);
+
+		break;
+	}
+
+	case CERTSVC_GET_CERTIFICATE_STATUS: {
+		send_data->result = getCertificateStatusFromStore(
+								recv_data->storeType,
+								recv_data->gname,
+								&send_data->certStatus);
+		break;
+	}
+
+	case CERTSVC_SET_CERTIFICATE_STATUS: {
+		send_data->result = setCertificateStatusToStore(
+								recv_data->storeType,
+								recv_data->is_root_app,
+								recv_data->gname,
+								recv_data->certStatus);
+
+		if (send_data->result == CERTSVC_SUCCESS)
+			send_data->result = update_ca_certificate_entry(recv_data->storeType,
+								recv_data->gname, NULL);
+
+		break;
+	}
+
+	case CERTSVC_CHECK_ALIAS_EXISTS: {
+		send_data->result = checkAliasExistsInStore(
+								recv_data->storeType,
+								recv_data->gname,
+								&send_data->isAliasUnique);
+		break;
+	}
+
+	case CERTSVC_INSTALL_CERTIFICATE: {
+		send_data->result = installCertificateToStore(
+								recv_data->storeType,
+								recv_data->gname,
+								recv_data->common_name,
+								recv_data->private_key_gname,
+								recv_data->associated_gname,
+								recv_data->dataBlock,
+								recv_data->certType);
+
+		if (send_data->result == CERTSVC_SUCCESS)
+			if (recv_data->certType == PEM_CRT || recv_data->certType == P12_TRUSTED)
+				send_data->result = update_ca_certificate_entry(recv_data->storeType,
+									recv_data->gname, recv_data->dataBlock);
+
+		break;
+	}
+
+	case CERTSVC_GET_CERTIFICATE_LIST:
+	case CERTSVC_GET_USER_CERTIFICATE_LIST:
+	case CERTSVC_GET_ROOT_CERTIFICATE_LIST: {
+		send_data->result = getCertificateListFromStore(
+								recv_data->reqType,
+								recv_data->storeType,
+								recv_data->is_root_app,
+								&resp->certList,
+								&resp->certListLen,
+								&send_data->certCount);
+
+		if (resp->certList == NULL)
+			send_data->certCount = 0;
+
+		break;
+	}
+
+	case CERTSVC_GET_CERTIFICATE_ALIAS: {
+		send_data->result = getCertificateAliasFromStore(
+								recv_data->storeType,
+								recv_data->gname,
+								send_data->common_name,
+								sizeof(send_data->common_name));
+		break;
+	}
+
+	case CERTSVC_LOAD_CERTIFICATES: {
+		send_data->result = loadCertificatesFromStore(
+								recv_data->storeType,
+								recv_data->gname,
+								&resp->certBlocks,
+								&resp->certBlocksLen,
+								&send_data->certBlockCount);
+
+		if (resp->certBlocks == NULL)
+			send_data->certBlockCount = 0;
+
+		break;
+	}
+
+	case CERTSVC_GET_PROTOCOL_VERSION:
+		send_data->result = VCORE_PROTOCOL_VERSION;
+		break;
+
+	default:
+		SLOGE("Input error. Please check request type");
+		break;
+	}
+}
+
+static int send_fixed_response(int client_sockfd, const response *resp)
+{
+	int result = sendBuffer(client_sockfd, (const char *)&resp->data, sizeof(resp->data));
+
+	if ((result > 0) && (resp->certListLen > 0))
+		result = sendBuffer(client_sockfd, resp->certList, resp->certListLen);
+
+	if ((result > 0) && (resp->certBlocksLen > 0))
+		result = sendBuffer(client_sockfd, resp->certBlocks, resp->certBlocksLen);
+
+	return result;
+}
+
+/* Send the entries of a list in frames of VCORE_FRAME_LIST_CHUNK entries. */
+static int send_list_frames(int client_sockfd, VcoreFrameWriter *writer,
+							const char *list, size_t size, size_t count)
+{
+	size_t i = 0;
+
+	while (i < count) {
+		size_t chunk = count - i;
+
+		if (chunk > VCORE_FRAME_LIST_CHUNK)
+			chunk = VCORE_FRAME_LIST_CHUNK;
+
+		if (vcore_frame_begin(writer) != CERTSVC_SUCCESS ||
+				vcore_frame_put_u32(writer, (uint32_t)chunk) != CERTSVC_SUCCESS)
+			return -1;
+
+		for (; chunk > 0; chunk--, i++) {
+			const char *entry = list + i * size;
+			int result = (size == sizeof(VcoreCertResponseData)) ?
+						 vcore_frame_put_cert(writer, (const VcoreCertResponseData *)entry) :
+						 vcore_frame_put_block(writer, (const ResponseCertBlock *)entry);
+
+			if (result != CERTSVC_SUCCESS)
+				return -1;
+		}
+
+		if (vcore_frame_finish(writer) != CERTSVC_SUCCESS ||
+				sendBuffer(client_sockfd, writer->data, writer->size) <= 0)
+			return -1;
+	}
+
+	return 1;
+}
+
+static int send_framed_response(int client_sockfd, const response *resp)
+{
+	VcoreFrameWriter writer = {NULL, 0, 0};
+	int result = -1;
+
+	if (vcore_frame_encode_response(&writer, &resp->data) != CERTSVC_SUCCESS) {
+		SLOGE("Failed to encode response.");
+		goto exit;
+	}
+
+	result = sendBuffer(client_sockfd, writer.data, writer.size);
+
+	if (result > 0)
+		result = send_list_frames(client_sockfd, &writer, resp->certList,
+								  sizeof(VcoreCertResponseData), resp->data.certCount);
+
+	if (result > 0)
+		result = send_list_frames(client_sockfd, &writer, resp->certBlocks,
+								  sizeof(ResponseCertBlock), resp->data.certBlockCount);
+
+exit:
+	vcore_frame_release(&writer);
+	return result;
+}
+
+static void reset_connection(connection *conn)
+{
+	free(conn->payload);
+	conn->payload = NULL;
+	conn->payloadLen = 0;
+	conn->received = 0;
+	conn->state = READ_HEADER;
+}
+
+static void return_connection(connection *conn)
+{
+	uint64_t event = 1;
+
+	pthread_mutex_lock(&returned_mutex);
+	conn->next = returned_head;
+	returned_head = conn;
+	pthread_mutex_unlock(&returned_mutex);
+
+	if (write(returned_event, &event, sizeof(event)) < 0)
+		SLOGE("Failed to notify returned connection. errno[%d]", errno);
+}
+
+static void handle_connection(void *job, int db_result)
+{
+	connection *conn = (connection *)job;
+	response resp;
+	int result;
+
+	if (db_result == CERTSVC_SUCCESS) {
+		process_request(&conn->request, &resp);
+	} else {
+		/* Answer the request instead of running it without a database. */
+		memset(&resp, 0x00, sizeof(response));
+		resp.data.result = db_result;
+	}
+
+	if (conn->framed)
+		result = send_framed_response(conn->fd, &resp);
+	else
+		result = send_fixed_response(conn->fd, &resp);
+
+	if (result <= 0)
+		SLOGE("send failed :%d, errno %d try once", result, errno);
+
+	free(resp.certList);
+	free(resp.certBlocks);
+
+	if (conn->framed && result > 0) {
+		reset_connection(conn);
+		return_connection(conn);
+	} else {
+		close(conn->fd);
+		free(conn->payload);
+		free(conn);
+	}
+
+	__atomic_sub_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+}
+
+static void link_pending(connection *conn)
+{
+	conn->prev = NULL;
+	conn->next = pending_head;
+
+	if (pending_head != NULL)
+		pending_head->prev = conn;
+
+	pending_head = conn;
+}
+
+static void unlink_pending(connection *conn)
+{
+	if (conn->prev != NULL)
+		conn->prev->next = conn->next;
+	else
+		pending_head = conn->next;
+
+	if (conn->next != NULL)
+		conn->next->prev = conn->prev;
+
+	conn->prev = conn->next = NULL;
+}
+
+static void drop_connection(int epoll_fd, connection *conn)
+{
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	unlink_pending(conn);
+	close(conn->fd);
+	free(conn->payload);
+	free(conn);
+}
+
+static int watch_connection(int epoll_fd, connection *conn)
+{
+	struct epoll_event event;
+
+	memset(&event, 0x00, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = conn;
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->fd, &event) != 0) {
+		SLOGE("Failed to add client socket to epoll. errno[%d]", errno);
+		return CERTSVC_FAIL;
+	}
+
+	conn->deadline = monotonic_now() + CERT_SERVER_RECV_TIMEOUT;
+	link_pending(conn);
+	return CERTSVC_SUCCESS;
+}
+
+static void accept_connection(int epoll_fd, int server_sockfd)
 {
-	int server_sockfd = 0;
-	int client_sockfd = -1;
-	int read_len = 0;
-	int client_len = 0;
 	struct sockaddr_un clientaddr;
-	int result = CERTSVC_SUCCESS;
-	char *certListBuffer = NULL;
-	char *certBlockBuffer = NULL;
-	size_t bufferLen = 0;
-	size_t blockBufferLen = 0;
+	socklen_t client_len = sizeof(clientaddr);
 	struct timeval timeout;
-	timeout.tv_sec = 10;
+	timeout.tv_sec = CERT_SERVER_SEND_TIMEOUT;
 	timeout.tv_usec = 0;
+
+	/* The main thread reads with MSG_DONTWAIT, the workers send blocking. */
+	int client_sockfd = accept4(server_sockfd, (struct sockaddr *)&clientaddr,
+								&client_len, SOCK_CLOEXEC);
+
+	if (client_sockfd < 0) {
+		SLOGE("Error in function accept().[socket desc :%d, error no :%d].",
+			  client_sockfd, errno);
+		return;
+	}
+
+	SLOGD("cert-server Accept! client sock[%d]", client_sockfd);
+
+	if (setsockopt(client_sockfd, SOL_SOCKET, SO_SNDTIMEO, (char *)&timeout,
+				   sizeof(timeout)) < 0) {
+		SLOGE("Error in Set SO_SNDTIMEO Socket Option");
+		close(client_sockfd);
+		return;
+	}
+
+	connection *conn = (connection *)calloc(1, sizeof(connection));
+
+	if (conn == NULL) {
+		SLOGE("Failed to allocate memory.");
+		close(client_sockfd);
+		return;
+	}
+
+	conn->fd = client_sockfd;
+	conn->state = READ_HEADER;
+
+	if (watch_connection(epoll_fd, conn) != CERTSVC_SUCCESS) {
+		close(client_sockfd);
+		free(conn);
+	}
+}
+
+static void watch_returned_connections(int epoll_fd)
+{
+	uint64_t event;
+
+	if (read(returned_event, &event, sizeof(event)) < 0 && errno != EAGAIN)
+		SLOGE("Failed to read returned event. errno[%d]", errno);
+
+	pthread_mutex_lock(&returned_mutex);
+	connection *conn = returned_head;
+	returned_head = NULL;
+	pthread_mutex_unlock(&returned_mutex);
+
+	while (conn != NULL) {
+		connection *next = conn->next;
+
+		if (watch_connection(epoll_fd, conn) != CERTSVC_SUCCESS) {
+			close(conn->fd);
+			free(conn);
+		}
+
+		conn = next;
+	}
+}
+
+static int dispatch_connection(connection *conn, worker_pool *readers,
+							   worker_pool *writer)
+{
+	worker_pool *pool = is_write_request(conn->request.reqType) ? writer : readers;
+
+	__atomic_add_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+
+	if (worker_pool_push(pool, conn) != CERTSVC_SUCCESS) {
+		__atomic_sub_fetch(&in_flight, 1, __ATOMIC_SEQ_CST);
+		return CERTSVC_FAIL;
+	}
+
+	return CERTSVC_SUCCESS;
+}
+
+/*
+ * Move to the next state when the current part is received.
+ * Return false if the request is complete or broken.
+ */
+static bool advance_connection(connection *conn, bool *broken)
+{
+	switch (conn->state) {
+	case READ_HEADER: {
+		VcoreFrameHeader header;
+		memcpy(&header, &conn->request, sizeof(header));
+
+		if (header.magic != VCORE_FRAME_MAGIC) {
+			/* the header is the beginning of the fixed-size request. */
+			conn->state = READ_FIXED;
+			return true;
+		}
+
+		if (header.length == 0 || header.length > VCORE_FRAME_MAX_LENGTH) {
+			SLOGE("Invalid frame length[%u]", header.length);
+			*broken = true;
+			return false;
+		}
+
+		conn->payload = (char *)malloc(header.length);
+
+		if (conn->payload == NULL) {
+			SLOGE("Failed to allocate memory.");
+			*broken = true;
+			return false;
+		}
+
+		conn->framed = true;
+		conn->payloadLen = header.length;
+		conn->received = 0;
+		conn->state = READ_FRAME;
+		return true;
+	}
+
+	case READ_FRAME: {
+		VcoreFrameReader reader = {conn->payload, conn->payloadLen, 0};
+
+		if (vcore_frame_decode_request(&reader, &conn->request) != CERTSVC_SUCCESS) {
+			SLOGE("Failed to decode request frame.");
+			*broken = true;
+		}
+
+		return false;
+	}
+
+	case READ_FIXED:
+	default:
+		return false;
+	}
+}
+
+static void read_connection(int epoll_fd, connection *conn,
+							worker_pool *readers, worker_pool *writer)
+{
+	bool broken = false;
+
+	while (1) {
+		char *buffer = (conn->state == READ_FRAME) ? conn->payload : (char *)&conn->request;
+		size_t expected = (conn->state == READ_HEADER) ? sizeof(VcoreFrameHeader) :
+						  (conn->state == READ_FIXED) ? sizeof(conn->request) : conn->payloadLen;
+
+		if (conn->received == expected) {
+			if (advance_connection(conn, &broken))
+				continue;
+
+			break;
+		}
+
+		ssize_t read_len = recv(conn->fd, buffer + conn->received,
+								expected - conn->received, MSG_DONTWAIT);
+
+		if (read_len > 0) {
+			conn->received += read_len;
+			continue;
+		}
+
+		if (read_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+
+		if (read_len < 0 && errno == EINTR)
+			continue;
+
+		if (read_len == 0 && conn->framed && conn->state == READ_HEADER &&
+				conn->received == 0) {
+			SLOGD("Client closed the connection. fd[%d]", conn->fd);
+		} else {
+			SLOGE("Client closed before sending the whole request. fd[%d], errno[%d]",
+				  conn->fd, errno);
+		}
+
+		drop_connection(epoll_fd, conn);
+		return;
+	}
+
+	if (broken) {
+		drop_connection(epoll_fd, conn);
+		return;
+	}
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	unlink_pending(conn);
+
+	if (dispatch_connection(conn, readers, writer) != CERTSVC_SUCCESS) {
+		SLOGE("Failed to dispatch request. reqType[%d]", conn->request.reqType);
+		close(conn->fd);
+		free(conn->payload);
+		free(conn);
+	}
+}
+
+static void expire_connections(int epoll_fd, time_t now)
+{
+	connection *conn = pending_head;
+
+	while (conn != NULL) {
+		connection *next = conn->next;
+
+		if (conn->deadline <= now) {
+			if (conn->framed && conn->state == READ_HEADER && conn->received == 0)
+				SLOGD("Close idle connection. fd[%d]", conn->fd);
+			else
+				SLOGE("Timeout to receive request. fd[%d]", conn->fd);
+
+			drop_connection(epoll_fd, conn);
+		}
+
+		conn = next;
+	}
+}
+
+static size_t count_readers(void)
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (cores < 1)
+		return 1;
+
+	return (cores > CERT_SERVER_MAX_READERS) ? CERT_SERVER_MAX_READERS : (size_t)cores;
+}
+
+void CertSvcServerComm(void)
+{
+	int server_sockfd = 0;
+	int epoll_fd = -1;
+	int result = CERTSVC_SUCCESS;
+	worker_pool *readers = NULL;
+	worker_pool *writer = NULL;
+	struct epoll_event event;
+	struct epoll_event events[CERT_SERVER_MAX_EVENTS];
 	SLOGI("cert-server is starting...");
-	VcoreRequestData recv_data;
-	VcoreResponseData send_data;
 
 	if (CertSvcGetSocketFromSystemd(&server_sockfd) != CERTSVC_SUCCESS) {
 		SLOGE("Failed to get sockfd from systemd.");
 		return;
 	}
 
-	client_len = sizeof(clientaddr);
 	signal(SIGINT, (void *)CertSigHandler);
 	result = initialize_db();
 
 	if (result != CERTSVC_SUCCESS) {
 		SLOGE("Failed to initialize database.");
-		result = CERTSVC_IO_ERROR;
 		goto Error_close_exit;
 	}
 
@@ -124,18 +744,16 @@ void CertSvcServerComm(void)
 
 	if (result != CERTSVC_SUCCESS) {
 		SLOGE("Failed to check schema version.");
-		result = CERTSVC_IO_ERROR;
 		goto Error_close_exit;
 	}
 
 	if (version != TIZEN_3_0) {
 		SLOGI("Start to update schema version and bundle.");
 		// remake bundle according to new DB
-		result = update_ca_certificate_file(NULL);
+		result = update_ca_certificate_file();
 
 		if (result != CERTSVC_SUCCESS) {
 			SLOGE("Failed to migrate bundle.");
-			result = CERTSVC_IO_ERROR;
 			goto Error_close_exit;
 		}
 
@@ -144,230 +762,107 @@ void CertSvcServerComm(void)
 	}
 
 	SLOGI("Finish checking DB schema version.");
-	fd_set fd;
-	struct timeval tv;
-
-	while (1) {
-		errno = 0;
-		FD_ZERO(&fd);
-		FD_SET(server_sockfd, &fd);
-		tv.tv_sec = 10;
-		tv.tv_usec = 0;
-		memset(&recv_data, 0x00, sizeof(VcoreRequestData));
-		memset(&send_data, 0x00, sizeof(VcoreResponseData));
-		int ret = select(server_sockfd + 1, &fd, NULL, NULL, &tv);
-
-		if (ret == 0) { // timeout
-			SLOGD("cert-server timeout. exit.");
-			break;
-		}
 
-		if (ret == -1) {
-			SLOGE("select() error.");
-			break;
-		}
+	readers = worker_pool_create(count_readers(), handle_connection);
+	writer = worker_pool_create(1, handle_connection);
 
-		if ((client_sockfd = accept(server_sockfd, (struct sockaddr *)&clientaddr,
-									(socklen_t *)&client_len)) < 0) {
-			SLOGE("Error in function accept().[socket desc :%d, error no :%d].",
-				  client_sockfd, errno);
-			continue;
-		}
-
-		SLOGD("cert-server Accept! client sock[%d]", client_sockfd);
-
-		if (setsockopt(client_sockfd, SOL_SOCKET, SO_RCVTIMEO, (char *)&timeout,
-					   sizeof(timeout)) < 0) {
-			SLOGE("Error in Set SO_RCVTIMEO Socket Option");
-			send_data.result = CERTSVC_FAIL;
-			goto Error_close_exit;
-		}
-
-		if (setsockopt(client_sockfd, SOL_SOCKET, SO_SNDTIMEO, (char *)&timeout,
-					   sizeof(timeout)) < 0) {
-			SLOGE("Error in Set SO_SNDTIMEO Socket Option");
-			send_data.result = CERTSVC_FAIL;
-			goto Error_close_exit;
-		}
-
-		SLOGD("Connected to a client...");
-		read_len = recv(client_sockfd, (char *)&recv_data, sizeof(recv_data), 0);
-
-		if (read_len < 0) {
-			SLOGE("Error in function recv().");
-			send_data.result = CERTSVC_FAIL;
-			goto Error_close_exit;
-		}
-
-		SLOGD("revc request: reqType=%d", recv_data.reqType);
-
-		switch (recv_data.reqType) {
-		case CERTSVC_EXTRACT_CERT: {
-			send_data.result = getCertificateDetailFromStore(
-								   recv_data.storeType,
-								   recv_data.certType,
-								   recv_data.gname,
-								   send_data.dataBlock);
-			send_data.dataBlockLen = strlen(send_data.dataBlock);
-
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
-
-		case CERTSVC_EXTRACT_SYSTEM_CERT: {
-			send_data.result = getCertificateDetailFromSystemStore(
-								   recv_data.gname,
-								   send_data.dataBlock);
-			send_data.dataBlockLen = strlen(send_data.dataBlock);
+	if (readers == NULL || writer == NULL) {
+		SLOGE("Failed to create worker pools.");
+		goto Error_close_exit;
+	}
 
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
 
-		case CERTSVC_DELETE_CERT: {
-			send_data.result = deleteCertificateFromStore(
-								   recv_data.storeType,
-								   recv_data.gname);
+	if (epoll_fd < 0) {
+		SLOGE("Failed to create epoll. errno[%d]", errno);
+		goto Error_close_exit;
+	}
 
-			if (send_data.result == CERTSVC_SUCCESS)
-				send_data.result = update_ca_certificate_file(NULL);
+	memset(&event, 0x00, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
 
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_sockfd, &event) != 0) {
+		SLOGE("Failed to add server socket to epoll. errno[%d]", errno);
+		goto Error_close_exit;
+	}
 
-		case CERTSVC_GET_CERTIFICATE_STATUS: {
-			send_data.result = getCertificateStatusFromStore(
-								   recv_data.storeType,
-								   recv_data.gname,
-								   &send_data.certStatus);
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	returned_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 
-		case CERTSVC_SET_CERTIFICATE_STATUS: {
-			send_data.result = setCertificateStatusToStore(
-								   recv_data.storeType,
-								   recv_data.is_root_app,
-								   recv_data.gname,
-								   recv_data.certStatus);
+	if (returned_event < 0) {
+		SLOGE("Failed to create eventfd. errno[%d]", errno);
+		goto Error_close_exit;
+	}
 
-			if (send_data.result == CERTSVC_SUCCESS)
-				send_data.result = update_ca_certificate_file(NULL);
+	event.data.ptr = &returned_event;
 
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, returned_event, &event) != 0) {
+		SLOGE("Failed to add eventfd to epoll. errno[%d]", errno);
+		goto Error_close_exit;
+	}
 
-		case CERTSVC_CHECK_ALIAS_EXISTS: {
-			send_data.result = checkAliasExistsInStore(
-								   recv_data.storeType,
-								   recv_data.gname,
-								   &send_data.isAliasUnique);
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	time_t last_active = monotonic_now();
 
-		case CERTSVC_INSTALL_CERTIFICATE: {
-			send_data.result = installCertificateToStore(
-								   recv_data.storeType,
-								   recv_data.gname,
-								   recv_data.common_name,
-								   recv_data.private_key_gname,
-								   recv_data.associated_gname,
-								   recv_data.dataBlock,
-								   recv_data.certType);
-
-			if (send_data.result == CERTSVC_SUCCESS)
-				if (recv_data.certType == PEM_CRT || recv_data.certType == P12_TRUSTED)
-					send_data.result = update_ca_certificate_file(recv_data.dataBlock);
-
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
-		}
+	while (1) {
+		int i;
+		int nfds = epoll_wait(epoll_fd, events, CERT_SERVER_MAX_EVENTS, 1000);
 
-		case CERTSVC_GET_CERTIFICATE_LIST:
-		case CERTSVC_GET_USER_CERTIFICATE_LIST:
-		case CERTSVC_GET_ROOT_CERTIFICATE_LIST: {
-			send_data.result = getCertificateListFromStore(
-								   recv_data.reqType,
-								   recv_data.storeType,
-								   recv_data.is_root_app,
-								   &certListBuffer,
-								   &bufferLen,
-								   &send_data.certCount);
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-
-			if ((result > 0) && (bufferLen > 0)) {
-				result = sendBuffer(client_sockfd, certListBuffer, bufferLen);
-			}
-
-			free(certListBuffer);
-			certListBuffer = NULL;
+		if (nfds == -1) {
+			if (errno == EINTR)
+				continue;
 
+			SLOGE("epoll_wait() error.");
 			break;
 		}
 
-		case CERTSVC_GET_CERTIFICATE_ALIAS: {
-			send_data.result = getCertificateAliasFromStore(
-								   recv_data.storeType,
-								   recv_data.gname,
-								   send_data.common_name,
-								   sizeof(send_data.common_name));
-
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-			break;
+		for (i = 0; i < nfds; i++) {
+			if (events[i].data.ptr == NULL)
+				accept_connection(epoll_fd, server_sockfd);
+			else if (events[i].data.ptr != &returned_event)
+				read_connection(epoll_fd, (connection *)events[i].data.ptr, readers, writer);
 		}
 
-		case CERTSVC_LOAD_CERTIFICATES: {
-			send_data.result = loadCertificatesFromStore(
-								   recv_data.storeType,
-								   recv_data.gname,
-								   &certBlockBuffer,
-								   &blockBufferLen,
-								   &send_data.certBlockCount);
-
-			result = sendBuffer(client_sockfd, (char *)&send_data, sizeof(send_data));
-
-			if ((result > 0) && (blockBufferLen > 0)) {
-				result = sendBuffer(client_sockfd, certBlockBuffer, blockBufferLen);
-			}
+		/* the event only wakes up, a worker may return one after it is read. */
+		watch_returned_connections(epoll_fd);
 
-			free(certBlockBuffer);
-			certBlockBuffer = NULL;
+		time_t now = monotonic_now();
+		expire_connections(epoll_fd, now);
 
-			break;
+		if (nfds > 0 || pending_head != NULL ||
+				__atomic_load_n(&in_flight, __ATOMIC_SEQ_CST) > 0) {
+			last_active = now;
+			continue;
 		}
 
-		default:
-			SLOGE("Input error. Please check request type");
+		if (now - last_active >= CERT_SERVER_IDLE_TIMEOUT) {
+			SLOGD("cert-server timeout. exit.");
 			break;
 		}
-
-		if (result <= 0)
-			SLOGE("send failed :%d, errno %d try once", result, errno);
-
-		close(client_sockfd);
-		client_sockfd = -1;
 	}
 
 Error_close_exit:
-	close(server_sockfd);
-	deinitialize_db();
-	free(certListBuffer);
-	free(certBlockBuffer);
+	/* Respond to the requests already dispatched before exit. */
+	worker_pool_destroy(readers);
+	worker_pool_destroy(writer);
+
+	while (pending_head != NULL)
+		drop_connection(epoll_fd, pending_head);
+
+	while (returned_head != NULL) {
+		connection *conn = returned_head;
+		returned_head = conn->next;
+		close(conn->fd);
+		free(conn);
+	}
 
-	if (client_sockfd >= 0) {
-		result = send(client_sockfd, (char *)&send_data,
-					  sizeof(send_data), MSG_NOSIGNAL);
+	if (returned_event >= 0)
+		close(returned_event);
 
-		if (result <= 0)
-			SLOGE("send failed :%d, errno %d try once", result, errno);
+	if (epoll_fd >= 0)
+		close(epoll_fd);
 
-		close(client_sockfd);
-	} else {
-		SLOGE("cannot connect to client socket.");
-	}
+	close(server_sockfd);
+	deinitialize_all_db();
 
 	SLOGI("CertSvcServerComm done.");
 }
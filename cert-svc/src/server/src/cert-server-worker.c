@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @file     cert-server-worker.c
+ * @version  1.0
+ * @brief    cert-server worker threads.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <cert-svc/cerror.h>
+
+#include <cert-server-debug.h>
+#include <cert-server-db.h>
+#include <cert-server-worker.h>
+
+typedef struct worker_job_t {
+	void *data;
+	struct worker_job_t *next;
+} worker_job;
+
+struct worker_pool_t {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	worker_job *head;
+	worker_job *tail;
+	int stopped;
+	worker_handler handler;
+	size_t count;
+	pthread_t *threads;
+};
+
+static worker_job *pop_job(worker_pool *pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+
+	while (pool->head == NULL && !pool->stopped)
+		pthread_cond_wait(&pool->cond, &pool->mutex);
+
+	/* NULL only if the pool is stopped and there is no job left. */
+	worker_job *job = pool->head;
+
+	if (job != NULL) {
+		pool->head = job->next;
+
+		if (pool->head == NULL)
+			pool->tail = NULL;
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+	return job;
+}
+
+static void *worker_main(void *arg)
+{
+	worker_pool *pool = (worker_pool *)arg;
+	worker_job *job = NULL;
+
+	while ((job = pop_job(pool)) != NULL) {
+		/* initialize_db returns at once if the connection is opened. */
+		int result = initialize_db();
+
+		if (result != CERTSVC_SUCCESS)
+			SLOGE("Failed to initialize database on worker thread.");
+
+		pool->handler(job->data, result);
+		free(job);
+	}
+
+	deinitialize_db();
+	return NULL;
+}
+
+static void stop_and_join(worker_pool *pool)
+{
+	size_t i;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->stopped = 1;
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (i = 0; i < pool->count; i++)
+		pthread_join(pool->threads[i], NULL);
+
+	pool->count = 0;
+}
+
+worker_pool *worker_pool_create(size_t threads, worker_handler handler)
+{
+	if (threads == 0 || handler == NULL) {
+		SLOGE("Invalid input parameter passed.");
+		return NULL;
+	}
+
+	worker_pool *pool = (worker_pool *)calloc(1, sizeof(worker_pool));
+
+	if (pool == NULL) {
+		SLOGE("Failed to allocate memory.");
+		return NULL;
+	}
+
+	pool->threads = (pthread_t *)calloc(threads, sizeof(pthread_t));
+
+	if (pool->threads == NULL) {
+		SLOGE("Failed to allocate memory.");
+		free(pool);
+		return NULL;
+	}
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+	pool->handler = handler;
+
+	for (pool->count = 0; pool->count < threads; pool->count++) {
+		if (pthread_create(&pool->threads[pool->count], NULL, worker_main, pool) != 0) {
+			SLOGE("Failed to create worker thread.");
+			worker_pool_destroy(pool);
+			return NULL;
+		}
+	}
+
+	SLOGD("Worker pool is created. threads[%zu]", threads);
+	return pool;
+}
+
+int worker_pool_push(worker_pool *pool, void *job)
+{
+	if (pool == NULL || job == NULL) {
+		SLOGE("Invalid input parameter passed.");
+		return CERTSVC_WRONG_ARGUMENT;
+	}
+
+	worker_job *node = (worker_job *)malloc(sizeof(worker_job));
+
+	if (node == NULL) {
+		SLOGE("Failed to allocate memory.");
+		return CERTSVC_BAD_ALLOC;
+	}
+
+	node->data = job;
+	node->next = NULL;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	if (pool->stopped) {
+		pthread_mutex_unlock(&pool->mutex);
+		free(node);
+		SLOGE("Worker pool is already stopped.");
+		return CERTSVC_FAIL;
+	}
+
+	if (pool->tail != NULL)
+		pool->tail->next = node;
+	else
+		pool->head = node;
+
+	pool->tail = node;
+	pthread_cond_signal(&pool->cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	return CERTSVC_SUCCESS;
+}
+
+void worker_pool_destroy(worker_pool *pool)
+{
+	if (pool == NULL)
+		return;
+
+	stop_and_join(pool);
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->threads);
+	free(pool);
+}
@@ -26,8 +26,11 @@
 
 #include <cstdio>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <iomanip>
+#include <tuple>
 
 #include <openssl/pem.h>
 #include <openssl/x509.h>
@@ -46,11 +49,51 @@ namespace {
 typedef std::unique_ptr<X509, std::function<void(X509 *)>> ScopedX509;
 typedef std::unique_ptr<FILE, std::function<int(FILE *)>> ScopedFile;
 
+enum CachedField {
+	CACHED_ONE_LINE,
+	CACHED_FIELD,
+	CACHED_NAME_HASH,
+	CACHED_OCSP_URL
+};
+
 } // namespace anonymous
 
 namespace ValidationCore {
 
-Certificate::Certificate(X509 *cert)
+/*
+ * Values are computed out of the lock, so a field may be decoded twice by
+ * racing readers but the first one stored is returned to both.
+ * Failures aren't cached.
+ */
+struct Certificate::FieldCache {
+	// (CachedField, FieldType, nid)
+	typedef std::tuple<int, int, int> Key;
+
+	template <typename Map, typename Compute>
+	typename Map::mapped_type get(Map &map, const typename Map::key_type &key,
+								  Compute compute)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = map.find(key);
+
+			if (it != map.end())
+				return it->second;
+		}
+
+		auto value = compute();
+		std::lock_guard<std::mutex> lock(mutex);
+		return map.emplace(key, std::move(value)).first->second;
+	}
+
+	std::mutex mutex;
+	std::map<Key, std::string> strings;
+	std::map<int, Certificate::Fingerprint> fingerprints;
+	std::map<int, Certificate::AltNameSet> altNames;
+	std::map<int, time_t> times;
+};
+
+Certificate::Certificate(X509 *cert) : m_cache(new FieldCache)
 {
 	if (cert == NULL)
 		VcoreThrowMsg(Certificate::Exception::WrongParamError,
@@ -64,7 +107,7 @@ Certificate::Certificate(X509 *cert)
 }
 
 Certificate::Certificate(const std::string &data,
-						 Certificate::FormType form)
+						 Certificate::FormType form) : m_cache(new FieldCache)
 {
 	if (data.size() == 0)
 		VcoreThrowMsg(Certificate::Exception::WrongParamError,
@@ -217,25 +260,27 @@ bool Certificate::isSignedBy(const CertificatePtr &parent) const
 Certificate::Fingerprint Certificate::getFingerprint(
 	Certificate::FingerprintType type) const
 {
-	unsigned int fingerprintlength = EVP_MAX_MD_SIZE;
-	unsigned char fingerprint[EVP_MAX_MD_SIZE];
-	Fingerprint raw;
+	return m_cache->get(m_cache->fingerprints, type, [&]() -> Fingerprint {
+		unsigned int fingerprintlength = EVP_MAX_MD_SIZE;
+		unsigned char fingerprint[EVP_MAX_MD_SIZE];
+		Fingerprint raw;
 
-	if (type == FINGERPRINT_MD5) {
-		if (!X509_digest(m_x509, EVP_md5(), fingerprint, &fingerprintlength))
-			VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
-						  "MD5 digest counting failed!");
-	}
+		if (type == FINGERPRINT_MD5) {
+			if (!X509_digest(m_x509, EVP_md5(), fingerprint, &fingerprintlength))
+				VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
+							  "MD5 digest counting failed!");
+		}
 
-	if (type == FINGERPRINT_SHA1) {
-		if (!X509_digest(m_x509, EVP_sha1(), fingerprint, &fingerprintlength))
-			VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
-						  "SHA1 digest counting failed");
-	}
+		if (type == FINGERPRINT_SHA1) {
+			if (!X509_digest(m_x509, EVP_sha1(), fingerprint, &fingerprintlength))
+				VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
+							  "SHA1 digest counting failed");
+		}
 
-	raw.resize(fingerprintlength); // improve performance
-	std::copy(fingerprint, fingerprint + fingerprintlength, raw.begin());
-	return raw;
+		raw.resize(fingerprintlength); // improve performance
+		std::copy(fingerprint, fingerprint + fingerprintlength, raw.begin());
+		return raw;
+	});
 }
 
 X509_NAME *Certificate::getX509Name(FieldType type) const
@@ -265,51 +310,55 @@ X509_NAME *Certificate::getX509Name(FieldType type) const
 
 std::string Certificate::getOneLine(FieldType type) const
 {
-	X509_NAME *name = getX509Name(type);
-	static const int MAXB = 1024;
-	char buffer[MAXB] = {0, };
-	X509_NAME_oneline(name, buffer, MAXB);
-	return std::string(buffer);
+	return m_cache->get(m_cache->strings, FieldCache::Key(CACHED_ONE_LINE, type, 0), [&]() -> std::string {
+		X509_NAME *name = getX509Name(type);
+		static const int MAXB = 1024;
+		char buffer[MAXB] = {0, };
+		X509_NAME_oneline(name, buffer, MAXB);
+		return std::string(buffer);
+	});
 }
 
 std::string Certificate::getField(FieldType type, int fieldNid) const
 {
-	X509_NAME *subjectName = getX509Name(type);
-	X509_NAME_ENTRY *subjectEntry = NULL;
-	std::string output;
-	int entryCount = X509_NAME_entry_count(subjectName);
+	return m_cache->get(m_cache->strings, FieldCache::Key(CACHED_FIELD, type, fieldNid), [&]() -> std::string {
+		X509_NAME *subjectName = getX509Name(type);
+		X509_NAME_ENTRY *subjectEntry = NULL;
+		std::string output;
+		int entryCount = X509_NAME_entry_count(subjectName);
 
-	for (int i = 0; i < entryCount; ++i) {
-		subjectEntry = X509_NAME_get_entry(subjectName, i);
+		for (int i = 0; i < entryCount; ++i) {
+			subjectEntry = X509_NAME_get_entry(subjectName, i);
 
-		if (!subjectEntry) {
-			continue;
-		}
+			if (!subjectEntry) {
+				continue;
+			}
 
-		int nid = OBJ_obj2nid(
-					  static_cast<ASN1_OBJECT *>(
-						  X509_NAME_ENTRY_get_object(subjectEntry)));
+			int nid = OBJ_obj2nid(
+						  static_cast<ASN1_OBJECT *>(
+							  X509_NAME_ENTRY_get_object(subjectEntry)));
 
-		if (nid != fieldNid) {
-			continue;
-		}
+			if (nid != fieldNid) {
+				continue;
+			}
 
-		ASN1_STRING *pASN1Str = X509_NAME_ENTRY_get_data(subjectEntry);
-		unsigned char *pData = NULL;
-		int nLength = ASN1_STRING_to_UTF8(&pData, pASN1Str);
+			ASN1_STRING *pASN1Str = X509_NAME_ENTRY_get_data(subjectEntry);
+			unsigned char *pData = NULL;
+			int nLength = ASN1_STRING_to_UTF8(&pData, pASN1Str);
 
-		if (nLength < 0)
-			VcoreThrowMsg(Certificate::Exception::OpensslInternalError, "Reading field error.");
+			if (nLength < 0)
+				VcoreThrowMsg(Certificate::Exception::OpensslInternalError, "Reading field error.");
 
-		if (!pData) {
-			output = std::string();
-		} else {
-			output = std::string(reinterpret_cast<char *>(pData), nLength);
-			OPENSSL_free(pData);
+			if (!pData) {
+				output = std::string();
+			} else {
+				output = std::string(reinterpret_cast<char *>(pData), nLength);
+				OPENSSL_free(pData);
+			}
 		}
-	}
 
-	return output;
+		return output;
+	});
 }
 
 std::string Certificate::getCommonName(FieldType type) const
@@ -349,16 +398,18 @@ std::string Certificate::getEmailAddres(FieldType type) const
 
 std::string Certificate::getNameHash(FieldType type) const
 {
-	unsigned long ulNameHash;
-	char buf[9] = {0};
+	return m_cache->get(m_cache->strings, FieldCache::Key(CACHED_NAME_HASH, type, 0), [&]() -> std::string {
+		unsigned long ulNameHash;
+		char buf[9] = {0};
 
-	if (type == FIELD_SUBJECT)
-		ulNameHash = X509_subject_name_hash(m_x509);
-	else
-		ulNameHash = X509_issuer_name_hash(m_x509);
+		if (type == FIELD_SUBJECT)
+			ulNameHash = X509_subject_name_hash(m_x509);
+		else
+			ulNameHash = X509_issuer_name_hash(m_x509);
 
-	snprintf(buf, 9, "%08lx", ulNameHash);
-	return std::string(buf);
+		snprintf(buf, 9, "%08lx", ulNameHash);
+		return std::string(buf);
+	});
 }
 
 std::string Certificate::getUID(FieldType type) const
@@ -388,83 +439,87 @@ std::string Certificate::getUID(FieldType type) const
 
 std::string Certificate::getOCSPURL() const
 {
-	// TODO verify this code
-	std::string retValue;
-	AUTHORITY_INFO_ACCESS *aia = static_cast<AUTHORITY_INFO_ACCESS *>(
-									 X509_get_ext_d2i(m_x509,
-											 NID_info_access,
-											 NULL,
-											 NULL));
-
-	// no AIA extension in the cert
-	if (NULL == aia) {
-		return retValue;
-	}
+	return m_cache->get(m_cache->strings, FieldCache::Key(CACHED_OCSP_URL, 0, 0), [&]() -> std::string {
+		// TODO verify this code
+		std::string retValue;
+		AUTHORITY_INFO_ACCESS *aia = static_cast<AUTHORITY_INFO_ACCESS *>(
+										 X509_get_ext_d2i(m_x509,
+												 NID_info_access,
+												 NULL,
+												 NULL));
+
+		// no AIA extension in the cert
+		if (NULL == aia) {
+			return retValue;
+		}
 
-	int count = sk_ACCESS_DESCRIPTION_num(aia);
+		int count = sk_ACCESS_DESCRIPTION_num(aia);
 
-	for (int i = 0; i < count; ++i) {
-		ACCESS_DESCRIPTION *ad = sk_ACCESS_DESCRIPTION_value(aia, i);
+		for (int i = 0; i < count; ++i) {
+			ACCESS_DESCRIPTION *ad = sk_ACCESS_DESCRIPTION_value(aia, i);
 
-		if (OBJ_obj2nid(ad->method) == NID_ad_OCSP &&
-				ad->location->type == GEN_URI) {
-			const unsigned char *data = ASN1_STRING_get0_data(ad->location->d.ia5);
+			if (OBJ_obj2nid(ad->method) == NID_ad_OCSP &&
+					ad->location->type == GEN_URI) {
+				const unsigned char *data = ASN1_STRING_get0_data(ad->location->d.ia5);
 
-			if (!data)
-				retValue = std::string();
-			else
-				retValue = std::string(reinterpret_cast<const char *>(data));
+				if (!data)
+					retValue = std::string();
+				else
+					retValue = std::string(reinterpret_cast<const char *>(data));
 
-			break;
+				break;
+			}
 		}
-	}
 
-	sk_ACCESS_DESCRIPTION_free(aia);
-	return retValue;
+		sk_ACCESS_DESCRIPTION_free(aia);
+		return retValue;
+	});
 }
 
 Certificate::AltNameSet Certificate::getAlternativeName(int type) const
 {
-	AltNameSet set;
-	GENERAL_NAME *namePart = NULL;
-	STACK_OF(GENERAL_NAME)* san =
-		static_cast<STACK_OF(GENERAL_NAME) *>(
-			X509_get_ext_d2i(m_x509, NID_subject_alt_name, NULL, NULL));
-
-	while (sk_GENERAL_NAME_num(san) > 0) {
-		if ((namePart = sk_GENERAL_NAME_pop(san)) == NULL)
-			VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
-						  "openssl sk_GENERAL_NAME_pop err.");
-
-		if (type == namePart->type) {
-			const char *temp;
-
-			switch (type) {
-			case GEN_DNS:
-				temp = reinterpret_cast<const char *>(ASN1_STRING_get0_data(namePart->d.dNSName));
-				break;
-
-			case GEN_URI:
-				temp = reinterpret_cast<const char *>(ASN1_STRING_get0_data(namePart->d.uniformResourceIdentifier));
-				break;
-
-			default:
-				VcoreThrowMsg(Certificate::Exception::WrongParamError,
-							  "Not support alt name type : " << type);
-			}
-
-			if (!temp) {
-				set.insert(std::string());
+	return m_cache->get(m_cache->altNames, type, [&]() -> AltNameSet {
+		AltNameSet set;
+		GENERAL_NAME *namePart = NULL;
+		STACK_OF(GENERAL_NAME)* san =
+			static_cast<STACK_OF(GENERAL_NAME) *>(
+				X509_get_ext_d2i(m_x509, NID_subject_alt_name, NULL, NULL));
+
+		while (sk_GENERAL_NAME_num(san) > 0) {
+			if ((namePart = sk_GENERAL_NAME_pop(san)) == NULL)
+				VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
+							  "openssl sk_GENERAL_NAME_pop err.");
+
+			if (type == namePart->type) {
+				const char *temp;
+
+				switch (type) {
+				case GEN_DNS:
+					temp = reinterpret_cast<const char *>(ASN1_STRING_get0_data(namePart->d.dNSName));
+					break;
+
+				case GEN_URI:
+					temp = reinterpret_cast<const char *>(ASN1_STRING_get0_data(namePart->d.uniformResourceIdentifier));
+					break;
+
+				default:
+					VcoreThrowMsg(Certificate::Exception::WrongParamError,
+								  "Not support alt name type : " << type);
+				}
+
+				if (!temp) {
+					set.insert(std::string());
+				} else {
+					set.insert(std::string(temp));
+					LogDebug("FOUND AltName: " << temp);
+				}
 			} else {
-				set.insert(std::string(temp));
-				LogDebug("FOUND AltName: " << temp);
+				LogDebug("FOUND GEN TYPE ID: " << namePart->type);
 			}
-		} else {
-			LogDebug("FOUND GEN TYPE ID: " << namePart->type);
 		}
-	}
 
-	return set;
+		return set;
+	});
 }
 
 Certificate::AltNameSet Certificate::getAlternativeNameDNS() const
@@ -505,14 +560,16 @@ ASN1_TIME *Certificate::getNotBeforeTime() const
 
 time_t Certificate::getNotAfter() const
 {
-	auto time = getNotAfterTime();
-	time_t output;
+	return m_cache->get(m_cache->times, 0, [&]() -> time_t {
+		auto time = getNotAfterTime();
+		time_t output;
 
-	if (asn1TimeToTimeT(time, &output) == 0)
-		VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
-					  "Converting ASN1_time to time_t error.");
+		if (asn1TimeToTimeT(time, &output) == 0)
+			VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
+						  "Converting ASN1_time to time_t error.");
 
-	return output;
+		return output;
+	});
 }
 
 time_t Certificate::getNotBefore() const
@@ -86,6 +86,9 @@ public:
 
 	~Certificate();
 
+	Certificate(const Certificate &) = delete;
+	Certificate &operator=(const Certificate &) = delete;
+
 	// It returns pointer to internal structure!
 	// Do not free this pointer!
 	X509 *getX509(void) const;
@@ -181,5 +184,9 @@ protected:
 private:
 	AltNameSet getAlternativeName(int type) const;
 
+	// Decoded fields are kept once they are read. X509 must not be changed.
+	struct FieldCache;
+	std::unique_ptr<FieldCache> m_cache;
+
 };
 } // namespace ValidationCore
@@ -24,11 +24,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
-#include <unistd.h>
-#include <dirent.h>
-
-#include <memory>
-#include <functional>
 
 #include <openssl/pem.h>
 #include <openssl/x509.h>
@@ -41,6 +36,7 @@
 
 #include "vcore/Base64.h"
 
+#include "vcore/CertificateIndex.h"
 #include "vcore/CertificateCollection.h"
 
 namespace ValidationCore {
@@ -54,65 +50,10 @@ inline std::string toBinaryString(int data)
 	return std::string(buffer, sizeof(int));
 }
 
-bool isHashMatchedName(const std::string &name, const std::string &hash)
-{
-	if (name.compare(0, 8, hash) != 0)
-		return false;
-
-	return true;
-}
-
-bool isHashMatchedFile(const std::string &path, const std::string &hash)
-{
-	CertificatePtr certPtr = Certificate::createFromFile(path);
-	std::string name = certPtr->getNameHash(Certificate::FIELD_SUBJECT);
-	return isHashMatchedName(name, hash);
-}
-
-struct dirent *readdir(DIR *dirp) {
-	errno = 0;
-	auto ret = ::readdir(dirp);
-	if (errno != 0)
-		LogWarning("Error read dir.");
-	return ret;
-}
-
 CertificatePtr searchCert(const std::string &dir, const CertificatePtr &certPtr, bool withHash)
 {
 	try {
-		std::string hash = certPtr->getNameHash(Certificate::FIELD_ISSUER);
-		std::unique_ptr<DIR, std::function<int(DIR *)>> dp(::opendir(dir.c_str()),
-														   ::closedir);
-
-		if (dp == nullptr) {
-			LogError("Failed open dir[" << dir << "]");
-			return CertificatePtr();
-		}
-
-		while (auto dirp = ValidationCore::readdir(dp.get())) {
-			if (dirp->d_type == DT_DIR)
-				continue;
-
-			auto fullPath = dir + "/" + dirp->d_name;
-			if (withHash) {
-				if (!isHashMatchedName(dirp->d_name, hash))
-					continue;
-			} else {
-				if (!isHashMatchedFile(fullPath, hash))
-					continue;
-			}
-
-			LogDebug("Found hash matched file! : " << fullPath);
-			auto candidate = Certificate::createFromFile(fullPath);
-			if (candidate->getOneLine().compare(
-				certPtr->getOneLine(Certificate::FIELD_ISSUER)) != 0)
-				continue;
-
-			return candidate;
-		}
-
-		LogWarning("cert not found by hash[" << hash << "]");
-		return CertificatePtr();
+		return CertificateIndex::instance().findIssuer(dir, withHash, certPtr);
 	} catch (const Certificate::Exception::Base &e) {
 		VcoreThrowMsg(
 			CertificateCollection::Exception::CertificateError,
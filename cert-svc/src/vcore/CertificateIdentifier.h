@@ -21,15 +21,27 @@
  */
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <openssl/x509.h>
 
 #include <vcore/Certificate.h>
 #include <vcore/CertStoreType.h>
 
 namespace ValidationCore {
+/*
+ * SHA1 fingerprints are kept in a flat array sorted by digest, so a lookup
+ * is a binary search without allocation. add() only appends, and build()
+ * sorts and merges the duplicates once after all of them are added.
+ * It is only read after that, so a built one could be shared by threads.
+ */
 class CertificateIdentifier {
 public:
-	typedef std::map<Certificate::Fingerprint, CertStoreId::Set> FingerPrintMap;
+	typedef std::array<unsigned char, SHA_DIGEST_LENGTH> Digest;
 
 	CertificateIdentifier() = default;
 	~CertificateIdentifier() = default;
@@ -42,26 +54,86 @@ public:
 	void add(const Certificate::Fingerprint &fingerprint,
 			 CertStoreId::Type domain)
 	{
-		fingerPrintMap[fingerprint].add(domain);
+		// Only SHA1 fingerprint could be matched.
+		if (fingerprint.size() != SHA_DIGEST_LENGTH)
+			return;
+
+		Entry entry;
+		std::copy(fingerprint.begin(), fingerprint.end(), entry.digest.begin());
+		entry.domains = domain;
+		entries.push_back(entry);
 	}
 
-	CertStoreId::Set find(const Certificate::Fingerprint &fingerprint) const
+	// Must be called after the last add() and before find().
+	void build()
+	{
+		if (entries.empty())
+			return;
+
+		std::sort(entries.begin(), entries.end());
+
+		auto last = entries.begin();
+
+		for (auto iter = last + 1; iter != entries.end(); ++iter) {
+			if (iter->digest == last->digest)
+				last->domains |= iter->domains;
+			else
+				*++last = *iter;
+		}
+
+		entries.erase(last + 1, entries.end());
+	}
+
+	CertStoreId::Set find(const Digest &digest) const
 	{
-		FingerPrintMap::const_iterator iter = fingerPrintMap.find(fingerprint);
+		Entry entry;
+		entry.digest = digest;
 
-		if (iter == fingerPrintMap.end()) {
+		auto iter = std::lower_bound(entries.begin(), entries.end(), entry);
+
+		if (iter == entries.end() || iter->digest != digest) {
 			return CertStoreId::Set();
 		}
 
-		return iter->second;
+		CertStoreId::Set domains;
+		domains.add(iter->domains);
+		return domains;
+	}
+
+	CertStoreId::Set find(const Certificate::Fingerprint &fingerprint) const
+	{
+		if (fingerprint.size() != SHA_DIGEST_LENGTH) {
+			return CertStoreId::Set();
+		}
+
+		Digest digest;
+		std::copy(fingerprint.begin(), fingerprint.end(), digest.begin());
+		return find(digest);
 	}
 
 	CertStoreId::Set find(const CertificatePtr &certificate) const
 	{
-		return find(certificate->getFingerprint(Certificate::FINGERPRINT_SHA1));
+		Digest digest;
+		unsigned int length = digest.size();
+
+		if (!X509_digest(certificate->getX509(), EVP_sha1(), digest.data(), &length))
+			VcoreThrowMsg(Certificate::Exception::OpensslInternalError,
+						  "SHA1 digest counting failed");
+
+		return find(digest);
 	}
 
 private:
-	FingerPrintMap fingerPrintMap;
+	struct Entry {
+		Digest digest;
+		CertStoreId::Type domains;
+
+		bool operator<(const Entry &other) const
+		{
+			return digest < other.digest;
+		}
+	};
+
+	std::vector<Entry> entries;
 };
 } // namespace ValidationCore
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+/*
+ * @file        CertificateIndex.cpp
+ * @version     1.0
+ * @brief       Process-wide index of the certificates in CA directories
+ */
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <functional>
+#include <memory>
+
+#include <openssl/x509v3.h>
+
+#include <dpl/log/log.h>
+
+#include "vcore/CertificateIndex.h"
+
+namespace ValidationCore {
+
+namespace {
+
+const uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+							IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+
+std::string getSubjectKeyId(const CertificatePtr &cert)
+{
+	ASN1_OCTET_STRING *skid = static_cast<ASN1_OCTET_STRING *>(
+		X509_get_ext_d2i(cert->getX509(), NID_subject_key_identifier, NULL, NULL));
+
+	if (skid == NULL)
+		return std::string();
+
+	std::string id(reinterpret_cast<char *>(skid->data), skid->length);
+	ASN1_OCTET_STRING_free(skid);
+	return id;
+}
+
+std::string getAuthorityKeyId(const CertificatePtr &cert)
+{
+	AUTHORITY_KEYID *akid = static_cast<AUTHORITY_KEYID *>(
+		X509_get_ext_d2i(cert->getX509(), NID_authority_key_identifier, NULL, NULL));
+
+	if (akid == NULL)
+		return std::string();
+
+	std::string id;
+
+	if (akid->keyid != NULL)
+		id.assign(reinterpret_cast<char *>(akid->keyid->data), akid->keyid->length);
+
+	AUTHORITY_KEYID_free(akid);
+	return id;
+}
+
+} // anonymous namespace
+
+CertificateIndex &CertificateIndex::instance()
+{
+	static CertificateIndex index;
+	return index;
+}
+
+CertificateIndex::CertificateIndex()
+	: m_inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+	if (m_inotify < 0)
+		LogWarning("Failed to init inotify. CA directories are not cached. errno : " << errno);
+}
+
+CertificateIndex::~CertificateIndex()
+{
+	if (m_inotify >= 0)
+		close(m_inotify);
+}
+
+void CertificateIndex::refresh()
+{
+	if (m_inotify < 0)
+		return;
+
+	alignas(struct inotify_event) char buffer[4096];
+
+	while (true) {
+		ssize_t len = read(m_inotify, buffer, sizeof(buffer));
+
+		if (len <= 0)
+			break;
+
+		for (char *ptr = buffer; ptr < buffer + len;) {
+			auto event = reinterpret_cast<struct inotify_event *>(ptr);
+			ptr += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				LogDebug("inotify queue overflowed. Drop all CA directories.");
+
+				for (auto &dir : m_dirs) {
+					int wd = dir.second.watch;
+					dir.second = Directory();
+					dir.second.watch = wd;
+				}
+
+				continue;
+			}
+
+			auto found = m_watches.find(event->wd);
+
+			if (found == m_watches.end())
+				continue;
+
+			auto &dir = m_dirs[found->second];
+
+			/* The watch is removed with the directory, add it again on the next lookup. */
+			if (event->mask & IN_IGNORED) {
+				dir = Directory();
+				m_watches.erase(found);
+				continue;
+			}
+
+			LogDebug("CA directory is changed : " << found->second);
+			dir = Directory();
+			dir.watch = event->wd;
+		}
+	}
+}
+
+bool CertificateIndex::watch(const std::string &path, Directory &dir)
+{
+	if (dir.watch >= 0)
+		return true;
+
+	if (m_inotify < 0)
+		return false;
+
+	int wd = inotify_add_watch(m_inotify, path.c_str(), WATCH_MASK);
+
+	if (wd < 0) {
+		LogWarning("Failed to watch dir[" << path << "] errno : " << errno);
+		return false;
+	}
+
+	dir.watch = wd;
+	m_watches[wd] = path;
+	return true;
+}
+
+void CertificateIndex::list(const std::string &path, bool hashNamed, Directory &dir)
+{
+	if (dir.listed)
+		return;
+
+	std::unique_ptr<DIR, std::function<int(DIR *)>> dp(::opendir(path.c_str()), ::closedir);
+
+	if (dp == nullptr) {
+		LogError("Failed open dir[" << path << "]");
+		return;
+	}
+
+	while (true) {
+		errno = 0;
+		auto dirp = ::readdir(dp.get());
+
+		if (dirp == NULL) {
+			if (errno != 0)
+				LogWarning("Error read dir.");
+
+			break;
+		}
+
+		if (dirp->d_type == DT_DIR)
+			continue;
+
+		std::string name(dirp->d_name);
+
+		if (hashNamed) {
+			dir.files.emplace(name.substr(0, 8), name);
+			continue;
+		}
+
+		try {
+			auto cert = Certificate::createFromFile(path + "/" + name);
+			dir.certs.emplace(cert->getNameHash(Certificate::FIELD_SUBJECT), cert);
+		} catch (const Certificate::Exception::Base &e) {
+			LogWarning("Skip broken certificate[" << name << "] : " << e.DumpToString());
+		}
+	}
+
+	dir.listed = true;
+}
+
+void CertificateIndex::parse(const std::string &path, const std::string &hash, Directory &dir)
+{
+	if (dir.parsed[hash])
+		return;
+
+	auto range = dir.files.equal_range(hash);
+
+	for (auto it = range.first; it != range.second; ++it) {
+		try {
+			auto cert = Certificate::createFromFile(path + "/" + it->second);
+			dir.certs.emplace(hash, cert);
+		} catch (const Certificate::Exception::Base &e) {
+			LogWarning("Skip broken certificate[" << it->second << "] : " << e.DumpToString());
+		}
+	}
+
+	dir.parsed[hash] = true;
+}
+
+CertificatePtr CertificateIndex::findIssuer(const std::string &path, bool hashNamed,
+											const CertificatePtr &cert)
+{
+	std::string hash = cert->getNameHash(Certificate::FIELD_ISSUER);
+	std::string issuer = cert->getOneLine(Certificate::FIELD_ISSUER);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	refresh();
+
+	auto &dir = m_dirs[path];
+	bool cached = watch(path, dir);
+
+	list(path, hashNamed, dir);
+
+	if (hashNamed)
+		parse(path, hash, dir);
+
+	CertificatePtr found;
+	std::string keyId;
+	auto range = dir.certs.equal_range(hash);
+
+	for (auto it = range.first; it != range.second; ++it) {
+		const auto &candidate = it->second;
+
+		if (candidate->getOneLine().compare(issuer) != 0)
+			continue;
+
+		if (!found) {
+			found = candidate;
+			keyId = getAuthorityKeyId(cert);
+
+			if (keyId.empty())
+				break;
+		}
+
+		if (getSubjectKeyId(candidate) == keyId) {
+			found = candidate;
+			break;
+		}
+	}
+
+	if (!cached)
+		m_dirs.erase(path);
+
+	if (found)
+		LogDebug("Found issuer by hash[" << hash << "] in dir[" << path << "]");
+	else
+		LogWarning("cert not found by hash[" << hash << "]");
+
+	return found;
+}
+
+} // namespace ValidationCore
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+/*
+ * @file        CertificateIndex.h
+ * @version     1.0
+ * @brief       Process-wide index of the certificates in CA directories
+ */
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <vcore/Certificate.h>
+
+namespace ValidationCore {
+
+/*
+ * Certificates of a CA directory are parsed once and indexed by subject
+ * name hash, so an issuer is found without reading the directory again.
+ *
+ * - A directory of which the files are named by subject hash
+ *   (e.g. TZ_SYS_CA_CERTS) is listed once and only the files of the
+ *   looked up hash are parsed.
+ * - The other directories (e.g. TZ_SYS_CA_CERTS_TIZEN) are parsed at once.
+ * - The index of a directory is dropped when inotify reports a change in it.
+ *   Without inotify, the directory is read on every lookup as before.
+ *
+ * It is thread-safe.
+ */
+class CertificateIndex {
+public:
+	static CertificateIndex &instance();
+
+	/*
+	 * Return the certificate in |dir| which is the issuer of |cert|.
+	 * If several ones have the subject, the one of which the subject key
+	 * identifier matches the authority key identifier of |cert| is chosen.
+	 */
+	CertificatePtr findIssuer(const std::string &dir, bool hashNamed,
+							  const CertificatePtr &cert);
+
+	CertificateIndex(const CertificateIndex &) = delete;
+	CertificateIndex &operator=(const CertificateIndex &) = delete;
+
+private:
+	CertificateIndex();
+	~CertificateIndex();
+
+	struct Directory {
+		Directory() : watch(-1), listed(false) {}
+
+		int watch;
+		bool listed;
+		// subject name hash -> file name, only for the hash named directory.
+		std::multimap<std::string, std::string> files;
+		// subject name hash -> certificate which is already parsed.
+		std::multimap<std::string, CertificatePtr> certs;
+		std::map<std::string, bool> parsed;
+	};
+
+	void refresh();
+	bool watch(const std::string &path, Directory &dir);
+	void list(const std::string &path, bool hashNamed, Directory &dir);
+	void parse(const std::string &path, const std::string &hash, Directory &dir);
+
+	std::mutex m_mutex;
+	int m_inotify;
+	std::unordered_map<std::string, Directory> m_dirs;
+	std::unordered_map<int, std::string> m_watches;
+};
+
+} // namespace ValidationCore
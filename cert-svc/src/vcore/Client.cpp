@@ -25,15 +25,19 @@
 #include <sys/un.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <poll.h>
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <dpl/log/log.h>
 
 #include <vcore/Client.h>
+#include <vcore/ClientProtocol.h>
 
 namespace {
 
@@ -208,7 +212,7 @@ VcoreRequestData *set_request_data(
 	return pReqData;
 }
 
-VcoreResponseData cert_svc_client_comm(VcoreRequestData *pClientData)
+VcoreResponseData cert_svc_client_comm_fixed(VcoreRequestData *pClientData)
 {
 	int sockfd = 0;
 	int clientLen = 0;
@@ -331,6 +335,417 @@ Error_exit:
 	return recvData;
 }
 
+/*
+ * Connection to cert-server with the framed protocol. It is kept for the next
+ * requests of the process. The server closes it when it is idle, then it is
+ * opened again on the next request.
+ */
+class Connection {
+public:
+	Connection() : m_sockfd(-1), m_pid(0) {}
+	~Connection()
+	{
+		disconnect();
+	}
+
+	Connection(const Connection &) = delete;
+	Connection &operator=(const Connection &) = delete;
+
+	bool connect();
+	void disconnect();
+	bool isReusable() const;
+
+	bool sendAll(const char *data, size_t size);
+	bool recvAll(char *data, size_t size, bool *closed);
+	bool transact(const VcoreFrameWriter &writer, VcoreResponseData &recvData,
+				  VcoreRequestFailure &failure);
+
+private:
+	bool recvFrame(std::unique_ptr<char, void(*)(void *)> &payload, size_t &length,
+				   bool *closed);
+	template <typename T, typename Decode>
+	bool recvList(T *list, size_t count, Decode decode);
+
+	int m_sockfd;
+	pid_t m_pid;
+};
+
+bool Connection::connect()
+{
+	struct sockaddr_un clientaddr;
+	struct timeval timeout;
+	timeout.tv_sec = 10;
+	timeout.tv_usec = 0;
+
+	int sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (sockfd < 0) {
+		LogError("Error in function socket()..");
+		return false;
+	}
+
+	size_t tempSockLen = strlen(VCORE_SOCK_PATH);
+	bzero(&clientaddr, sizeof(clientaddr));
+	clientaddr.sun_family = AF_UNIX;
+	strncpy(clientaddr.sun_path, VCORE_SOCK_PATH, tempSockLen);
+	clientaddr.sun_path[tempSockLen] = '\0';
+
+	if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, (char *)&timeout, sizeof(timeout)) < 0 ||
+			setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, (char *)&timeout, sizeof(timeout)) < 0) {
+		LogError("Error in Set SO_RCVTIMEO/SO_SNDTIMEO Socket Option");
+		close(sockfd);
+		return false;
+	}
+
+	if (::connect(sockfd, (struct sockaddr *)&clientaddr, sizeof(clientaddr)) < 0) {
+		LogError("Error in function connect()..");
+		close(sockfd);
+		return false;
+	}
+
+	m_sockfd = sockfd;
+	m_pid = getpid();
+	return true;
+}
+
+void Connection::disconnect()
+{
+	if (m_sockfd < 0)
+		return;
+
+	/* Do not touch the connection of the parent after fork. */
+	if (m_pid == getpid())
+		close(m_sockfd);
+
+	m_sockfd = -1;
+}
+
+bool Connection::isReusable() const
+{
+	if (m_sockfd < 0 || m_pid != getpid())
+		return false;
+
+	/* Nothing comes without a request, so readable means closed by server. */
+	struct pollfd pfd;
+	pfd.fd = m_sockfd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	return poll(&pfd, 1, 0) == 0;
+}
+
+bool Connection::sendAll(const char *data, size_t size)
+{
+	size_t offset = 0;
+
+	while (offset < size) {
+		ssize_t res = send(m_sockfd, data + offset, size - offset, MSG_NOSIGNAL);
+
+		if (res < 0) {
+			if (errno == EINTR)
+				continue;
+
+			LogError("Error in function send().. errno : " << errno);
+			return false;
+		}
+
+		offset += res;
+	}
+
+	return true;
+}
+
+/* closed is set if the server closed the connection before any byte. */
+bool Connection::recvAll(char *data, size_t size, bool *closed)
+{
+	size_t received = 0;
+	VcoreRecvStatus status = vcore_frame_recv(m_sockfd, data, size, &received);
+
+	if (closed != NULL)
+		*closed = status == VCORE_RECV_CLOSED && received == 0;
+
+	if (status != VCORE_RECV_DONE) {
+		LogError("Failed to receive. status : " << status << ", errno : " << errno);
+		return false;
+	}
+
+	return true;
+}
+
+bool Connection::recvFrame(std::unique_ptr<char, void(*)(void *)> &payload,
+						   size_t &length, bool *closed)
+{
+	VcoreFrameHeader header;
+
+	/* Tell a closed connection from a timeout, which may be still handled. */
+	if (!recvAll((char *)&header, sizeof(header), closed)) {
+		LogError("Failed to receive frame header.");
+		return false;
+	}
+
+	if (header.magic != VCORE_FRAME_MAGIC || header.length > VCORE_FRAME_MAX_LENGTH) {
+		LogError("Invalid frame header. length : " << header.length);
+		return false;
+	}
+
+	payload.reset((char *)malloc(header.length + 1));
+
+	if (!payload) {
+		LogError("Failed to allocate memory");
+		return false;
+	}
+
+	if (!recvAll(payload.get(), header.length, NULL)) {
+		LogError("Failed to receive frame payload.");
+		return false;
+	}
+
+	length = header.length;
+	return true;
+}
+
+template <typename T, typename Decode>
+bool Connection::recvList(T *list, size_t count, Decode decode)
+{
+	size_t received = 0;
+
+	while (received < count) {
+		std::unique_ptr<char, void(*)(void *)> payload(NULL, free);
+		size_t length = 0;
+		uint32_t chunk = 0;
+
+		if (!recvFrame(payload, length, NULL))
+			return false;
+
+		VcoreFrameReader reader = {payload.get(), length, 0};
+
+		if (vcore_frame_get_u32(&reader, &chunk) != CERTSVC_SUCCESS ||
+				chunk == 0 || chunk > count - received)
+			return false;
+
+		for (; chunk > 0; chunk--, received++)
+			if (decode(&reader, list + received) != CERTSVC_SUCCESS)
+				return false;
+	}
+
+	return true;
+}
+
+bool Connection::transact(const VcoreFrameWriter &writer,
+						  VcoreResponseData &recvData, VcoreRequestFailure &failure)
+{
+	std::unique_ptr<char, void(*)(void *)> payload(NULL, free);
+	size_t length = 0;
+	bool closed = false;
+
+	failure = VCORE_FAILED_SEND;
+
+	if (!sendAll(writer.data, writer.size))
+		return false;
+
+	failure = VCORE_FAILED_RESPONSE;
+
+	if (!recvFrame(payload, length, &closed)) {
+		if (closed)
+			failure = VCORE_FAILED_CLOSED;
+
+		return false;
+	}
+
+	VcoreFrameReader reader = {payload.get(), length, 0};
+
+	if (vcore_frame_decode_response(&reader, &recvData) != CERTSVC_SUCCESS) {
+		LogError("Failed to decode response.");
+		return false;
+	}
+
+	if (recvData.certCount > 0) {
+		recvData.certList = (VcoreCertResponseData *)calloc(recvData.certCount,
+							sizeof(VcoreCertResponseData));
+
+		if (!recvData.certList ||
+				!recvList(recvData.certList, recvData.certCount, vcore_frame_get_cert)) {
+			LogError("Failed to receive certificate list.");
+			return false;
+		}
+	}
+
+	if (recvData.certBlockCount > 0) {
+		recvData.certBlockList = (ResponseCertBlock *)calloc(recvData.certBlockCount,
+								 sizeof(ResponseCertBlock));
+
+		if (!recvData.certBlockList ||
+				!recvList(recvData.certBlockList, recvData.certBlockCount, vcore_frame_get_block)) {
+			LogError("Failed to receive certificate blocks.");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Requests of the process with the framed protocol. Each request takes an
+ * idle connection or opens a new one, so requests of threads run at once.
+ *
+ * The protocol is negotiated once with a fixed-size request of
+ * CERTSVC_GET_PROTOCOL_VERSION. A server without the framed protocol reads
+ * the whole request, doesn't know the type and closes without response.
+ */
+class ServerConnection {
+public:
+	static ServerConnection &instance()
+	{
+		static ServerConnection connection;
+		return connection;
+	}
+
+	VcoreResponseData request(VcoreRequestData *pClientData);
+
+private:
+	enum class Protocol {
+		UNKNOWN,
+		FIXED,
+		FRAMED
+	};
+
+	ServerConnection() : m_protocol(Protocol::UNKNOWN) {}
+
+	Protocol protocol();
+	Protocol negotiate();
+
+	std::unique_ptr<Connection> acquire();
+	void release(std::unique_ptr<Connection> &&connection);
+
+	std::mutex m_protocolMutex;
+	Protocol m_protocol;
+
+	std::mutex m_idleMutex;
+	std::vector<std::unique_ptr<Connection>> m_idle;
+};
+
+ServerConnection::Protocol ServerConnection::protocol()
+{
+	std::lock_guard<std::mutex> lock(m_protocolMutex);
+
+	if (m_protocol == Protocol::UNKNOWN)
+		m_protocol = negotiate();
+
+	return m_protocol;
+}
+
+ServerConnection::Protocol ServerConnection::negotiate()
+{
+	std::unique_ptr<VcoreRequestData> request(new VcoreRequestData());
+	std::unique_ptr<VcoreResponseData> response(new VcoreResponseData());
+	Connection connection;
+	bool closed = false;
+
+	request->reqType = CERTSVC_GET_PROTOCOL_VERSION;
+
+	if (!connection.connect() ||
+			!connection.sendAll((const char *)request.get(), sizeof(VcoreRequestData)))
+		return Protocol::UNKNOWN;
+
+	if (connection.recvAll((char *)response.get(), sizeof(VcoreResponseData), &closed)) {
+		LogDebug("Server protocol version : " << response->result);
+		return Protocol::FRAMED;
+	}
+
+	if (closed) {
+		LogWarning("Server does not know the framed protocol. Use fixed protocol.");
+		return Protocol::FIXED;
+	}
+
+	/* Can't tell, ask again on the next request. */
+	return Protocol::UNKNOWN;
+}
+
+std::unique_ptr<Connection> ServerConnection::acquire()
+{
+	std::lock_guard<std::mutex> lock(m_idleMutex);
+
+	if (m_idle.empty())
+		return std::unique_ptr<Connection>(new Connection);
+
+	std::unique_ptr<Connection> connection = std::move(m_idle.back());
+	m_idle.pop_back();
+	return connection;
+}
+
+void ServerConnection::release(std::unique_ptr<Connection> &&connection)
+{
+	std::lock_guard<std::mutex> lock(m_idleMutex);
+
+	if (m_idle.size() < VCORE_MAX_IDLE_CONNECTIONS)
+		m_idle.push_back(std::move(connection));
+}
+
+VcoreResponseData ServerConnection::request(VcoreRequestData *pClientData)
+{
+	VcoreResponseData recvData;
+
+	switch (protocol()) {
+	case Protocol::FIXED:
+		return cert_svc_client_comm_fixed(pClientData);
+
+	case Protocol::UNKNOWN:
+		initialize_res_data(&recvData);
+		recvData.result = VCORE_SOCKET_ERROR;
+		return recvData;
+
+	default:
+		break;
+	}
+
+	VcoreFrameWriter writer = {NULL, 0, 0};
+	std::unique_ptr<VcoreFrameWriter, void(*)(VcoreFrameWriter *)> guard(&writer,
+			vcore_frame_release);
+
+	if (vcore_frame_encode_request(&writer, pClientData) != CERTSVC_SUCCESS) {
+		LogError("Failed to encode request.");
+		initialize_res_data(&recvData);
+		recvData.result = VCORE_SOCKET_ERROR;
+		return recvData;
+	}
+
+	for (int attempt = 0; attempt < 2; attempt++) {
+		std::unique_ptr<Connection> connection = acquire();
+		bool reused = connection->isReusable();
+		VcoreRequestFailure failure = VCORE_FAILED_RESPONSE;
+
+		if (!reused) {
+			connection->disconnect();
+
+			if (!connection->connect())
+				break;
+		}
+
+		initialize_res_data(&recvData);
+
+		if (connection->transact(writer, recvData, failure)) {
+			release(std::move(connection));
+			return recvData;
+		}
+
+		connection->disconnect();
+		free(recvData.certList);
+		free(recvData.certBlockList);
+
+		if (vcore_frame_retry(failure, reused) == VCORE_RETRY_NONE)
+			break;
+	}
+
+	initialize_res_data(&recvData);
+	recvData.result = VCORE_SOCKET_ERROR;
+	return recvData;
+}
+
+VcoreResponseData cert_svc_client_comm(VcoreRequestData *pClientData)
+{
+	return ServerConnection::instance().request(pClientData);
+}
+
 } /* anonymous namespace */
 
 
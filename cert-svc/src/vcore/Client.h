@@ -53,6 +53,7 @@ typedef enum {
 	CERTSVC_GET_USER_CERTIFICATE_LIST,
 	CERTSVC_GET_ROOT_CERTIFICATE_LIST,
 	CERTSVC_LOAD_CERTIFICATES,
+	CERTSVC_GET_PROTOCOL_VERSION,
 } VcoreRequestType;
 
 typedef struct {
@@ -0,0 +1,391 @@
+/**
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @file        ClientProtocol.h
+ * @version     1.0
+ * @brief       Length-prefixed framing between vcore client and cert-server.
+ *
+ * A frame is VcoreFrameHeader followed by |length| bytes of payload.
+ * Integers are 32bit in host order (the socket is local) and a string is
+ * its length followed by the bytes without the terminating NUL.
+ *
+ * Request : one frame with the fields of VcoreRequestData which are in use.
+ * Response: one frame with the fields of VcoreResponseData and the counts of
+ *           the lists, then the list entries in frames of up to
+ *           VCORE_FRAME_LIST_CHUNK entries each.
+ *
+ * The connection is kept after the response, so a client can send the next
+ * request on it. The magic never matches the first field of the fixed-size
+ * VcoreRequestData, so the server accepts both protocols on the same socket.
+ *
+ * A client asks with a fixed-size request of CERTSVC_GET_PROTOCOL_VERSION
+ * before the first framed request. A server without this protocol closes
+ * the connection without response, since it doesn't know the request.
+ */
+
+#ifndef CERT_SVC_CLIENT_PROTOCOL_H_
+#define CERT_SVC_CLIENT_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <vcore/Client.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VCORE_FRAME_MAGIC           0x56434652 /* "VCFR" */
+#define VCORE_FRAME_MAX_LENGTH      (1024 * 1024)
+#define VCORE_FRAME_LIST_CHUNK      64
+/* Answered to CERTSVC_GET_PROTOCOL_VERSION by a server with this protocol. */
+#define VCORE_PROTOCOL_VERSION      1
+/* Kept connections of a client process for the next requests. */
+#define VCORE_MAX_IDLE_CONNECTIONS  4
+
+typedef struct {
+	uint32_t magic;
+	uint32_t length;
+} VcoreFrameHeader;
+
+typedef struct {
+	char  *data;
+	size_t size;
+	size_t capacity;
+} VcoreFrameWriter;
+
+typedef struct {
+	const char *data;
+	size_t      size;
+	size_t      offset;
+} VcoreFrameReader;
+
+/* Start a new frame. The header is filled by vcore_frame_finish(). */
+static inline int vcore_frame_begin(VcoreFrameWriter *writer)
+{
+	writer->size = sizeof(VcoreFrameHeader);
+
+	if (writer->capacity >= writer->size)
+		return CERTSVC_SUCCESS;
+
+	char *data = (char *)realloc(writer->data, 1024);
+
+	if (data == NULL)
+		return CERTSVC_BAD_ALLOC;
+
+	writer->data = data;
+	writer->capacity = 1024;
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_put(VcoreFrameWriter *writer, const void *data, size_t length)
+{
+	if (writer->size + length > writer->capacity) {
+		size_t capacity = writer->capacity * 2;
+
+		while (capacity < writer->size + length)
+			capacity *= 2;
+
+		char *buffer = (char *)realloc(writer->data, capacity);
+
+		if (buffer == NULL)
+			return CERTSVC_BAD_ALLOC;
+
+		writer->data = buffer;
+		writer->capacity = capacity;
+	}
+
+	if (length > 0)
+		memcpy(writer->data + writer->size, data, length);
+
+	writer->size += length;
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_put_u32(VcoreFrameWriter *writer, uint32_t value)
+{
+	return vcore_frame_put(writer, &value, sizeof(value));
+}
+
+static inline int vcore_frame_put_string(VcoreFrameWriter *writer, const char *data,
+		size_t length)
+{
+	if (vcore_frame_put_u32(writer, (uint32_t)length) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	return vcore_frame_put(writer, data, length);
+}
+
+static inline int vcore_frame_finish(VcoreFrameWriter *writer)
+{
+	size_t length = writer->size - sizeof(VcoreFrameHeader);
+
+	if (length > VCORE_FRAME_MAX_LENGTH)
+		return CERTSVC_FAIL;
+
+	VcoreFrameHeader header;
+	header.magic = VCORE_FRAME_MAGIC;
+	header.length = (uint32_t)length;
+	memcpy(writer->data, &header, sizeof(header));
+	return CERTSVC_SUCCESS;
+}
+
+static inline void vcore_frame_release(VcoreFrameWriter *writer)
+{
+	free(writer->data);
+	writer->data = NULL;
+	writer->size = 0;
+	writer->capacity = 0;
+}
+
+static inline int vcore_frame_get_u32(VcoreFrameReader *reader, uint32_t *value)
+{
+	if (reader->size - reader->offset < sizeof(uint32_t))
+		return CERTSVC_FAIL;
+
+	memcpy(value, reader->data + reader->offset, sizeof(uint32_t));
+	reader->offset += sizeof(uint32_t);
+	return CERTSVC_SUCCESS;
+}
+
+/* Copy the string to |buffer| with NUL. Fail if it does not fit. */
+static inline int vcore_frame_get_string(VcoreFrameReader *reader, char *buffer,
+		size_t bufferSize, size_t *length)
+{
+	uint32_t size = 0;
+
+	if (vcore_frame_get_u32(reader, &size) != CERTSVC_SUCCESS ||
+			reader->size - reader->offset < size || size >= bufferSize)
+		return CERTSVC_FAIL;
+
+	memcpy(buffer, reader->data + reader->offset, size);
+	buffer[size] = '\0';
+	reader->offset += size;
+
+	if (length != NULL)
+		*length = size;
+
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_encode_request(VcoreFrameWriter *writer,
+		const VcoreRequestData *request)
+{
+	if (vcore_frame_begin(writer) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)request->reqType) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)request->storeType) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)request->certType) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)request->certStatus) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)request->is_root_app) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, request->gname,
+								   strlen(request->gname)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, request->common_name,
+								   strlen(request->common_name)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, request->private_key_gname,
+								   strlen(request->private_key_gname)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, request->associated_gname,
+								   strlen(request->associated_gname)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, request->dataBlock,
+								   request->dataBlockLen) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	return vcore_frame_finish(writer);
+}
+
+static inline int vcore_frame_decode_request(VcoreFrameReader *reader,
+		VcoreRequestData *request)
+{
+	uint32_t reqType, storeType, certType, certStatus, is_root_app;
+
+	memset(request, 0x00, sizeof(VcoreRequestData));
+
+	if (vcore_frame_get_u32(reader, &reqType) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &storeType) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &certType) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &certStatus) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &is_root_app) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, request->gname,
+								   sizeof(request->gname), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, request->common_name,
+								   sizeof(request->common_name), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, request->private_key_gname,
+								   sizeof(request->private_key_gname), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, request->associated_gname,
+								   sizeof(request->associated_gname), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, request->dataBlock,
+								   sizeof(request->dataBlock), &request->dataBlockLen) != CERTSVC_SUCCESS)
+		return CERTSVC_FAIL;
+
+	request->reqType = (VcoreRequestType)reqType;
+	request->storeType = (CertStoreType)storeType;
+	request->certType = (CertType)certType;
+	request->certStatus = (CertStatus)certStatus;
+	request->is_root_app = (int)is_root_app;
+	return CERTSVC_SUCCESS;
+}
+
+/* The first frame of the response. The lists follow in the next frames. */
+static inline int vcore_frame_encode_response(VcoreFrameWriter *writer,
+		const VcoreResponseData *response)
+{
+	if (vcore_frame_begin(writer) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)response->result) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)response->certStatus) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)response->isAliasUnique) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)response->certCount) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)response->certBlockCount) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, response->dataBlock,
+								   response->dataBlockLen) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, response->common_name,
+								   strlen(response->common_name)) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	return vcore_frame_finish(writer);
+}
+
+static inline int vcore_frame_decode_response(VcoreFrameReader *reader,
+		VcoreResponseData *response)
+{
+	uint32_t result, certStatus, isAliasUnique, certCount, certBlockCount;
+
+	if (vcore_frame_get_u32(reader, &result) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &certStatus) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &isAliasUnique) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &certCount) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &certBlockCount) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, response->dataBlock,
+								   sizeof(response->dataBlock), &response->dataBlockLen) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, response->common_name,
+								   sizeof(response->common_name), NULL) != CERTSVC_SUCCESS)
+		return CERTSVC_FAIL;
+
+	response->result = (int)result;
+	response->certStatus = (CertStatus)certStatus;
+	response->isAliasUnique = (int)isAliasUnique;
+	response->certCount = certCount;
+	response->certBlockCount = certBlockCount;
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_put_cert(VcoreFrameWriter *writer,
+									   const VcoreCertResponseData *cert)
+{
+	if (vcore_frame_put_string(writer, cert->gname, strlen(cert->gname)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_string(writer, cert->title, strlen(cert->title)) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)cert->status) != CERTSVC_SUCCESS ||
+			vcore_frame_put_u32(writer, (uint32_t)cert->storeType) != CERTSVC_SUCCESS)
+		return CERTSVC_BAD_ALLOC;
+
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_get_cert(VcoreFrameReader *reader, VcoreCertResponseData *cert)
+{
+	uint32_t status, storeType;
+
+	if (vcore_frame_get_string(reader, cert->gname, sizeof(cert->gname), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_string(reader, cert->title, sizeof(cert->title), NULL) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &status) != CERTSVC_SUCCESS ||
+			vcore_frame_get_u32(reader, &storeType) != CERTSVC_SUCCESS)
+		return CERTSVC_FAIL;
+
+	cert->status = (CertStatus)status;
+	cert->storeType = (CertStoreType)storeType;
+	return CERTSVC_SUCCESS;
+}
+
+static inline int vcore_frame_put_block(VcoreFrameWriter *writer, const ResponseCertBlock *block)
+{
+	return vcore_frame_put_string(writer, block->dataBlock, block->dataBlockLen);
+}
+
+static inline int vcore_frame_get_block(VcoreFrameReader *reader, ResponseCertBlock *block)
+{
+	return vcore_frame_get_string(reader, block->dataBlock, sizeof(block->dataBlock),
+								  &block->dataBlockLen);
+}
+
+typedef enum {
+	VCORE_RECV_DONE,    /* all bytes are received */
+	VCORE_RECV_CLOSED,  /* the peer closed or reset the connection */
+	VCORE_RECV_FAILED,  /* timed out (SO_RCVTIMEO) or other error */
+} VcoreRecvStatus;
+
+/* Receive |length| bytes. |received| is set even if it fails. */
+static inline VcoreRecvStatus vcore_frame_recv(int sockfd, char *buffer, size_t length,
+		size_t *received)
+{
+	*received = 0;
+
+	while (*received < length) {
+		ssize_t res = recv(sockfd, buffer + *received, length - *received, 0);
+
+		if (res < 0 && errno == EINTR)
+			continue;
+
+		if (res == 0 || (res < 0 && errno == ECONNRESET))
+			return VCORE_RECV_CLOSED;
+
+		if (res < 0)
+			return VCORE_RECV_FAILED;
+
+		*received += res;
+	}
+
+	return VCORE_RECV_DONE;
+}
+
+typedef enum {
+	VCORE_FAILED_SEND,      /* the request was not sent */
+	VCORE_FAILED_CLOSED,    /* closed before any byte of the response */
+	VCORE_FAILED_RESPONSE,  /* timed out or broken after the request was sent */
+} VcoreRequestFailure;
+
+typedef enum {
+	VCORE_RETRY_NONE,
+	VCORE_RETRY_FRAMED,  /* send it again on a new connection */
+} VcoreRetry;
+
+/*
+ * Decide what to do after a request failed on a connection.
+ * The server may have handled the request unless it was not sent, or a
+ * kept connection was closed before the response began, since the server
+ * closes a kept connection only while it is idle. A timeout proves neither,
+ * so the request is never sent again after it.
+ */
+static inline VcoreRetry vcore_frame_retry(VcoreRequestFailure failure, int reused)
+{
+	switch (failure) {
+	case VCORE_FAILED_SEND:
+		return VCORE_RETRY_FRAMED;
+
+	case VCORE_FAILED_CLOSED:
+		return reused ? VCORE_RETRY_FRAMED : VCORE_RETRY_NONE;
+
+	default:
+		return VCORE_RETRY_NONE;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,12 +20,22 @@
  * @brief       OCSP check for signature validator. It should be used only internally.
  */
 
-#include <memory>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 #include <openssl/ssl.h>
 #include <openssl/ocsp.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
 
 #include <dpl/log/log.h>
 #include <vcore/CryptoInit.h>
@@ -35,6 +45,9 @@
 /* Maximum leeway in validity period : 5 minitues as a default */
 #define MAX_VALIDITY_PERIOD (5 * 60)
 
+/* Maximum number of responses cached in memory */
+#define MAX_CACHED_RESPONSES 256
+
 namespace {
 
 typedef std::unique_ptr<X509_STORE_CTX, std::function<void(X509_STORE_CTX *)>> X509_STORE_CTX_PTR;
@@ -46,6 +59,7 @@ typedef std::unique_ptr<char,           std::function<void(void *)>> RAIIstr;
 typedef std::unique_ptr<OCSP_REQUEST,   std::function<void(OCSP_REQUEST *)>> OCSP_REQUEST_PTR;
 typedef std::unique_ptr<OCSP_RESPONSE,  std::function<void(OCSP_RESPONSE *)>> OCSP_RESPONSE_PTR;
 typedef std::unique_ptr<OCSP_BASICRESP, std::function<void(OCSP_BASICRESP *)>> OCSP_BASICRESP_PTR;
+typedef std::unique_ptr<OCSP_CERTID,    std::function<void(OCSP_CERTID *)>> OCSP_CERTID_PTR;
 
 inline X509_STACK_PTR create_x509_stack()
 {
@@ -96,6 +110,11 @@ inline OCSP_BASICRESP_PTR create_OCSP_BASICRESP(OCSP_BASICRESP *basicResp)
 	return OCSP_BASICRESP_PTR(basicResp, OCSP_BASICRESP_free);
 }
 
+inline OCSP_CERTID_PTR create_OCSP_CERTID(OCSP_CERTID *certid)
+{
+	return OCSP_CERTID_PTR(certid, OCSP_CERTID_free);
+}
+
 void BIO_write_and_free(BIO *bio)
 {
 	if (!bio)
@@ -125,22 +144,31 @@ Ocsp::~Ocsp()
 {
 }
 
-Ocsp::Result checkInternal(
-	const CertificatePtr &_cert,
-	const CertificatePtr &_issuer,
-	X509_STACK_PTR &trustedCerts)
+namespace {
+
+/*
+ *  SSL context is shared by the connections to the responders.
+ */
+SSL_CTX *getSSLContext()
 {
-	/* initialize openssl library */
-	CryptoInitSingleton::Instance();
-	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
-	X509 *cert = _cert->getX509();
-	X509 *issuer = _issuer->getX509();
-	std::string ocspUrl = _cert->getOCSPURL();
+	static SSL_CTX_PTR sslCtx = []() {
+		SSL_CTX_PTR ctx = create_SSL_CTX();
 
-	if (ocspUrl.empty())
-		VcoreThrowMsg(Ocsp::Exception::OcspUnsupported,
-					  "Certificate[" << _cert->getOneLine() << "] doesn't provide OCSP extension");
+		if (ctx.get() != NULL)
+			SSL_CTX_set_mode(ctx.get(), SSL_MODE_AUTO_RETRY);
+
+		return ctx;
+	}();
 
+	return sslCtx.get();
+}
+
+/*
+ *  Default transport. Send the request to the responder by HTTP(S).
+ */
+std::string sendRequest(const std::string &ocspUrl, const std::string &request)
+{
+	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
 	char *_ocspUrl = new char[ocspUrl.length() + 1];
 
 	if (_ocspUrl == NULL)
@@ -178,22 +206,21 @@ Ocsp::Result checkInternal(
 		BIO_set_conn_port(cbio.get(), port.get());
 
 	if (use_ssl == 1) {
-		SSL_CTX_PTR ssl_ctx = create_SSL_CTX();
+		SSL_CTX *ssl_ctx = getSSLContext();
 
-		if (ssl_ctx.get() == NULL) {
+		if (ssl_ctx == NULL) {
 			ERR_print_errors(bioLogger.get());
 			VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to SSL_CTX_new");
 		}
 
-		SSL_CTX_set_mode(ssl_ctx.get(), SSL_MODE_AUTO_RETRY);
-		BIO_PTR sbio = create_BIO(BIO_new_ssl(ssl_ctx.get(), 1));
+		BIO_PTR sbio = create_BIO(BIO_new_ssl(ssl_ctx, 1));
 
 		if (sbio.get() == NULL) {
 			ERR_print_errors(bioLogger.get());
 			VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to BIO_new_ssl");
 		}
 
-		cbio.reset(BIO_push(sbio.get(), cbio.get()));
+		cbio.reset(BIO_push(sbio.release(), cbio.release()));
 
 		if (cbio.get() == NULL) {
 			ERR_print_errors(bioLogger.get());
@@ -206,23 +233,12 @@ Ocsp::Result checkInternal(
 		VcoreThrowMsg(Ocsp::Exception::NetworkError, "Failed to BIO_do_connect");
 	}
 
-	OCSP_REQUEST_PTR req = create_OCSP_REQUEST();
+	const unsigned char *der = reinterpret_cast<const unsigned char *>(request.data());
+	OCSP_REQUEST_PTR req(d2i_OCSP_REQUEST(NULL, &der, request.size()), OCSP_REQUEST_free);
 
 	if (req.get() == NULL) {
 		ERR_print_errors(bioLogger.get());
-		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_REQUEST_new");
-	}
-
-	OCSP_CERTID *certid = OCSP_cert_to_id(NULL, cert, issuer);
-
-	if (certid == NULL) {
-		ERR_print_errors(bioLogger.get());
-		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_cert_to_id");
-	}
-
-	if (OCSP_request_add0_id(req.get(), certid) == NULL) {
-		ERR_print_errors(bioLogger.get());
-		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_request_add0_id");
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to decode OCSP_REQUEST");
 	}
 
 	OCSP_RESPONSE_PTR resp;
@@ -286,6 +302,290 @@ Ocsp::Result checkInternal(
 		VcoreThrowMsg(Ocsp::Exception::NetworkError, "Failed to OCSP_sendreq_bio");
 	}
 
+	unsigned char *respDer = NULL;
+	int respLen = i2d_OCSP_RESPONSE(resp.get(), &respDer);
+
+	if (respLen <= 0) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::InvalidResponse, "Failed to encode OCSP_RESPONSE");
+	}
+
+	std::string response(reinterpret_cast<char *>(respDer), respLen);
+	OPENSSL_free(respDer);
+	return response;
+}
+
+/*
+ *  Verified responses keyed by DER of OCSP_CERTID and the certificates the
+ *  response was verified with (see toCacheKey). An entry is fresh until
+ *  nextUpdate of the response. A response without nextUpdate isn't cached
+ *  because newer information is always available from the responder.
+ */
+class OcspCache {
+public:
+	static OcspCache &instance()
+	{
+		static OcspCache cache;
+		return cache;
+	}
+
+	bool find(const std::string &key, Ocsp::Result &result)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(key);
+
+		if (it == m_entries.end())
+			return false;
+
+		if (it->second.expiry <= time(NULL)) {
+			m_entries.erase(it);
+			return false;
+		}
+
+		result = it->second.result;
+		return true;
+	}
+
+	void insert(const std::string &key, Ocsp::Result result, time_t expiry)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_entries.size() >= MAX_CACHED_RESPONSES) {
+			time_t now = time(NULL);
+
+			for (auto it = m_entries.begin(); it != m_entries.end();) {
+				if (it->second.expiry <= now)
+					it = m_entries.erase(it);
+				else
+					++it;
+			}
+
+			if (m_entries.size() >= MAX_CACHED_RESPONSES)
+				m_entries.clear();
+		}
+
+		m_entries[key] = Entry {result, expiry};
+	}
+
+	/*
+	 *  Replace the file at once, so a reader never gets a partial response.
+	 *  It is written without the lock, so each call uses its own temp file.
+	 */
+	void store(const std::string &key, const std::string &response)
+	{
+		static std::atomic<unsigned int> sequence(0);
+		std::string directory = getDirectory();
+
+		if (directory.empty())
+			return;
+
+		std::string path = directory + "/" + key;
+		std::string temp = path + ".tmp" + std::to_string(getpid()) + "." +
+						   std::to_string(sequence++);
+
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write(response.data(), response.size());
+
+			if (!file.flush()) {
+				LogWarning("Failed to store ocsp response : " << temp);
+				file.close();
+				unlink(temp.c_str());
+				return;
+			}
+		}
+
+		if (rename(temp.c_str(), path.c_str()) != 0) {
+			LogWarning("Failed to store ocsp response : " << path);
+			unlink(temp.c_str());
+		}
+	}
+
+	bool load(const std::string &key, std::string &response)
+	{
+		std::string directory = getDirectory();
+
+		if (directory.empty())
+			return false;
+
+		std::ifstream file(directory + "/" + key, std::ios::binary);
+
+		if (!file)
+			return false;
+
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		response = buffer.str();
+		return !response.empty();
+	}
+
+	void remove(const std::string &key)
+	{
+		std::string directory = getDirectory();
+
+		if (!directory.empty())
+			unlink((directory + "/" + key).c_str());
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+	}
+
+	void setDirectory(const std::string &directory)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_directory = directory;
+	}
+
+	std::string getDirectory()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_directory;
+	}
+
+	void setTransport(const Ocsp::Transport &transport)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_transport = transport;
+	}
+
+	Ocsp::Transport getTransport()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_transport ? m_transport : Ocsp::Transport(sendRequest);
+	}
+
+private:
+	struct Entry {
+		Ocsp::Result result;
+		time_t expiry;
+	};
+
+	OcspCache() {}
+
+	std::mutex m_mutex;
+	std::map<std::string, Entry> m_entries;
+	std::string m_directory;
+	Ocsp::Transport m_transport;
+};
+
+std::string toHex(const unsigned char *data, size_t len)
+{
+	static const char HEX[] = "0123456789abcdef";
+	std::string hex;
+	hex.reserve(len * 2);
+
+	for (size_t i = 0; i < len; i++) {
+		hex.push_back(HEX[data[i] >> 4]);
+		hex.push_back(HEX[data[i] & 0x0f]);
+	}
+
+	return hex;
+}
+
+/*
+ *  "<hex of DER of OCSP_CERTID>.<sha256 of the trusted certs and issuer>".
+ *  A result verified with one trust set isn't reused for another one.
+ */
+std::string toCacheKey(OCSP_CERTID *certid, X509 *issuer, X509_STACK_PTR &trustedCerts)
+{
+	unsigned char *der = NULL;
+	int len = i2d_OCSP_CERTID(certid, &der);
+
+	if (len <= 0)
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to i2d_OCSP_CERTID");
+
+	std::string key = toHex(der, len);
+	OPENSSL_free(der);
+
+	std::string digests;
+	unsigned char md[EVP_MAX_MD_SIZE];
+	unsigned int mdLen = 0;
+	int count = trustedCerts.get() ? sk_X509_num(trustedCerts.get()) : 0;
+
+	for (int idx = 0; idx <= count; idx++) {
+		X509 *cert = idx < count ? sk_X509_value(trustedCerts.get(), idx) : issuer;
+
+		if (!X509_digest(cert, EVP_sha256(), md, &mdLen))
+			VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to X509_digest");
+
+		digests.append(reinterpret_cast<char *>(md), mdLen);
+	}
+
+	if (!EVP_Digest(digests.data(), digests.size(), md, &mdLen, EVP_sha256(), NULL))
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to EVP_Digest");
+
+	return key + "." + toHex(md, mdLen);
+}
+
+/* A fresh request carries a nonce which the response may echo. */
+OCSP_REQUEST_PTR makeRequest(OCSP_CERTID *certid)
+{
+	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
+	OCSP_REQUEST_PTR req = create_OCSP_REQUEST();
+
+	if (req.get() == NULL) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_REQUEST_new");
+	}
+
+	OCSP_CERTID *id = OCSP_CERTID_dup(certid);
+
+	if (id == NULL || OCSP_request_add0_id(req.get(), id) == NULL) {
+		OCSP_CERTID_free(id);
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_request_add0_id");
+	}
+
+	if (OCSP_request_add1_nonce(req.get(), NULL, -1) == 0) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_request_add1_nonce");
+	}
+
+	return req;
+}
+
+std::string encodeRequest(OCSP_REQUEST *req)
+{
+	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
+	unsigned char *der = NULL;
+	int len = i2d_OCSP_REQUEST(req, &der);
+
+	if (len <= 0) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to i2d_OCSP_REQUEST");
+	}
+
+	std::string request(reinterpret_cast<char *>(der), len);
+	OPENSSL_free(der);
+	return request;
+}
+
+/*
+ *  Verify the DER encoded response and get the status of certid.
+ *  req is the request of a fresh response, or NULL for a stored one.
+ *  expiry is set to nextUpdate of the response, or 0 if it doesn't have one.
+ */
+Ocsp::Result verifyResponse(
+	const std::string &response,
+	OCSP_CERTID *certid,
+	X509 *issuer,
+	X509_STACK_PTR &trustedCerts,
+	OCSP_REQUEST *req,
+	time_t &expiry)
+{
+	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
+	const unsigned char *der = reinterpret_cast<const unsigned char *>(response.data());
+	OCSP_RESPONSE_PTR resp = create_OCSP_RESPONSE(
+		d2i_OCSP_RESPONSE(NULL, &der, response.size()));
+
+	if (resp.get() == NULL) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::InvalidResponse, "Failed to decode OCSP_RESPONSE");
+	}
+
 	if (OCSP_response_status(resp.get()) != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
 		ERR_print_errors(bioLogger.get());
 		VcoreThrowMsg(Ocsp::Exception::ServerError, "Failed to OCSP_response_status");
@@ -313,7 +613,8 @@ Ocsp::Result checkInternal(
 		VcoreThrowMsg(Ocsp::Exception::InvalidResponse, "Failed to OCSP_basic_verify");
 	}
 
-	if (OCSP_check_nonce(req.get(), basicResp.get()) == 0) {
+	/* a responder may omit the nonce, but it shouldn't answer another one. */
+	if (req != NULL && OCSP_check_nonce(req, basicResp.get()) == 0) {
 		ERR_print_errors(bioLogger.get());
 		VcoreThrowMsg(Ocsp::Exception::InvalidResponse, "nonce exists but not equal");
 	}
@@ -344,10 +645,82 @@ Ocsp::Result checkInternal(
 	if (ocspStatus != V_OCSP_CERTSTATUS_GOOD && ocspStatus != V_OCSP_CERTSTATUS_REVOKED)
 		VcoreThrowMsg(Ocsp::Exception::InvalidResponse, "Unknown ocsp status.");
 
+	int day = 0;
+	int sec = 0;
+	expiry = 0;
+
+	if (nextupd != NULL && ASN1_TIME_diff(&day, &sec, NULL, nextupd))
+		expiry = time(NULL) + static_cast<time_t>(day) * 24 * 60 * 60 + sec;
+
 	return ocspStatus == V_OCSP_CERTSTATUS_GOOD ?
 		   Ocsp::Result::GOOD : Ocsp::Result::REVOKED;
 }
 
+} // namespace anonymous
+
+Ocsp::Result checkInternal(
+	const CertificatePtr &_cert,
+	const CertificatePtr &_issuer,
+	X509_STACK_PTR &trustedCerts)
+{
+	/* initialize openssl library */
+	CryptoInitSingleton::Instance();
+	BIO_PTR bioLogger(BIO_new(BIO_s_mem()), BIO_write_and_free);
+	X509 *cert = _cert->getX509();
+	X509 *issuer = _issuer->getX509();
+	std::string ocspUrl = _cert->getOCSPURL();
+
+	if (ocspUrl.empty())
+		VcoreThrowMsg(Ocsp::Exception::OcspUnsupported,
+					  "Certificate[" << _cert->getOneLine() << "] doesn't provide OCSP extension");
+
+	OCSP_CERTID_PTR certid = create_OCSP_CERTID(OCSP_cert_to_id(NULL, cert, issuer));
+
+	if (certid.get() == NULL) {
+		ERR_print_errors(bioLogger.get());
+		VcoreThrowMsg(Ocsp::Exception::UnknownError, "Failed to OCSP_cert_to_id");
+	}
+
+	OcspCache &cache = OcspCache::instance();
+	std::string key = toCacheKey(certid.get(), issuer, trustedCerts);
+	Ocsp::Result result;
+	time_t expiry = 0;
+
+	if (cache.find(key, result)) {
+		LogDebug("Use cached ocsp response.");
+		return result;
+	}
+
+	std::string response;
+
+	if (cache.load(key, response)) {
+		try {
+			result = verifyResponse(response, certid.get(), issuer, trustedCerts, NULL, expiry);
+
+			if (expiry > time(NULL)) {
+				LogDebug("Use stored ocsp response.");
+				cache.insert(key, result, expiry);
+				return result;
+			}
+		} catch (const Ocsp::Exception::Base &e) {
+			LogWarning("Stored ocsp response is invalid : " << e.DumpToString());
+		}
+
+		cache.remove(key);
+	}
+
+	OCSP_REQUEST_PTR req = makeRequest(certid.get());
+	response = cache.getTransport()(ocspUrl, encodeRequest(req.get()));
+	result = verifyResponse(response, certid.get(), issuer, trustedCerts, req.get(), expiry);
+
+	if (expiry > time(NULL)) {
+		cache.insert(key, result, expiry);
+		cache.store(key, response);
+	}
+
+	return result;
+}
+
 Ocsp::Result Ocsp::check(const SignatureData &data)
 {
 	if (!data.isCertListSorted())
@@ -388,4 +761,19 @@ Ocsp::Result Ocsp::check(const SignatureData &data)
 	return Result::GOOD;
 }
 
+void Ocsp::setTransport(const Transport &transport)
+{
+	OcspCache::instance().setTransport(transport);
+}
+
+void Ocsp::setCacheDirectory(const std::string &path)
+{
+	OcspCache::instance().setDirectory(path);
+}
+
+void Ocsp::clearCache()
+{
+	OcspCache::instance().clear();
+}
+
 }
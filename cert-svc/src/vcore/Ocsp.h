@@ -21,6 +21,9 @@
  */
 #pragma once
 
+#include <functional>
+#include <string>
+
 #include <vcore/SignatureData.h>
 #include <vcore/exception.h>
 
@@ -47,11 +50,36 @@ public:
 		REVOKED
 	};
 
+	/*
+	 *  Sends DER encoded OCSP request to the url of the responder and
+	 *  returns DER encoded response. Throws Ocsp::Exception on failure.
+	 */
+	using Transport = std::function<std::string(const std::string &url,
+												const std::string &request)>;
+
 	/*
 	 *  Remarks: input cert chain should be sorted state.
+	 *           Verified response is reused until its nextUpdate.
 	 */
 	static Result check(const SignatureData &data);
 
+	/*
+	 *  Replace the HTTP transport. (e.g. to feed canned responses in test)
+	 *  nullptr restores the default one.
+	 */
+	static void setTransport(const Transport &transport);
+
+	/*
+	 *  Keep verified responses also in the directory to reuse them in other
+	 *  processes. They are verified again when loaded. Empty path disables it.
+	 */
+	static void setCacheDirectory(const std::string &path);
+
+	/*
+	 *  Drop the responses cached in memory.
+	 */
+	static void clearCache();
+
 private:
 	explicit Ocsp();
 };
@@ -24,14 +24,16 @@
 
 #include <dirent.h>
 #include <errno.h>
-#include <fstream>
-#include <functional>
-#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
 #include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
-#include <pcrecpp.h>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <unordered_set>
 
 #include <dpl/log/log.h>
 
@@ -44,9 +46,13 @@ namespace ValidationCore {
 namespace {
 
 const char *AUTHOR_SIGNATURE = "author-signature.xml";
-const char *REGEXP_DISTRIBUTOR_SIGNATURE = "^signature[1-9][0-9]*\\.xml";
+const char *DISTRIBUTOR_SIGNATURE_PREFIX = "signature";
+const char *DISTRIBUTOR_SIGNATURE_SUFFIX = ".xml";
 const char MARK_ENCODED_CHAR = '%';
 
+using References = std::unordered_set<std::string>;
+using DirPtr = std::unique_ptr<DIR, std::function<int(DIR *)>>;
+
 struct dirent *readdir(DIR *dirp) {
 	errno = 0;
 	auto ret = ::readdir(dirp);
@@ -55,13 +61,71 @@ struct dirent *readdir(DIR *dirp) {
 	return ret;
 }
 
+// Same as "^signature[1-9][0-9]*\.xml" full match.
+bool isDistributorSignature(const char *name)
+{
+	size_t prefixLen = strlen(DISTRIBUTOR_SIGNATURE_PREFIX);
+
+	if (strncmp(name, DISTRIBUTOR_SIGNATURE_PREFIX, prefixLen) != 0)
+		return false;
+
+	const char *p = name + prefixLen;
+
+	if (*p < '1' || *p > '9')
+		return false;
+
+	while (*p >= '0' && *p <= '9')
+		++p;
+
+	return strcmp(p, DISTRIBUTOR_SIGNATURE_SUFFIX) == 0;
+}
+
+int hexToInt(char a)
+{
+	if (a >= '0' && a <= '9') return a - '0';
+
+	if (a >= 'A' && a <= 'F') return a - 'A' + 10;
+
+	if (a >= 'a' && a <= 'f') return a - 'a' + 10;
+
+	return -1;
+}
+
+bool decodePercent(const std::string &path, std::string &out)
+{
+	out.clear();
+	out.reserve(path.size());
+
+	for (size_t i = 0; i < path.size(); ++i) {
+		if (path[i] != MARK_ENCODED_CHAR) {
+			out.push_back(path[i]);
+			continue;
+		}
+
+		if (i + 2 >= path.size())
+			return false;
+
+		int high = hexToInt(path[i + 1]);
+		int low = hexToInt(path[i + 2]);
+
+		if (high < 0 || low < 0) {
+			LogError("Symbol is out of scope.");
+			return false;
+		}
+
+		out.push_back(static_cast<char>(high * 16 + low));
+		i += 2;
+	}
+
+	return true;
+}
+
 } // anonymous namespace
 
 class ReferenceValidator::Impl {
 public:
 	Impl(const std::string &dirpath)
 		: m_dirpath(dirpath)
-		, m_signatureRegexp(REGEXP_DISTRIBUTOR_SIGNATURE)
 	{}
 
 	virtual ~Impl() {}
@@ -69,23 +133,21 @@ public:
 	Result checkReferences(const SignatureData &signatureData)
 	{
 		const ReferenceSet &refSet = signatureData.getReferenceSet();
-		ReferenceSet refDecoded;
-
-		try {
-			for (auto it = refSet.begin(); it != refSet.end(); ++it) {
-				if (std::string::npos != it->find(MARK_ENCODED_CHAR))
-					refDecoded.insert(decodeProcent(*it));
-				else
-					refDecoded.insert(*it);
+		References refDecoded(refSet.size());
+		std::string decoded;
+
+		for (const auto &ref : refSet) {
+			if (std::string::npos == ref.find(MARK_ENCODED_CHAR)) {
+				refDecoded.insert(ref);
+			} else if (decodePercent(ref, decoded)) {
+				refDecoded.insert(decoded);
+			} else {
+				LogError("Error while decoding url path : " << ref);
+				return ERROR_DECODING_URL;
 			}
-		} catch (Result &) {
-			return ERROR_DECODING_URL;
 		}
 
-		return dfsCheckDirectories(
-				   refDecoded,
-				   std::string(),
-				   signatureData.isAuthorSignature());
+		return checkDirectories(refDecoded, signatureData.isAuthorSignature());
 	}
 
 	Result checkOutbound(const std::string &linkPath, const std::string &appPath)
@@ -104,135 +166,165 @@ public:
 	}
 
 private:
-	int hexToInt(char hex);
-	std::string decodeProcent(const std::string &path);
+	Result checkDirectories(const References &references, bool isAuthorSignature);
 
-	Result dfsCheckDirectories(
-		const ReferenceSet &referenceSet,
-		const std::string &directory,
-		bool isAuthorSignature);
-
-	inline bool isDistributorSignature(const char *cstring) const
-	{
-		return m_signatureRegexp.FullMatch(cstring);
-	}
+	Result getType(int dirfd, const std::string &path, struct dirent *dirp,
+				   unsigned char &type);
+	Result checkEntry(int dirfd, const char *name, unsigned char type,
+					  std::string &path, const References &references);
+	Result walkDirectory(int dirfd, std::string &path, const References &references);
 
 	std::string m_dirpath;
-	pcrecpp::RE m_signatureRegexp;
 };
 
-int ReferenceValidator::Impl::hexToInt(char a)
+ReferenceValidator::Result ReferenceValidator::Impl::getType(
+	int dirfd,
+	const std::string &path,
+	struct dirent *dirp,
+	unsigned char &type)
 {
-	if (a >= '0' && a <= '9') return a - '0';
+	type = dirp->d_type;
 
-	if (a >= 'A' && a <= 'F') return a - 'A' + 10;
+	if (type != DT_UNKNOWN)
+		return NO_ERROR;
 
-	if (a >= 'a' && a <= 'f') return a - 'a' + 10;
+	// try to stat inode when readdir is not returning known type
+	struct stat s;
+	if (fstatat(dirfd, dirp->d_name, &s, AT_SYMLINK_NOFOLLOW) != 0) {
+		LogError("Error lstat : " << path << dirp->d_name);
+		return ERROR_LSTAT;
+	}
 
-	LogError("Symbol '" << a << "' is out of scope.");
-	throw ERROR_DECODING_URL;
+	if (S_ISREG(s.st_mode))
+		type = DT_REG;
+	else if (S_ISDIR(s.st_mode))
+		type = DT_DIR;
+	else if (S_ISLNK(s.st_mode))
+		type = DT_LNK;
+
+	return NO_ERROR;
 }
 
-std::string ReferenceValidator::Impl::decodeProcent(const std::string &path)
+/*
+ *  Check an entry of which the parent is dirfd. path is the relative path
+ *  of the parent with trailing '/', which is restored on return.
+ */
+ReferenceValidator::Result ReferenceValidator::Impl::checkEntry(
+	int dirfd,
+	const char *name,
+	unsigned char type,
+	std::string &path,
+	const References &references)
 {
-	std::vector<int> input(path.begin(), path.end());
-	std::vector<char> output;
-
-	try {
-		size_t i = 0;
+	size_t length = path.size();
+	Result result = NO_ERROR;
+	path += name;
 
-		while (i < input.size()) {
-			if (MARK_ENCODED_CHAR == input[i]) {
-				if (i + 2 >= input.size())
-					throw ERROR_DECODING_URL;
+	if (type == DT_DIR) {
+		LogDebug("Open directory : " << path);
+		int fd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
 
-				int result = hexToInt(input[i + 1]) * 16 + hexToInt(input[i + 2]);
-				output.push_back(static_cast<char>(result));
-				i += 3;
-			} else {
-				output.push_back(static_cast<char>(input[i]));
-				++i;
-			}
+		if (fd < 0) {
+			LogError("Error opening directory : " << path);
+			result = ERROR_OPENING_DIR;
+		} else {
+			path += '/';
+			result = walkDirectory(fd, path, references);
+		}
+	} else if (type == DT_REG) {
+		if (references.end() == references.find(path)) {
+			LogError("Cannot find : " << path);
+			result = ERROR_REFERENCE_NOT_FOUND;
 		}
-	} catch (Result &) {
-		LogError("Error while decoding url path : " << path);
-		throw ERROR_DECODING_URL;
+	} else if (type == DT_LNK) {
+		if (references.end() == references.find(path)) {
+			LogError("Cannot find : " << path);
+			result = ERROR_REFERENCE_NOT_FOUND;
+		} else {
+			result = checkOutbound(path, m_dirpath);
+			if (result != NO_ERROR)
+				LogError("Link file point wrong path. : " << path);
+		}
+	} else {
+		LogError("Unknown file type.");
+		result = ERROR_UNSUPPORTED_FILE_TYPE;
+	}
+
+	path.resize(length);
+	return result;
+}
+
+/*
+ *  Walk the directory relative to the opened fd, which is owned and
+ *  closed here, so the full path is never resolved again by the kernel.
+ */
+ReferenceValidator::Result ReferenceValidator::Impl::walkDirectory(
+	int dirfd,
+	std::string &path,
+	const References &references)
+{
+	DirPtr dp(::fdopendir(dirfd), ::closedir);
+
+	if (dp == nullptr) {
+		LogError("Error opening directory : " << path);
+		close(dirfd);
+		return ERROR_OPENING_DIR;
 	}
 
-	return std::string(output.begin(), output.end());
+	while (auto dirp = ValidationCore::readdir(dp.get())) {
+		if (!strcmp(dirp->d_name, ".") || !strcmp(dirp->d_name, ".."))
+			continue;
+
+		unsigned char type;
+		Result result = getType(dirfd, path, dirp, type);
+
+		if (result == NO_ERROR)
+			result = checkEntry(dirfd, dirp->d_name, type, path, references);
+
+		if (result != NO_ERROR)
+			return result;
+	}
+
+	return NO_ERROR;
 }
 
-ReferenceValidator::Result ReferenceValidator::Impl::dfsCheckDirectories(
-	const ReferenceSet &referenceSet,
-	const std::string &directory,
+ReferenceValidator::Result ReferenceValidator::Impl::checkDirectories(
+	const References &references,
 	bool isAuthorSignature)
 {
-	std::string currentDir = m_dirpath;
-	if (!directory.empty())
-		currentDir += ("/" + directory);
+	int rootfd = open(m_dirpath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	DirPtr dp(rootfd < 0 ? nullptr : ::fdopendir(rootfd), ::closedir);
 
-	std::unique_ptr<DIR, std::function<int(DIR *)>> dp(::opendir(currentDir.c_str()),
-													   ::closedir);
 	if (dp == nullptr) {
-		LogError("Error opening directory : " << currentDir);
+		LogError("Error opening directory : " << m_dirpath);
+		if (rootfd >= 0)
+			close(rootfd);
 		return ERROR_OPENING_DIR;
 	}
 
+	std::string path;
+
 	while (auto dirp = ValidationCore::readdir(dp.get())) {
 		if (!strcmp(dirp->d_name, ".") || !strcmp(dirp->d_name, ".."))
 			continue;
 
-		if (dirp->d_type == DT_UNKNOWN) {
-			// try to stat inode when readdir is not returning known type
-			std::string path = currentDir + "/" + dirp->d_name;
-			struct stat s;
-			if (lstat(path.c_str(), &s) != 0)
-				return ERROR_LSTAT;
-
-			if (S_ISREG(s.st_mode))
-				dirp->d_type = DT_REG;
-			else if (S_ISDIR(s.st_mode))
-				dirp->d_type = DT_DIR;
-		}
+		unsigned char type;
+		Result result = getType(rootfd, path, dirp, type);
+
+		if (result != NO_ERROR)
+			return result;
 
-		if (currentDir == m_dirpath && dirp->d_type == DT_REG)
+		if (type == DT_REG)
 			if ((!strcmp(dirp->d_name, AUTHOR_SIGNATURE) && isAuthorSignature) ||
 				isDistributorSignature(dirp->d_name))
 				continue;
 
-		if (dirp->d_type == DT_DIR) {
-			LogDebug("Open directory : " << (directory + dirp->d_name));
-			std::string tmp_directory = directory + dirp->d_name + "/";
-			Result result = dfsCheckDirectories(referenceSet,
-												tmp_directory,
-												isAuthorSignature);
-			if (result != NO_ERROR)
-				return result;
-		} else if (dirp->d_type == DT_REG) {
-			if (referenceSet.end() == referenceSet.find(directory + dirp->d_name)) {
-				LogError("Cannot find : " << (directory + dirp->d_name));
-				return ERROR_REFERENCE_NOT_FOUND;
-			}
-		} else if (dirp->d_type == DT_LNK) {
-			std::string linkPath(directory + dirp->d_name);
-			if (referenceSet.end() == referenceSet.find(linkPath)) {
-				LogError("Cannot find : " << (directory + dirp->d_name));
-				return ERROR_REFERENCE_NOT_FOUND;
-			}
+		result = checkEntry(rootfd, dirp->d_name, type, path, references);
 
-			Result result = checkOutbound(linkPath, m_dirpath);
-			if (result != NO_ERROR) {
-				LogError("Link file point wrong path. : " << linkPath);
-				return result;
-			}
-		} else {
-			LogError("Unknown file type.");
-			return ERROR_UNSUPPORTED_FILE_TYPE;
-		}
+		if (result != NO_ERROR)
+			return result;
 	}
 
-
-
 	return NO_ERROR;
 }
 
@@ -19,6 +19,11 @@
  * @version     1.0
  * @brief       Simple c++ interface for libxml2.
  */
+#include <map>
+#include <mutex>
+
+#include <libxml/xmlschemas.h>
+
 #include <dpl/assert.h>
 #include <dpl/log/log.h>
 
@@ -26,6 +31,45 @@
 
 namespace ValidationCore {
 
+namespace {
+
+std::mutex g_schemaMutex;
+std::map<std::string, xmlSchemaPtr> g_schemas;
+
+/*
+ * Schema is compiled once and shared by all readers in the process.
+ * Compiled schema is read-only while validating, and it is kept
+ * until the process exits.
+ */
+xmlSchemaPtr getSchema(const std::string &path)
+{
+	std::lock_guard<std::mutex> lock(g_schemaMutex);
+
+	auto found = g_schemas.find(path);
+
+	if (found != g_schemas.end())
+		return found->second;
+
+	xmlSchemaParserCtxtPtr parserCtxt = xmlSchemaNewParserCtxt(path.c_str());
+
+	if (parserCtxt == NULL)
+		return NULL;
+
+	xmlSchemaPtr schema = xmlSchemaParse(parserCtxt);
+	xmlSchemaFreeParserCtxt(parserCtxt);
+
+	if (schema == NULL) {
+		LogError("Failed to compile schema : " << path);
+		return NULL;
+	}
+
+	LogDebug("Schema is compiled : " << path);
+	g_schemas.emplace(path, schema);
+	return schema;
+}
+
+} // anonymous namespace
+
 
 SaxReader::SaxReader() :
 	m_reader(0)
@@ -54,13 +98,16 @@ void SaxReader::initialize(
 					  "opening file " << filename << " error");
 	}
 
-	if (validate == VALIDATION_XMLSCHEME &&
-			xmlTextReaderSchemaValidate(m_reader, schema.c_str())) {
+	if (validate == VALIDATION_XMLSCHEME) {
+		xmlSchemaPtr schemaPtr = getSchema(schema);
+
 		/*
 		 * unable to turn on schema validation
+		 * (NULL schema deactivates the validation.)
 		 */
-		VcoreThrowMsg(SaxReader::Exception::ParserInternalError,
-					  "Turn on Schema validation failed");
+		if (schemaPtr == NULL || xmlTextReaderSetSchema(m_reader, schemaPtr))
+			VcoreThrowMsg(SaxReader::Exception::ParserInternalError,
+						  "Turn on Schema validation failed");
 	}
 
 	// Path to DTD schema is taken from xml file.
@@ -25,7 +25,13 @@
 
 #include <dpl/log/log.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <system_error>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace ValidationCore {
 
@@ -49,15 +55,27 @@ public:
 	VCerr checkListAll(bool checkOcsp,
 					   const UriList &uriList,
 					   SignatureDataMap &sigDataMap);
+
+	void setParallelValidation(size_t maxWorkers);
+
+private:
+	using Checker = std::function<VCerr(Impl &)>;
+
+	VCerr checkEach(const Checker &checker, SignatureDataMap &sigDataMap);
+	VCerr checkEachParallel(const Checker &checker, SignatureDataMap &sigDataMap);
+
+	size_t m_maxWorkers;
 };
 
 SignatureValidator::Impl::Impl(const SignatureFileInfo &info) :
-	BaseValidator(info)
+	BaseValidator(info),
+	m_maxWorkers(1)
 {
 }
 
 SignatureValidator::Impl::Impl(const std::string &packagePath) :
-	BaseValidator(packagePath)
+	BaseValidator(packagePath),
+	m_maxWorkers(1)
 {
 	m_context.isProxyMode = true;
 
@@ -92,16 +110,45 @@ VCerr SignatureValidator::Impl::checkList(bool checkOcsp,
 VCerr SignatureValidator::Impl::checkAll(bool checkOcsp,
 										 bool checkReferences,
 										 SignatureDataMap &sigDataMap)
+{
+	const std::string &contentPath = m_packagePath;
+	return checkEach([&](Impl &validator) {
+		return validator.baseCheck(contentPath, checkOcsp, checkReferences);
+	}, sigDataMap);
+}
+
+VCerr SignatureValidator::Impl::checkListAll(bool checkOcsp,
+											 const UriList &uriList,
+											 SignatureDataMap &sigDataMap)
+{
+	return checkEach([&](Impl &validator) {
+		return validator.baseCheckList(checkOcsp, uriList);
+	}, sigDataMap);
+}
+
+void SignatureValidator::Impl::setParallelValidation(size_t maxWorkers)
+{
+	if (maxWorkers == 0)
+		maxWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_maxWorkers = maxWorkers;
+}
+
+VCerr SignatureValidator::Impl::checkEach(const Checker &checker,
+										  SignatureDataMap &sigDataMap)
 {
 	if (m_fileInfoSet.size() < 2)
 		return E_SIG_UNKNOWN; // TODO(sangwan.kwon) Add error code (INVALID SIZE)
 
+	if (m_maxWorkers > 1)
+		return checkEachParallel(checker, sigDataMap);
+
 	VCerr result = E_SIG_UNKNOWN;
 	for (const auto &sig : m_fileInfoSet) {
 		m_fileInfo = sig;
 		m_disregarded = false;
 
-		result = baseCheck(m_packagePath, checkOcsp, checkReferences);
+		result = checker(*this);
 		result = additionalCheck(result);
 		if (result != E_SIG_NONE) {
 			LogError("Failed to check on > " << m_fileInfo.getFileName());
@@ -116,26 +163,59 @@ VCerr SignatureValidator::Impl::checkAll(bool checkOcsp,
 	return result;
 }
 
-VCerr SignatureValidator::Impl::checkListAll(bool checkOcsp,
-											 const UriList &uriList,
-											 SignatureDataMap &sigDataMap)
+/*
+ *  Each signature file is checked by its own validator on the workers.
+ *  The validators don't share the proxy references, so every signature
+ *  verifies all of its references. Plugin check and merging the results
+ *  are done on the calling thread in the order of the signature number,
+ *  so the result is the same as the sequential one.
+ */
+VCerr SignatureValidator::Impl::checkEachParallel(const Checker &checker,
+												  SignatureDataMap &sigDataMap)
 {
-	if (m_fileInfoSet.size() < 2)
-		return E_SIG_UNKNOWN; // TODO(sangwan.kwon) Add error code (INVALID SIZE)
+	std::vector<SignatureFileInfo> sigs(m_fileInfoSet.begin(), m_fileInfoSet.end());
+	std::vector<std::unique_ptr<Impl>> validators;
+	std::vector<VCerr> results(sigs.size(), E_SIG_UNKNOWN);
+
+	for (const auto &sig : sigs)
+		validators.emplace_back(new Impl(sig));
+
+	std::atomic<size_t> next(0);
+	auto work = [&]() {
+		for (size_t i = next++; i < sigs.size(); i = next++)
+			results[i] = checker(*validators[i]);
+	};
+
+	size_t workers = std::min(m_maxWorkers, sigs.size());
+	std::vector<std::thread> threads;
+	LogDebug("Check " << sigs.size() << " signatures with " << workers << " workers.");
+
+	for (size_t i = 1; i < workers; i++) {
+		try {
+			threads.emplace_back(work);
+		} catch (const std::system_error &e) {
+			LogWarning("Failed to create worker : " << e.what());
+			break;
+		}
+	}
+
+	work();
+
+	for (auto &thread : threads)
+		thread.join();
 
 	VCerr result = E_SIG_UNKNOWN;
-	for (const auto &sig : m_fileInfoSet) {
-		m_fileInfo = sig;
-		m_disregarded = false;
+	for (size_t i = 0; i < sigs.size(); i++) {
+		m_fileInfo = sigs[i];
+		m_data = validators[i]->m_data;
 
-		result = baseCheckList(checkOcsp, uriList);
-		result = additionalCheck(result);
+		result = additionalCheck(results[i]);
 		if (result != E_SIG_NONE) {
 			LogError("Failed to check on > " << m_fileInfo.getFileName());
 			break;
 		}
 		sigDataMap.insert(std::make_pair(m_data.getSignatureNumber(), m_data));
-		LogDebug("CheckList done signature > " << m_data.getSignatureNumber());
+		LogDebug("Check done signature > " << m_data.getSignatureNumber());
 		for (const auto &certPtr : m_data.getCertList())
 			LogDebug(certPtr->getBase64());
 	}
@@ -200,6 +280,14 @@ VCerr SignatureValidator::checkListAll(bool checkOcsp,
 	return m_pImpl->checkListAll(checkOcsp, uriList, sigDataMap);
 }
 
+void SignatureValidator::setParallelValidation(size_t maxWorkers)
+{
+	if (!m_pImpl)
+		return;
+
+	m_pImpl->setParallelValidation(maxWorkers);
+}
+
 VCerr SignatureValidator::makeChainBySignature(
 	bool completeWithSystemCert,
 	CertificateList &certList)
@@ -86,6 +86,14 @@ public:
 					   const UriList &uriList,
 					   SignatureDataMap &sigDataMap);
 
+	/*
+	 *  Check signature files of checkAll() and checkListAll() concurrently
+	 *  with up to maxWorkers threads. 1 is sequential (default) and
+	 *  0 uses the number of CPUs. Results and errors are the same as
+	 *  the sequential check.
+	 */
+	void setParallelValidation(size_t maxWorkers);
+
 	/*
 	 *  @Remarks : cert list isn't completed with self-signed root CA system cert
 	 *             if completeWithSystemCert is false.
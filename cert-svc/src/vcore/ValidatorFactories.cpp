@@ -32,13 +32,12 @@
 
 namespace ValidationCore {
 
-const CertificateIdentifier &createCertificateIdentifier()
-{
-	static CertificateIdentifier certificateIdentifier;
-	static bool initialized = false;
+namespace {
 
-	if (initialized)
-		return certificateIdentifier;
+CertificateIdentifier *loadCertificateIdentifier()
+{
+	std::unique_ptr<CertificateIdentifier> certificateIdentifier(
+		new CertificateIdentifier);
 
 	std::string file(FINGERPRINT_LIST_PATH);
 	std::string schema(FINGERPRINT_LIST_SCHEMA_PATH);
@@ -47,18 +46,31 @@ const CertificateIdentifier &createCertificateIdentifier()
 	// Read the fingerprint original list.
 	CertificateConfigReader reader;
 	reader.initialize(file, schema);
-	reader.read(certificateIdentifier);
+	reader.read(*certificateIdentifier);
 
 	if (std::ifstream(FINGERPRINT_LIST_EXT_PATH)) {
 		LogInfo(FINGERPRINT_LIST_EXT_PATH << " exist, add it.");
 		CertificateConfigReader exReader;
 		exReader.initialize(FINGERPRINT_LIST_EXT_PATH, schema);
-		exReader.read(certificateIdentifier);
+		exReader.read(*certificateIdentifier);
 	}
 
-	initialized = true;
+	certificateIdentifier->build();
+	return certificateIdentifier.release();
+}
+
+} // anonymous namespace
+
+/*
+ * Fingerprint list is loaded once on the first call in a thread-safe way.
+ * If loading fails, the exception is thrown and the next call tries again.
+ */
+const CertificateIdentifier &createCertificateIdentifier()
+{
+	static const std::unique_ptr<const CertificateIdentifier>
+		certificateIdentifier(loadCertificateIdentifier());
 
-	return certificateIdentifier;
+	return *certificateIdentifier;
 }
 
 } // namespace ValidationCore
@@ -23,7 +23,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include <libxml/tree.h>
 #include <libxml/xmlmemory.h>
@@ -59,13 +61,22 @@ struct FileWrapper {
 	bool released;
 };
 
+std::once_flag g_xmlsecOnce;
+
+/*
+ * Keys managers trusting a certificate, keyed by its DER. They are kept per
+ * thread because xmlsec doesn't guarantee concurrent use of a keys manager.
+ */
+const size_t KEYS_MNGR_CACHE_SIZE = 8;
+thread_local std::map<std::string, std::shared_ptr<xmlSecKeysMngr>> t_keysMngrs;
+
 } // anonymous namespace
 
 namespace ValidationCore {
 
 static const std::string DIGEST_MD5 = "md5";
 
-std::string XmlSec::s_prefixPath;
+thread_local std::string XmlSec::s_prefixPath;
 
 int XmlSec::fileMatchCallback(const char *filename)
 {
@@ -173,7 +184,23 @@ XmlSec::XmlSec() :
 #ifndef XMLSEC_NO_XSLT
 	xmlIndentTreeOutput = 1;
 #endif
+	// libxml settings are per thread. Let threads created later have them too.
+	xmlThrDefLoadExtDtdDefaultValue(XML_DETECT_IDS | XML_COMPLETE_ATTRS);
+	xmlThrDefSubstituteEntitiesDefaultValue(1);
+#ifndef XMLSEC_NO_XSLT
+	xmlThrDefIndentTreeOutput(1);
+#endif
+
+	std::call_once(g_xmlsecOnce, initialize);
+}
 
+XmlSec::~XmlSec()
+{
+	s_prefixPath.clear();
+}
+
+void XmlSec::initialize(void)
+{
 	if (xmlSecInit() < 0)
 		ThrowMsg(Exception::InternalError, "Xmlsec initialization failed.");
 
@@ -208,31 +235,31 @@ XmlSec::XmlSec() :
 		ThrowMsg(Exception::InternalError,
 				 "Xmlsec-crypto initialization failed.");
 	}
-}
-
-XmlSec::~XmlSec()
-{
-	xmlSecCryptoShutdown();
-	xmlSecCryptoAppShutdown();
-	xmlSecShutdown();
-#ifndef XMLSEC_NO_XSLT
-	xsltCleanupGlobals();
-#endif
-	s_prefixPath.clear();
-}
 
-void XmlSec::validateFile(XmlSecContext &context, xmlSecKeysMngrPtr mngrPtr)
-{
-	fileExtractPrefix(context);
-	LogDebug("Prefix path : " << s_prefixPath);
+	/*
+	 * IO callbacks are global in xmlsec. They are registered once here and
+	 * resolve the file with the prefix path of the calling thread.
+	 */
 	xmlSecIOCleanupCallbacks();
 	if (xmlSecIORegisterCallbacks(
 		fileMatchCallback,
 		fileOpenCallback,
 		fileReadCallback,
-		fileCloseCallback) < 0)
+		fileCloseCallback) < 0) {
+		xmlSecCryptoShutdown();
+		xmlSecCryptoAppShutdown();
+		xmlSecShutdown();
 		ThrowMsg(Exception::InternalError,
 				 "Error in xmlSecIORegisterCallbacks");
+	}
+
+	xmlSecErrorsSetCallback(LogErrorPrint);
+}
+
+void XmlSec::validateFile(XmlSecContext &context, xmlSecKeysMngrPtr mngrPtr)
+{
+	fileExtractPrefix(context);
+	LogDebug("Prefix path : " << s_prefixPath);
 
 	std::unique_ptr<xmlDoc, std::function<void(xmlDocPtr)>> docPtr(
 		xmlParseFile(context.signatureFile.c_str()), xmlFreeDoc);
@@ -390,30 +417,69 @@ void XmlSec::loadPEMCertificateFile(XmlSecContext &context, xmlSecKeysMngrPtr mn
 		ThrowMsg(Exception::InternalError, "Failed to load PEM cert from file.");
 }
 
-void XmlSec::validateInternal(XmlSecContext &context)
+XmlSec::KeysMngrPtr XmlSec::createKeysManager(XmlSecContext &context)
 {
-	LogDebug("Start to validate.");
-	Assert(!context.signatureFile.empty());
-	Assert(!!context.certificatePtr || !context.certificatePath.empty());
-	xmlSecErrorsSetCallback(LogErrorPrint);
-
-	std::unique_ptr<xmlSecKeysMngr, std::function<void(xmlSecKeysMngrPtr)>>
-		mngrPtr(xmlSecKeysMngrCreate(), xmlSecKeysMngrDestroy);
+	xmlSecKeysMngrPtr mngr = xmlSecKeysMngrCreate();
 
-	if (!mngrPtr)
+	if (mngr == nullptr)
 		ThrowMsg(Exception::InternalError, "Failed to create keys manager.");
 
+	KeysMngrPtr mngrPtr(mngr, xmlSecKeysMngrDestroy);
+
 	if (xmlSecCryptoAppDefaultKeysMngrInit(mngrPtr.get()) < 0)
 		ThrowMsg(Exception::InternalError, "Failed to initialize keys manager.");
 
-	context.referenceSet.clear();
-
 	if (!!context.certificatePtr)
 		loadDERCertificateMemory(context, mngrPtr.get());
 
 	if (!context.certificatePath.empty())
 		loadPEMCertificateFile(context, mngrPtr.get());
 
+	return mngrPtr;
+}
+
+/*
+ * Keys manager which trusts only the certificate in memory is reused
+ * for the same certificate. The one with a certificate file isn't cached
+ * because the file could be changed.
+ */
+XmlSec::KeysMngrPtr XmlSec::getKeysManager(XmlSecContext &context)
+{
+	if (!context.certificatePtr || !context.certificatePath.empty())
+		return createKeysManager(context);
+
+	std::string derCert;
+
+	try {
+		derCert = context.certificatePtr->getDER();
+	} catch (Certificate::Exception::Base &e) {
+		ThrowMsg(Exception::InternalError,
+				 "Failed during x509 conversion to der format: " << e.DumpToString());
+	}
+
+	auto found = t_keysMngrs.find(derCert);
+
+	if (found != t_keysMngrs.end())
+		return found->second;
+
+	if (t_keysMngrs.size() >= KEYS_MNGR_CACHE_SIZE)
+		t_keysMngrs.clear();
+
+	KeysMngrPtr mngrPtr = createKeysManager(context);
+	t_keysMngrs.emplace(derCert, mngrPtr);
+	return mngrPtr;
+}
+
+void XmlSec::validateInternal(XmlSecContext &context)
+{
+	LogDebug("Start to validate.");
+	Assert(!context.signatureFile.empty());
+	Assert(!!context.certificatePtr || !context.certificatePath.empty());
+
+	context.referenceSet.clear();
+
+	KeysMngrPtr mngrPtr = getKeysManager(context);
+
 	validateFile(context, mngrPtr.get());
 }
 
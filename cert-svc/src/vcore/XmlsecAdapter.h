@@ -24,6 +24,7 @@
 
 #include <string>
 #include <list>
+#include <memory>
 
 #include <xmlsec/keysmngr.h>
 
@@ -133,7 +134,18 @@ private:
 	void validateInternal(XmlSecContext &context);
 	void validateFile(XmlSecContext &context, xmlSecKeysMngrPtr mngr);
 
-	static std::string s_prefixPath;
+	using KeysMngrPtr = std::shared_ptr<xmlSecKeysMngr>;
+
+	KeysMngrPtr createKeysManager(XmlSecContext &context);
+	KeysMngrPtr getKeysManager(XmlSecContext &context);
+
+	/*
+	 * xmlsec is initialized once by the first instance and kept for the
+	 * process, so instances could be used on several threads at once.
+	 */
+	static void initialize(void);
+
+	static thread_local std::string s_prefixPath;
 	static int fileMatchCallback(const char *filename);
 	static void *fileOpenCallback(const char *filename);
 	static int fileReadCallback(void *context, char *buffer, int len);
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <vector>
+
+#include <dpl/test/test_runner.h>
+#include <vcore/Certificate.h>
+#include <vcore/CertificateIdentifier.h>
+
+#include "test-common.h"
+
+using namespace ValidationCore;
+
+namespace {
+
+Certificate::Fingerprint toFingerprint(unsigned int seed)
+{
+	Certificate::Fingerprint fingerprint(SHA_DIGEST_LENGTH, 0x5a);
+
+	for (size_t i = 0; i < sizeof(seed); i++)
+		fingerprint[i] = static_cast<unsigned char>(seed >> ((sizeof(seed) - 1 - i) * 8));
+
+	return fingerprint;
+}
+
+} // namespace anonymous
+
+RUNNER_TEST_GROUP_INIT(T0070_CERTIFICATE_IDENTIFIER)
+
+/*
+ * test: CertificateIdentifier::find
+ * description: Fingerprints are added in any order and sorted once by build.
+ * expected: Each added certificate is found with the domains it is added with.
+ */
+RUNNER_TEST(T0071_find_hit)
+{
+	CertificatePtr ee(new Certificate(TestData::certEE, Certificate::FORM_BASE64));
+	CertificatePtr im(new Certificate(TestData::certIM, Certificate::FORM_BASE64));
+	CertificatePtr root(new Certificate(TestData::certRoot, Certificate::FORM_BASE64));
+
+	CertificateIdentifier identifier;
+	identifier.add(root->getFingerprint(Certificate::FINGERPRINT_SHA1), CertStoreId::VIS_PLATFORM);
+	identifier.add(ee->getFingerprint(Certificate::FINGERPRINT_SHA1), CertStoreId::VIS_PUBLIC);
+	identifier.add(im->getFingerprint(Certificate::FINGERPRINT_SHA1), CertStoreId::VIS_PARTNER);
+	// the same fingerprint in another list adds its domain.
+	identifier.add(ee->getFingerprint(Certificate::FINGERPRINT_SHA1), CertStoreId::TIZEN_TEST);
+	identifier.build();
+
+	CertStoreId::Set domains = identifier.find(ee);
+	RUNNER_ASSERT_MSG(domains.contains(CertStoreId::VIS_PUBLIC) &&
+					  domains.contains(CertStoreId::TIZEN_TEST),
+					  "Domains of a duplicated fingerprint should be merged");
+	RUNNER_ASSERT(!domains.contains(CertStoreId::VIS_PARTNER));
+
+	RUNNER_ASSERT(identifier.find(im).contains(CertStoreId::VIS_PARTNER));
+	RUNNER_ASSERT(identifier.find(root).contains(CertStoreId::VIS_PLATFORM));
+	RUNNER_ASSERT(identifier.find(root->getFingerprint(Certificate::FINGERPRINT_SHA1))
+				  .contains(CertStoreId::VIS_PLATFORM));
+}
+
+/*
+ * test: CertificateIdentifier::find
+ * description: Look up what is not in the identifier.
+ * expected: An empty set is returned.
+ */
+RUNNER_TEST(T0072_find_miss)
+{
+	CertificatePtr ee(new Certificate(TestData::certEE, Certificate::FORM_BASE64));
+	CertificatePtr im(new Certificate(TestData::certIM, Certificate::FORM_BASE64));
+
+	CertificateIdentifier empty;
+	empty.build();
+	RUNNER_ASSERT_MSG(empty.find(ee).isEmpty(), "Empty identifier shouldn't find any");
+
+	CertificateIdentifier identifier;
+	identifier.add(im->getFingerprint(Certificate::FINGERPRINT_SHA1), CertStoreId::VIS_PUBLIC);
+	// Only SHA1 fingerprints are kept.
+	identifier.add(ee->getFingerprint(Certificate::FINGERPRINT_MD5), CertStoreId::VIS_PUBLIC);
+	identifier.build();
+
+	RUNNER_ASSERT_MSG(identifier.find(ee).isEmpty(), "Not added certificate shouldn't be found");
+	RUNNER_ASSERT(identifier.find(ee->getFingerprint(Certificate::FINGERPRINT_MD5)).isEmpty());
+	RUNNER_ASSERT(identifier.find(Certificate::Fingerprint()).isEmpty());
+}
+
+/*
+ * test: CertificateIdentifier::find
+ * description: Many fingerprints are added in the reverse order.
+ * expected: Every added one is found, the ones between them are not.
+ */
+RUNNER_TEST(T0073_find_sorted_once)
+{
+	const unsigned int count = 1000;
+	CertificateIdentifier identifier;
+
+	for (unsigned int i = count; i > 0; i--)
+		identifier.add(toFingerprint(i * 2), CertStoreId::VIS_PUBLIC);
+
+	identifier.build();
+
+	for (unsigned int i = 1; i <= count; i++) {
+		RUNNER_ASSERT_MSG(identifier.find(toFingerprint(i * 2)).contains(CertStoreId::VIS_PUBLIC),
+						  "Added fingerprint should be found : " << i * 2);
+		RUNNER_ASSERT_MSG(identifier.find(toFingerprint(i * 2 + 1)).isEmpty(),
+						  "Not added fingerprint shouldn't be found : " << i * 2 + 1);
+	}
+
+	RUNNER_ASSERT(identifier.find(toFingerprint(0)).isEmpty());
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <dpl/test/test_runner.h>
+#include <vcore/Certificate.h>
+#include <vcore/CertificateIndex.h>
+
+#include "test-common.h"
+
+using namespace ValidationCore;
+
+namespace {
+
+class CaDirectory {
+public:
+	CaDirectory()
+	{
+		char path[] = "/tmp/cert-svc-ca-XXXXXX";
+		RUNNER_ASSERT_MSG(mkdtemp(path) != NULL, "mkdtemp failed.");
+		m_path = path;
+	}
+
+	~CaDirectory()
+	{
+		std::unique_ptr<DIR, std::function<int(DIR *)>> dir(opendir(m_path.c_str()), closedir);
+
+		while (dir) {
+			struct dirent *entry = readdir(dir.get());
+
+			if (entry == NULL)
+				break;
+
+			if (entry->d_name[0] != '.')
+				unlink((m_path + "/" + entry->d_name).c_str());
+		}
+
+		rmdir(m_path.c_str());
+	}
+
+	const std::string &path() const
+	{
+		return m_path;
+	}
+
+	void write(const std::string &name, const CertificatePtr &cert) const
+	{
+		std::string base64 = cert->getBase64();
+		std::ofstream file(m_path + "/" + name, std::ios::trunc);
+		file << "-----BEGIN CERTIFICATE-----\n";
+
+		for (size_t i = 0; i < base64.size(); i += 64)
+			file << base64.substr(i, 64) << "\n";
+
+		file << "-----END CERTIFICATE-----\n";
+		RUNNER_ASSERT_MSG(file.flush(), "Failed to write " << name);
+	}
+
+	// Named as the hash named CA directory, e.g. TZ_SYS_CA_CERTS.
+	void writeHashNamed(const CertificatePtr &cert) const
+	{
+		write(cert->getNameHash(Certificate::FIELD_SUBJECT) + ".0", cert);
+	}
+
+private:
+	std::string m_path;
+};
+
+CertificatePtr load(const std::string &base64)
+{
+	return CertificatePtr(new Certificate(base64, Certificate::FORM_BASE64));
+}
+
+} // namespace anonymous
+
+RUNNER_TEST_GROUP_INIT(T0080_CERTIFICATE_INDEX)
+
+/*
+ * test: CertificateIndex::findIssuer
+ * description: Find an issuer in a directory of files named by subject hash.
+ * expected: The issuer in the directory is found, the others are not.
+ */
+RUNNER_TEST(T0081_find_issuer_hash_named)
+{
+	CaDirectory dir;
+	CertificatePtr ee = load(TestData::certEE);
+	CertificatePtr im = load(TestData::certIM);
+	CertificatePtr root = load(TestData::certRoot);
+
+	dir.writeHashNamed(root);
+	// a broken file of the same hash is skipped.
+	std::ofstream(dir.path() + "/" + root->getNameHash(Certificate::FIELD_SUBJECT) + ".1")
+		<< "broken";
+
+	auto &index = CertificateIndex::instance();
+	CertificatePtr found = index.findIssuer(dir.path(), true, im);
+	RUNNER_ASSERT_MSG(found && found->getDER() == root->getDER(), "Issuer should be found");
+
+	RUNNER_ASSERT_MSG(!index.findIssuer(dir.path(), true, ee),
+					  "Issuer not in the directory shouldn't be found");
+}
+
+/*
+ * test: CertificateIndex::findIssuer
+ * description: Find an issuer in a directory of which all files are parsed.
+ * expected: The issuer in the directory is found, the others are not.
+ */
+RUNNER_TEST(T0082_find_issuer_parsed)
+{
+	CaDirectory dir;
+	CertificatePtr ee = load(TestData::certEE);
+	CertificatePtr im = load(TestData::certIM);
+	CertificatePtr ocspEE = load(TestData::ocspEE);
+
+	dir.write("intermediate.pem", im);
+
+	auto &index = CertificateIndex::instance();
+	CertificatePtr found = index.findIssuer(dir.path(), false, ee);
+	RUNNER_ASSERT_MSG(found && found->getDER() == im->getDER(), "Issuer should be found");
+
+	RUNNER_ASSERT_MSG(!index.findIssuer(dir.path(), false, ocspEE),
+					  "Issuer not in the directory shouldn't be found");
+	RUNNER_ASSERT_MSG(!index.findIssuer(dir.path(), false, im),
+					  "Certificate shouldn't be the issuer of itself");
+}
+
+/*
+ * test: CertificateIndex::findIssuer
+ * description: Add the issuer after a lookup missed it.
+ * expected: The index of the directory is dropped and the issuer is found.
+ */
+RUNNER_TEST(T0083_find_issuer_added)
+{
+	CaDirectory dir;
+	CertificatePtr im = load(TestData::certIM);
+	CertificatePtr root = load(TestData::certRoot);
+
+	auto &index = CertificateIndex::instance();
+	RUNNER_ASSERT(!index.findIssuer(dir.path(), true, im));
+
+	dir.writeHashNamed(root);
+
+	CertificatePtr found = index.findIssuer(dir.path(), true, im);
+	RUNNER_ASSERT_MSG(found && found->getDER() == root->getDER(),
+					  "Added issuer should be found");
+}
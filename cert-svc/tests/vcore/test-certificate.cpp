@@ -15,6 +15,8 @@
  */
 
 #include <string>
+#include <thread>
+#include <vector>
 #include <dpl/test/test_runner.h>
 #include <vcore/Certificate.h>
 
@@ -116,3 +118,44 @@ RUNNER_TEST(T0035_Certificate_AltNameURI)
 	str = std::string("fakeURI");
 	RUNNER_ASSERT(nameSet.find(str) == nameSet.end());
 }
+
+/*
+ * test: Certificate getters on concurrent readers
+ * description: Decoded fields are cached in the certificate object.
+ * expected: Every thread should get the same values as the first reader.
+ */
+RUNNER_TEST(T0036_Certificate_concurrent_getters)
+{
+	CertificatePtr cert(new Certificate(TestData::certEE, Certificate::FORM_BASE64));
+	CertificatePtr other(new Certificate(TestData::certEE, Certificate::FORM_BASE64));
+	std::string expected = cert->getOneLine() +
+						   cert->getCommonName(Certificate::FIELD_ISSUER) +
+						   cert->getNameHash(Certificate::FIELD_ISSUER) +
+						   cert->getOCSPURL();
+	Certificate::Fingerprint fingerprint =
+		cert->getFingerprint(Certificate::FINGERPRINT_SHA1);
+
+	std::vector<std::thread> threads;
+	std::vector<int> mismatched(4, 0);
+
+	for (size_t i = 0; i < mismatched.size(); i++) {
+		threads.emplace_back([&other, &expected, &fingerprint, &mismatched, i]() {
+			for (int count = 0; count < 100; count++) {
+				std::string result = other->getOneLine() +
+									 other->getCommonName(Certificate::FIELD_ISSUER) +
+									 other->getNameHash(Certificate::FIELD_ISSUER) +
+									 other->getOCSPURL();
+
+				if (result != expected ||
+						other->getFingerprint(Certificate::FINGERPRINT_SHA1) != fingerprint)
+					mismatched[i]++;
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	for (auto count : mismatched)
+		RUNNER_ASSERT_MSG(count == 0, "Cached field mismatched : " << count);
+}
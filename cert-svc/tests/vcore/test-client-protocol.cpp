@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+/*
+ * @file        test-client-protocol.cpp
+ * @version     1.0
+ * @brief       Internal unit test : receive and retry of the framed protocol
+ */
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstring>
+
+#include <dpl/test/test_runner.h>
+
+#include <vcore/ClientProtocol.h>
+
+namespace {
+
+struct SocketPair {
+	SocketPair()
+	{
+		RUNNER_ASSERT_MSG(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0,
+						  "socketpair failed. errno : " << errno);
+	}
+
+	~SocketPair()
+	{
+		closePeer();
+		close(fds[0]);
+	}
+
+	void closePeer()
+	{
+		if (fds[1] >= 0)
+			close(fds[1]);
+
+		fds[1] = -1;
+	}
+
+	void setTimeout(long usec)
+	{
+		struct timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = usec;
+		RUNNER_ASSERT(setsockopt(fds[0], SOL_SOCKET, SO_RCVTIMEO, &timeout,
+								 sizeof(timeout)) == 0);
+	}
+
+	int fds[2];
+};
+
+} /* anonymous namespace */
+
+RUNNER_TEST_GROUP_INIT(T0050_CLIENT_PROTOCOL)
+
+RUNNER_TEST(T0051_recv_done)
+{
+	SocketPair sockets;
+	char buffer[4];
+	size_t received = 0;
+
+	RUNNER_ASSERT(write(sockets.fds[1], "abcd", 4) == 4);
+	RUNNER_ASSERT(vcore_frame_recv(sockets.fds[0], buffer, sizeof(buffer), &received)
+				  == VCORE_RECV_DONE);
+	RUNNER_ASSERT(received == 4 && memcmp(buffer, "abcd", 4) == 0);
+}
+
+RUNNER_TEST(T0052_recv_closed_before_response)
+{
+	SocketPair sockets;
+	char buffer[4];
+	size_t received = 1;
+
+	sockets.closePeer();
+	RUNNER_ASSERT(vcore_frame_recv(sockets.fds[0], buffer, sizeof(buffer), &received)
+				  == VCORE_RECV_CLOSED);
+	RUNNER_ASSERT(received == 0);
+}
+
+RUNNER_TEST(T0053_recv_closed_in_response)
+{
+	SocketPair sockets;
+	char buffer[4];
+	size_t received = 0;
+
+	RUNNER_ASSERT(write(sockets.fds[1], "ab", 2) == 2);
+	sockets.closePeer();
+	RUNNER_ASSERT(vcore_frame_recv(sockets.fds[0], buffer, sizeof(buffer), &received)
+				  == VCORE_RECV_CLOSED);
+	RUNNER_ASSERT(received == 2);
+}
+
+RUNNER_TEST(T0054_recv_timeout_is_not_closed)
+{
+	SocketPair sockets;
+	char buffer[4];
+	size_t received = 1;
+
+	sockets.setTimeout(100 * 1000);
+	RUNNER_ASSERT(vcore_frame_recv(sockets.fds[0], buffer, sizeof(buffer), &received)
+				  == VCORE_RECV_FAILED);
+	RUNNER_ASSERT(received == 0);
+}
+
+RUNNER_TEST(T0055_retry_not_sent_request)
+{
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_SEND, 1) == VCORE_RETRY_FRAMED);
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_SEND, 0) == VCORE_RETRY_FRAMED);
+}
+
+RUNNER_TEST(T0056_retry_closed_connection)
+{
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_CLOSED, 1) == VCORE_RETRY_FRAMED);
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_CLOSED, 0) == VCORE_RETRY_NONE);
+}
+
+RUNNER_TEST(T0057_no_retry_after_timeout)
+{
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_RESPONSE, 1) == VCORE_RETRY_NONE);
+	RUNNER_ASSERT(vcore_frame_retry(VCORE_FAILED_RESPONSE, 0) == VCORE_RETRY_NONE);
+}
@@ -43,6 +43,14 @@ extern const std::string googleCA;
 extern const std::string google2nd;
 extern const std::string google3rd;
 
+/* test pki for canned ocsp responses, expires 25 Sep 2126 */
+extern const std::string ocspRoot;    /* signed by self */
+extern const std::string ocspIM;      /* signed by ocspRoot, ocsp url : http://ocsp-root.test */
+extern const std::string ocspEE;      /* signed by ocspIM,   ocsp url : http://ocsp-im.test */
+extern const std::string ocspRootKey; /* PEM */
+extern const std::string ocspIMKey;   /* PEM */
+extern const std::string ocspEEKey;   /* PEM */
+
 extern const std::string certVerisign;
 extern const std::string certGenUriIncluded;
 }
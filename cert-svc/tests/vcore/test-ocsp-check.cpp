@@ -21,12 +21,224 @@
 
 #include <vcore/SignatureData.h>
 
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <openssl/bio.h>
+#include <openssl/ocsp.h>
+#include <openssl/pem.h>
+
 #include <dpl/test/test_runner.h>
 
 #include "test-common.h"
 
 using namespace ValidationCore;
 
+namespace {
+
+using EVP_PKEY_PTR = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+
+EVP_PKEY_PTR loadKey(const std::string &pem)
+{
+	std::unique_ptr<BIO, decltype(&BIO_free)> bio(
+		BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size())), BIO_free);
+	EVP_PKEY_PTR key(PEM_read_bio_PrivateKey(bio.get(), NULL, NULL, NULL), EVP_PKEY_free);
+	RUNNER_ASSERT_MSG(key, "Failed to load test key");
+	return key;
+}
+
+/*
+ *  Canned responder of the test pki. The response is signed by the issuer
+ *  of the certificate, which is the one behind the url of the request.
+ */
+class Responder {
+public:
+	Responder()
+		: root(new Certificate(TestData::ocspRoot, Certificate::FORM_BASE64))
+		, im(new Certificate(TestData::ocspIM, Certificate::FORM_BASE64))
+		, ee(new Certificate(TestData::ocspEE, Certificate::FORM_BASE64))
+		, rootKey(loadKey(TestData::ocspRootKey))
+		, imKey(loadKey(TestData::ocspIMKey))
+		, eeKey(loadKey(TestData::ocspEEKey))
+		, requested(0)
+		, nextUpdate(time(NULL) + 60 * 60)
+		, nonce(Nonce::OMIT)
+	{}
+
+	SignatureData chain() const
+	{
+		SignatureData data;
+		data.setSortedCertificateList({ee, im, root});
+		return data;
+	}
+
+	Ocsp::Transport transport()
+	{
+		return [this](const std::string &url, const std::string &request) -> std::string {
+			requested++;
+
+			const unsigned char *der = reinterpret_cast<const unsigned char *>(request.data());
+			std::unique_ptr<OCSP_REQUEST, decltype(&OCSP_REQUEST_free)> req(
+				d2i_OCSP_REQUEST(NULL, &der, request.size()), OCSP_REQUEST_free);
+			RUNNER_ASSERT_MSG(req && OCSP_request_onereq_count(req.get()) == 1,
+							  "Invalid ocsp request");
+
+			OCSP_CERTID *id = OCSP_onereq_get0_id(OCSP_request_onereq_get0(req.get(), 0));
+
+			if (url == im->getOCSPURL())
+				return sign(id, root, rootKey.get(), V_OCSP_CERTSTATUS_GOOD, req.get());
+
+			RUNNER_ASSERT_MSG(url == ee->getOCSPURL(), "Unknown url : " << url);
+			return sign(id, im, imKey.get(), V_OCSP_CERTSTATUS_GOOD, req.get());
+		};
+	}
+
+	// The leaf isn't allowed to sign the status of its issuer.
+	std::string forge(OCSP_CERTID *id)
+	{
+		return sign(id, ee, eeKey.get(), V_OCSP_CERTSTATUS_REVOKED);
+	}
+
+	std::string sign(OCSP_CERTID *id, const CertificatePtr &signer, EVP_PKEY *key,
+					 int status, OCSP_REQUEST *req = NULL)
+	{
+		std::unique_ptr<OCSP_BASICRESP, decltype(&OCSP_BASICRESP_free)> basic(
+			OCSP_BASICRESP_new(), OCSP_BASICRESP_free);
+		std::unique_ptr<ASN1_TIME, decltype(&ASN1_TIME_free)> thisUpd(
+			X509_gmtime_adj(NULL, -60), ASN1_TIME_free);
+		std::unique_ptr<ASN1_TIME, decltype(&ASN1_TIME_free)> nextUpd(
+			ASN1_TIME_set(NULL, nextUpdate), ASN1_TIME_free);
+
+		RUNNER_ASSERT(basic && thisUpd && nextUpd);
+		RUNNER_ASSERT(OCSP_basic_add1_status(basic.get(), id, status,
+											 OCSP_REVOKED_STATUS_KEYCOMPROMISE,
+											 status == V_OCSP_CERTSTATUS_REVOKED ?
+											 thisUpd.get() : NULL,
+											 thisUpd.get(), nextUpd.get()) != NULL);
+
+		if (req != NULL && nonce == Nonce::ECHO)
+			RUNNER_ASSERT(OCSP_copy_nonce(basic.get(), req) == 1);
+		else if (req != NULL && nonce == Nonce::WRONG)
+			RUNNER_ASSERT(OCSP_basic_add1_nonce(basic.get(), NULL, -1) == 1);
+
+		RUNNER_ASSERT(OCSP_basic_sign(basic.get(), signer->getX509(), key, EVP_sha256(),
+									  NULL, 0) == 1);
+
+		std::unique_ptr<OCSP_RESPONSE, decltype(&OCSP_RESPONSE_free)> resp(
+			OCSP_response_create(OCSP_RESPONSE_STATUS_SUCCESSFUL, basic.get()),
+			OCSP_RESPONSE_free);
+		RUNNER_ASSERT(resp);
+
+		unsigned char *der = NULL;
+		int len = i2d_OCSP_RESPONSE(resp.get(), &der);
+		RUNNER_ASSERT(len > 0);
+
+		std::string response(reinterpret_cast<char *>(der), len);
+		OPENSSL_free(der);
+		return response;
+	}
+
+	CertificatePtr root;
+	CertificatePtr im;
+	CertificatePtr ee;
+	EVP_PKEY_PTR rootKey;
+	EVP_PKEY_PTR imKey;
+	EVP_PKEY_PTR eeKey;
+
+	enum class Nonce {
+		OMIT,
+		ECHO,
+		WRONG
+	};
+
+	int requested;
+	time_t nextUpdate;
+	Nonce nonce;
+};
+
+// Restore the default transport and drop all cached responses.
+struct CacheGuard {
+	explicit CacheGuard(Responder &responder)
+	{
+		Ocsp::setTransport(responder.transport());
+		Ocsp::setCacheDirectory("");
+		Ocsp::clearCache();
+	}
+
+	~CacheGuard()
+	{
+		Ocsp::setTransport(nullptr);
+		Ocsp::setCacheDirectory("");
+		Ocsp::clearCache();
+	}
+};
+
+class CacheDirectory {
+public:
+	CacheDirectory()
+	{
+		char path[] = "/tmp/cert-svc-ocsp-XXXXXX";
+		RUNNER_ASSERT_MSG(mkdtemp(path) != NULL, "mkdtemp failed.");
+		m_path = path;
+	}
+
+	~CacheDirectory()
+	{
+		for (const auto &name : files())
+			unlink((m_path + "/" + name).c_str());
+
+		rmdir(m_path.c_str());
+	}
+
+	const std::string &path() const
+	{
+		return m_path;
+	}
+
+	std::vector<std::string> files() const
+	{
+		std::vector<std::string> names;
+		std::unique_ptr<DIR, std::function<int(DIR *)>> dir(opendir(m_path.c_str()), closedir);
+
+		if (!dir)
+			return names;
+
+		while (struct dirent *entry = readdir(dir.get()))
+			if (entry->d_name[0] != '.')
+				names.push_back(entry->d_name);
+
+		return names;
+	}
+
+private:
+	std::string m_path;
+};
+
+// Stored file is named by hex of DER encoded OCSP_CERTID and the trust set.
+std::unique_ptr<OCSP_CERTID, decltype(&OCSP_CERTID_free)> toCertId(const std::string &name)
+{
+	std::string hex = name.substr(0, name.find('.'));
+	std::string der;
+
+	for (size_t i = 0; i + 1 < hex.size(); i += 2)
+		der.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(der.data());
+	std::unique_ptr<OCSP_CERTID, decltype(&OCSP_CERTID_free)> id(
+		d2i_OCSP_CERTID(NULL, &p, der.size()), OCSP_CERTID_free);
+	RUNNER_ASSERT_MSG(id, "Invalid stored file name : " << name);
+	return id;
+}
+
+} // namespace anonymous
+
 RUNNER_TEST_GROUP_INIT(T0030_OCSP_CHECK)
 
 /*
@@ -52,3 +264,161 @@ RUNNER_TEST(T0031_check_positive)
 		RUNNER_ASSERT_MSG(0, "Exception occured in T0031 : " << e.DumpToString());
 	}
 }
+
+RUNNER_TEST(T0032_check_transport_replaced)
+{
+	int requested = 0;
+	Ocsp::setTransport([&requested](const std::string &, const std::string &request) -> std::string {
+		requested++;
+		RUNNER_ASSERT_MSG(!request.empty(), "ocsp request shouldn't be empty");
+		VcoreThrowMsg(Ocsp::Exception::NetworkError, "network is disabled in test");
+	});
+	Ocsp::clearCache();
+
+	SignatureData data;
+	CertificateList certList;
+	certList.push_back(CertificatePtr(new Certificate(TestData::certEE, Certificate::FORM_BASE64)));
+	certList.push_back(CertificatePtr(new Certificate(TestData::certIM, Certificate::FORM_BASE64)));
+	certList.push_back(CertificatePtr(new Certificate(TestData::certRoot, Certificate::FORM_BASE64)));
+	data.setSortedCertificateList(certList);
+
+	bool thrown = false;
+
+	try {
+		Ocsp::check(data);
+	} catch (Ocsp::Exception::NetworkError &e) {
+		thrown = true;
+	}
+
+	Ocsp::setTransport(nullptr);
+	RUNNER_ASSERT_MSG(thrown, "Error of the transport should be thrown");
+	RUNNER_ASSERT_MSG(requested == 1, "Transport should be used once. used : " << requested);
+}
+
+RUNNER_TEST(T0033_check_cached)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	SignatureData data = responder.chain();
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT_MSG(responder.requested == 2,
+					  "Transport should be used per cert. used : " << responder.requested);
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT_MSG(responder.requested == 2,
+					  "Cached response should be used. used : " << responder.requested);
+}
+
+RUNNER_TEST(T0034_check_cache_expired)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	SignatureData data = responder.chain();
+
+	responder.nextUpdate = time(NULL) + 2;
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT_MSG(responder.requested == 2,
+					  "Cached response should be used. used : " << responder.requested);
+
+	sleep(3);
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT_MSG(responder.requested == 4,
+					  "Response should be expired at nextUpdate. used : " << responder.requested);
+}
+
+RUNNER_TEST(T0035_check_cache_directory)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	CacheDirectory directory;
+	SignatureData data = responder.chain();
+
+	Ocsp::setCacheDirectory(directory.path());
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT(responder.requested == 2);
+	RUNNER_ASSERT_MSG(directory.files().size() == 2,
+					  "Response should be stored per cert. stored : " << directory.files().size());
+
+	// as the next process which has nothing in memory.
+	Ocsp::clearCache();
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT_MSG(responder.requested == 2,
+					  "Stored response should be used. used : " << responder.requested);
+}
+
+RUNNER_TEST(T0036_check_cache_directory_tampered)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	CacheDirectory directory;
+	SignatureData data = responder.chain();
+
+	Ocsp::setCacheDirectory(directory.path());
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT(directory.files().size() == 2);
+
+	for (const auto &name : directory.files()) {
+		std::ofstream file(directory.path() + "/" + name, std::ios::binary | std::ios::trunc);
+		file << responder.forge(toCertId(name).get());
+	}
+
+	Ocsp::clearCache();
+
+	RUNNER_ASSERT_MSG(Ocsp::check(data) == Ocsp::Result::GOOD,
+					  "Tampered response shouldn't be trusted");
+	RUNNER_ASSERT_MSG(responder.requested == 4,
+					  "Tampered response should be fetched again. used : " << responder.requested);
+}
+
+RUNNER_TEST(T0037_check_nonce)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	SignatureData data = responder.chain();
+
+	responder.nonce = Responder::Nonce::ECHO;
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+
+	Ocsp::clearCache();
+	responder.nonce = Responder::Nonce::WRONG;
+
+	bool thrown = false;
+
+	try {
+		Ocsp::check(data);
+	} catch (Ocsp::Exception::InvalidResponse &e) {
+		thrown = true;
+	}
+
+	RUNNER_ASSERT_MSG(thrown, "Response to another nonce shouldn't be trusted");
+}
+
+RUNNER_TEST(T0038_check_cache_trusted_certs)
+{
+	Responder responder;
+	CacheGuard guard(responder);
+	SignatureData data = responder.chain();
+
+	RUNNER_ASSERT(Ocsp::check(data) == Ocsp::Result::GOOD);
+	RUNNER_ASSERT(responder.requested == 2);
+
+	// Same certs to check, but verified with another set of trusted certs.
+	SignatureData other;
+	other.setSortedCertificateList({responder.ee, responder.im, responder.root, responder.root});
+
+	try {
+		Ocsp::check(other);
+	} catch (Ocsp::Exception::OcspUnsupported &e) {
+		// the root doesn't provide ocsp.
+	}
+
+	RUNNER_ASSERT_MSG(responder.requested == 4,
+					  "Cached response shouldn't be used for another trust set. used : "
+					  << responder.requested);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016-2020 Samsung Electronics Co., Ltd. All rights reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+/*
+ * @file        test-reference-validator.cpp
+ * @version     1.0
+ * @brief       Internal class unit test : ReferenceValidator
+ */
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <dpl/test/test_runner.h>
+
+#include <vcore/ReferenceValidator.h>
+
+using namespace ValidationCore;
+
+namespace {
+
+// Package directory which is removed with its entries at the end.
+class Package {
+public:
+	Package()
+	{
+		char path[] = "/tmp/cert-svc-reference-XXXXXX";
+		RUNNER_ASSERT_MSG(mkdtemp(path) != nullptr, "mkdtemp failed.");
+		m_root = path;
+	}
+
+	~Package()
+	{
+		for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it)
+			remove(it->c_str());
+
+		rmdir(m_root.c_str());
+	}
+
+	void addFile(const std::string &name)
+	{
+		std::string path = m_root + "/" + name;
+		int fd = creat(path.c_str(), 0644);
+		RUNNER_ASSERT_MSG(fd >= 0, "Failed to create : " << path);
+		close(fd);
+		m_entries.push_back(path);
+	}
+
+	void addDirectory(const std::string &name)
+	{
+		std::string path = m_root + "/" + name;
+		RUNNER_ASSERT_MSG(mkdir(path.c_str(), 0755) == 0, "Failed to create : " << path);
+		m_entries.push_back(path);
+	}
+
+	ReferenceValidator::Result check(const ReferenceSet &references,
+									 bool isAuthorSignature = true)
+	{
+		SignatureData data = isAuthorSignature
+							 ? SignatureData()
+							 : SignatureData("signature1.xml", 1);
+		data.setReference(references);
+
+		ReferenceValidator validator(m_root);
+		return validator.checkReferences(data);
+	}
+
+private:
+	std::string m_root;
+	std::vector<std::string> m_entries;
+};
+
+} // anonymous namespace
+
+RUNNER_TEST_GROUP_INIT(T0060_REFERENCE_VALIDATOR)
+
+RUNNER_TEST(T0061_all_referenced)
+{
+	Package package;
+	package.addFile("index.html");
+	package.addDirectory("res");
+	package.addFile("res/icon.png");
+
+	RUNNER_ASSERT(package.check({"index.html", "res/icon.png"})
+				  == ReferenceValidator::NO_ERROR);
+}
+
+RUNNER_TEST(T0062_not_referenced)
+{
+	Package package;
+	package.addFile("index.html");
+	package.addDirectory("res");
+	package.addFile("res/icon.png");
+
+	RUNNER_ASSERT(package.check({"index.html"})
+				  == ReferenceValidator::ERROR_REFERENCE_NOT_FOUND);
+}
+
+RUNNER_TEST(T0063_percent_decoded)
+{
+	Package package;
+	package.addFile("a b.html");
+	package.addDirectory("res");
+	package.addFile("res/%.png");
+
+	// Upper and lower case hex, and an escape at the end.
+	RUNNER_ASSERT(package.check({"a%20b.html", "res%2f%25.pn%67"})
+				  == ReferenceValidator::NO_ERROR);
+}
+
+RUNNER_TEST(T0064_percent_invalid)
+{
+	Package package;
+	package.addFile("index.html");
+
+	const char *invalid[] = {"index.html%", "index.html%2", "index%zz.html", "%g0index.html"};
+
+	for (auto reference : invalid)
+		RUNNER_ASSERT_MSG(package.check({"index.html", reference})
+						  == ReferenceValidator::ERROR_DECODING_URL,
+						  "Decoded invalid reference : " << reference);
+}
+
+RUNNER_TEST(T0065_signature_files_skipped)
+{
+	Package package;
+	package.addFile("index.html");
+	package.addFile("author-signature.xml");
+	package.addFile("signature1.xml");
+	package.addFile("signature20.xml");
+
+	RUNNER_ASSERT(package.check({"index.html"}) == ReferenceValidator::NO_ERROR);
+
+	// author signature is a reference of distributor signatures.
+	RUNNER_ASSERT(package.check({"index.html"}, false)
+				  == ReferenceValidator::ERROR_REFERENCE_NOT_FOUND);
+	RUNNER_ASSERT(package.check({"index.html", "author-signature.xml"}, false)
+				  == ReferenceValidator::NO_ERROR);
+}
+
+RUNNER_TEST(T0066_not_signature_files)
+{
+	const char *names[] = {
+		"signature.xml", "signature0.xml", "signature01.xml", "signature1a.xml",
+		"signature1.xml.bak", "signature1xml", "Signature1.xml", "xsignature1.xml"
+	};
+
+	for (auto name : names) {
+		Package package;
+		package.addFile(name);
+
+		RUNNER_ASSERT_MSG(package.check({}) == ReferenceValidator::ERROR_REFERENCE_NOT_FOUND,
+						  "Skipped as a signature : " << name);
+	}
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <dpl/test/test_runner.h>
+#include <vcore/SaxReader.h>
+
+using namespace ValidationCore;
+
+namespace {
+
+const std::string SCHEMA =
+	"<?xml version=\"1.0\"?>\n"
+	"<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">\n"
+	"  <xs:element name=\"list\">\n"
+	"    <xs:complexType><xs:sequence>\n"
+	"      <xs:element name=\"item\" type=\"xs:int\" maxOccurs=\"unbounded\"/>\n"
+	"    </xs:sequence></xs:complexType>\n"
+	"  </xs:element>\n"
+	"</xs:schema>\n";
+
+const std::string VALID = "<?xml version=\"1.0\"?><list><item>1</item><item>2</item></list>";
+const std::string INVALID = "<?xml version=\"1.0\"?><list><item>one</item></list>";
+
+class XmlFiles {
+public:
+	XmlFiles()
+	{
+		char path[] = "/tmp/cert-svc-xml-XXXXXX";
+		RUNNER_ASSERT_MSG(mkdtemp(path) != NULL, "mkdtemp failed.");
+		m_dir = path;
+	}
+
+	~XmlFiles()
+	{
+		for (const auto &file : m_files)
+			unlink(file.c_str());
+
+		rmdir(m_dir.c_str());
+	}
+
+	std::string path(const std::string &name) const
+	{
+		return m_dir + "/" + name;
+	}
+
+	std::string write(const std::string &name, const std::string &content)
+	{
+		std::string path = this->path(name);
+		std::ofstream file(path, std::ios::trunc);
+		file << content;
+		RUNNER_ASSERT_MSG(file.flush(), "Failed to write " << name);
+		m_files.push_back(path);
+		return path;
+	}
+
+private:
+	std::string m_dir;
+	std::vector<std::string> m_files;
+};
+
+void readAll(const std::string &xml, const std::string &schema)
+{
+	SaxReader reader;
+	reader.initialize(xml, false, SaxReader::VALIDATION_XMLSCHEME, schema);
+
+	while (reader.next());
+}
+
+bool isValid(const std::string &xml, const std::string &schema)
+{
+	try {
+		readAll(xml, schema);
+	} catch (SaxReader::Exception::FileNotValid &e) {
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace anonymous
+
+RUNNER_TEST_GROUP_INIT(T0090_SAX_READER)
+
+/*
+ * test: SaxReader::initialize with VALIDATION_XMLSCHEME
+ * description: Read documents with the schema compiled by the first reader.
+ * expected: Valid documents pass and invalid one fails on every read.
+ */
+RUNNER_TEST(T0091_schema_reused)
+{
+	XmlFiles files;
+	std::string schema = files.write("list.xsd", SCHEMA);
+	std::string valid = files.write("valid.xml", VALID);
+	std::string invalid = files.write("invalid.xml", INVALID);
+
+	for (int i = 0; i < 3; i++) {
+		RUNNER_ASSERT_MSG(isValid(valid, schema), "Valid document should pass : " << i);
+		RUNNER_ASSERT_MSG(!isValid(invalid, schema), "Invalid document should fail : " << i);
+	}
+}
+
+/*
+ * test: SaxReader::initialize with VALIDATION_XMLSCHEME
+ * description: Turn on validation with a schema which is not compiled.
+ * expected: Every initialize fails, not only the first one.
+ */
+RUNNER_TEST(T0092_schema_not_compiled)
+{
+	XmlFiles files;
+	std::string broken = files.write("broken.xsd", "<xs:schema");
+	std::string valid = files.write("valid.xml", VALID);
+	std::vector<std::string> schemas = {broken, files.path("missing.xsd")};
+
+	for (const auto &schema : schemas) {
+		for (int i = 0; i < 2; i++) {
+			bool thrown = false;
+
+			try {
+				readAll(valid, schema);
+			} catch (SaxReader::Exception::ParserInternalError &e) {
+				thrown = true;
+			}
+
+			RUNNER_ASSERT_MSG(thrown, "Validation shouldn't be turned off : " << schema);
+		}
+	}
+}
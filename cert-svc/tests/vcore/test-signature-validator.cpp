@@ -586,6 +586,63 @@ RUNNER_TEST(T00163_compare_time_between_checkList_and_checkListAll)
 		});
 }
 
+RUNNER_TEST(T00164_compare_time_between_checkAll_and_parallel)
+{
+	for(int i = 0; i < 3; i++) {
+		std::cout << "Start to validate : "
+				  << TestData::tpk_sdk_sample_path[i] << std::endl;
+
+		SignatureDataMap sequentialMap;
+		SignatureDataMap parallelMap;
+
+		Test::cmpFuncTime(
+			[&]() { // func1
+				SignatureValidator validator(TestData::tpk_sdk_sample_path[i]);
+				VCerr ret = validator.checkAll(true, true, sequentialMap);
+
+				RUNNER_ASSERT_MSG(ret == E_SIG_NONE,
+								  "sig validation should be success: "
+								  << ret);
+			},
+			[&]() { // func2
+				SignatureValidator validator(TestData::tpk_sdk_sample_path[i]);
+				validator.setParallelValidation(0);
+				VCerr ret = validator.checkAll(true, true, parallelMap);
+
+				RUNNER_ASSERT_MSG(ret == E_SIG_NONE,
+								  "sig validation should be success: "
+								  << ret);
+			});
+
+		RUNNER_ASSERT_MSG(sequentialMap.size() == parallelMap.size(),
+						  "signature data count should be same.");
+
+		for (const auto &data : sequentialMap)
+			RUNNER_ASSERT_MSG(parallelMap.count(data.first) == 1,
+							  "signature data should be same: " << data.first);
+	}
+}
+
+RUNNER_TEST(T00165_negative_parallel_checkAll_same_error)
+{
+	SignatureValidator sequential(TestData::widget_negative_signature_path);
+	SignatureValidator parallel(TestData::widget_negative_signature_path);
+	parallel.setParallelValidation(0);
+
+	SignatureDataMap sequentialMap;
+	SignatureDataMap parallelMap;
+	VCerr sequentialRet = sequential.checkAll(false, true, sequentialMap);
+	VCerr parallelRet = parallel.checkAll(false, true, parallelMap);
+
+	RUNNER_ASSERT_MSG(sequentialRet != E_SIG_NONE,
+					  "sig validation should be failed.");
+	RUNNER_ASSERT_MSG(sequentialRet == parallelRet,
+					  "sig validation error should be same: "
+					  << sequentialRet << " " << parallelRet);
+	RUNNER_ASSERT_MSG(sequentialMap.size() == parallelMap.size(),
+					  "signature data count should be same.");
+}
+
 RUNNER_TEST_GROUP_INIT(T0020_SigVal_errorstring)
 
 RUNNER_TEST(T0021)
@@ -34,6 +34,14 @@ SET(PLUGIN_INSTALL_DIR   "${VIST_PLUGIN_DIR}")
 SET(TABLE_INSTALL_DIR    "${VIST_TABLE_DIR}")
 SET(SCRIPT_INSTALL_DIR   "${VIST_SCRIPT_DIR}")
 
+## SQLite options of the policy database
+IF(NOT DEFINED DB_JOURNAL_MODE)
+	SET(DB_JOURNAL_MODE "DELETE")
+ENDIF(NOT DEFINED DB_JOURNAL_MODE)
+IF(NOT DEFINED DB_SYNCHRONOUS)
+	SET(DB_SYNCHRONOUS "FULL")
+ENDIF(NOT DEFINED DB_SYNCHRONOUS)
+
 EXECUTE_PROCESS(COMMAND mkdir -p "${VIST_DB_DIR}")
 EXECUTE_PROCESS(COMMAND mkdir -p "${VIST_PLUGIN_DIR}")
 EXECUTE_PROCESS(COMMAND mkdir -p "${VIST_SCRIPT_DIR}")
@@ -136,6 +136,7 @@ Provides internal testcases for ViST implementation.
 %manifest packaging/%{name}-test.manifest
 %{_bindir}/osquery-test
 %attr(4755 %{user_name}, %{group_name}) %{_bindir}/vist-test
+%{_bindir}/vist-bench
 %dir %attr(-, %{user_name}, %{group_name}) %{vist_table_dir}
 %attr(-, %{user_name}, %{group_name}) %{vist_table_dir}/libvist-table-sample.so
 %attr(-, %{user_name}, %{group_name}) %{vist_plugin_dir}/libtest-plugin.so
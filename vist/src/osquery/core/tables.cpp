@@ -16,8 +16,7 @@ namespace osquery {
 
 CREATE_LAZY_REGISTRY(TablePlugin, "table");
 
-size_t TablePlugin::kCacheInterval = 0;
-size_t TablePlugin::kCacheStep = 0;
+size_t TablePlugin::kCacheTTL = 10;
 
 Status TablePlugin::addExternal(const std::string& name,
 								const PluginResponse& response)
@@ -68,7 +67,7 @@ void TablePlugin::setRequestFromContext(const QueryContext& context,
 		document.push("colsUsed", colsUsed);
 	}
 
-	request["context"] = document.serialize();
+	request["context"] = document.dump();
 	DEBUG(OSQUERY) << "request context->" << request["context"];
 }
 
@@ -79,24 +78,20 @@ QueryContext TablePlugin::getContextFromRequest(const PluginRequest& request) co
 		return context;
 
 	using namespace vist::json;
-	std::string serialized = request.at("context");
-	Json document = Json::Parse(serialized);
-	DEBUG(OSQUERY) << "request context->" << document.serialize();
+	const std::string& serialized = request.at("context");
+	auto document = Document::Parse(serialized);
+	auto root = document.root();
+	DEBUG(OSQUERY) << "request context->" << serialized;
 
-	if (document.exist("colsUsed")) {
+	if (root.exist("colsUsed")) {
 		UsedColumns colsUsed;
-		Array array = document.get<Array>("colsUsed");
-		for (auto i = 0; i < array.size(); i++) {
-			std::string name = array.at(i);
-			colsUsed.insert(name);
-		}
+		for (auto name : root["colsUsed"])
+			colsUsed.insert(name.get<std::string>());
 		context.colsUsed = colsUsed;
 	}
 
-	Array constraints = document.get<Array>("constraints");
-	for (auto i = 0; i < constraints.size(); i++) {
-		auto constraint = Object::Create(constraints.at(i));
-		std::string name = constraint["name"];
+	for (auto constraint : root["constraints"]) {
+		auto name = constraint["name"].get<std::string>();
 		context.constraints[name].deserialize(constraint);
 	}
 
@@ -194,42 +189,169 @@ PluginResponse TablePlugin::routeInfo() const
 	return response;
 }
 
-static bool cacheAllowed(const TableColumns& cols, const QueryContext& ctx)
+const size_t TableCache::kMaxEntries = 16;
+
+TableCache& TableCache::instance()
 {
-	if (!ctx.useCache()) {
-		// The query execution did not request use of the warm cache.
-		return false;
+	static TableCache cache;
+	return cache;
+}
+
+std::string TableCache::fingerprint(const QueryContext& context)
+{
+	// The constraint map is ordered by column name, so equal queries build
+	// equal keys regardless of the order of the WHERE clause.
+	std::string key;
+	for (const auto& [column, list] : context.constraints) {
+		const auto& constraints = list.getAll();
+		if (constraints.empty())
+			continue;
+
+		key += column;
+		for (const auto& constraint : constraints) {
+			key += '\x1f';
+			key += std::to_string(constraint.op);
+			key += '\x1f';
+			key += constraint.expr;
+		}
+		key += '\x1e';
 	}
 
-	auto uncachable = ColumnOptions::INDEX | ColumnOptions::REQUIRED |
-					  ColumnOptions::ADDITIONAL | ColumnOptions::OPTIMIZED;
-	for (const auto& column : cols) {
-		auto opts = std::get<2>(column) & uncachable;
-		if (opts && ctx.constraints.at(std::get<0>(column)).exists()) {
-			return false;
+	if (context.colsUsedBitset)
+		key += context.colsUsedBitset->to_string();
+
+	return key;
+}
+
+bool TableCache::get(const std::string& table,
+					 const std::string& key,
+					 TableRows& rows)
+{
+	WriteLock lock(mutex_);
+	auto& cached = tables_[table];
+	auto now = Clock::now();
+	for (auto iter = cached.entries.begin(); iter != cached.entries.end(); ++iter) {
+		if (iter->key != key)
+			continue;
+
+		if (iter->expires <= now) {
+			cached.entries.erase(iter);
+			break;
 		}
+
+		rows.clear();
+		rows.reserve(iter->rows.size());
+		for (const auto& row : iter->rows)
+			rows.push_back(row->clone());
+
+		cached.stats.hits++;
+		return true;
 	}
-	return true;
+
+	cached.stats.misses++;
+	return false;
+}
+
+void TableCache::set(const std::string& table,
+					 const std::string& key,
+					 size_t ttl,
+					 const TableRows& rows)
+{
+	if (ttl == 0)
+		return;
+
+	Entry entry;
+	entry.key = key;
+	entry.expires = Clock::now() + std::chrono::seconds(ttl);
+	entry.rows.reserve(rows.size());
+	for (const auto& row : rows)
+		entry.rows.push_back(row->clone());
+
+	WriteLock lock(mutex_);
+	auto& entries = tables_[table].entries;
+	entries.remove_if([&key](const Entry& cached) { return cached.key == key; });
+	entries.push_front(std::move(entry));
+	if (entries.size() > kMaxEntries)
+		entries.pop_back();
+}
+
+void TableCache::invalidate(const std::string& table)
+{
+	WriteLock lock(mutex_);
+	auto iter = tables_.find(table);
+	if (iter == tables_.end() || iter->second.entries.empty())
+		return;
+
+	iter->second.entries.clear();
+	iter->second.stats.invalidations++;
 }
 
-bool TablePlugin::isCached(size_t step, const QueryContext& ctx) const
+void TableCache::invalidateAll()
 {
-	// Perform the step comparison first, because it's easy.
-	return (step < last_cached_ + last_interval_ && cacheAllowed(columns(), ctx));
+	WriteLock lock(mutex_);
+	for (auto& [name, cached] : tables_) {
+		if (cached.entries.empty())
+			continue;
+
+		cached.entries.clear();
+		cached.stats.invalidations++;
+	}
 }
 
-TableRows TablePlugin::getCache() const
+void TableCache::setTTL(const std::string& table, size_t ttl)
 {
-	TableRows results;
-	return results;
+	WriteLock lock(mutex_);
+	ttls_[table] = ttl;
+	if (ttl == 0 && tables_.count(table) > 0)
+		tables_[table].entries.clear();
 }
 
-void TablePlugin::setCache(size_t step,
-						   size_t interval,
-						   const QueryContext& ctx,
-						   const TableRows& results)
+size_t TableCache::getTTL(const std::string& table, size_t ttl) const
 {
-	return;
+	ReadLock lock(mutex_);
+	auto iter = ttls_.find(table);
+	return (iter != ttls_.end()) ? iter->second : ttl;
+}
+
+TableCache::Stats TableCache::getStats(const std::string& table) const
+{
+	ReadLock lock(mutex_);
+	auto iter = tables_.find(table);
+	return (iter != tables_.end()) ? iter->second.stats : Stats();
+}
+
+static size_t effectiveTTL(const TablePlugin& table, const QueryContext& ctx)
+{
+	if (!ctx.useCache()) {
+		// The query execution did not request use of the warm cache.
+		return 0;
+	}
+
+	return TableCache::instance().getTTL(table.getName(), table.cacheTTL());
+}
+
+bool TablePlugin::getCache(const QueryContext& ctx, TableRows& results) const
+{
+	if (effectiveTTL(*this, ctx) == 0)
+		return false;
+
+	auto key = TableCache::fingerprint(ctx);
+	return TableCache::instance().get(getName(), key, results);
+}
+
+void TablePlugin::setCache(const QueryContext& ctx, const TableRows& results)
+{
+	auto ttl = effectiveTTL(*this, ctx);
+	if (ttl == 0)
+		return;
+
+	auto key = TableCache::fingerprint(ctx);
+	TableCache::instance().set(getName(), key, ttl, results);
+}
+
+void TablePlugin::invalidateCache(const std::string& table)
+{
+	TableCache::instance().invalidate(table);
 }
 
 std::string columnDefinition(const TableColumns& columns, bool is_extension)
@@ -481,19 +603,15 @@ vist::json::Object ConstraintList::serialize() const
 	return object;
 }
 
-void ConstraintList::deserialize(vist::json::Object& obj)
+void ConstraintList::deserialize(const vist::json::Document::Node& node)
 {
-	using namespace vist::json;
-	Array list = obj.get<Array>("list");
-	for (auto i = 0; i < list.size(); i++) {
-		auto element = vist::json::Object::Create(list.at(i));
-		int op = element["op"];
-		Constraint constraint(static_cast<unsigned char>(op));
-		constraint.expr = static_cast<std::string>(element["expr"]);
+	for (auto element : node["list"]) {
+		Constraint constraint(static_cast<unsigned char>(element["op"].get<int>()));
+		constraint.expr = element["expr"].get<std::string>();
 		this->constraints_.emplace_back(std::move(constraint));
 	}
 
-	std::string name = obj.exist("affinity") ? static_cast<std::string>(obj["affinity"]) : "UNKNOWN";
+	auto name = node.exist("affinity") ? node["affinity"].get<std::string>() : "UNKNOWN";
 	this->affinity = columnTypeName(name);
 }
 
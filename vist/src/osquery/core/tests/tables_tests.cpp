@@ -158,46 +158,49 @@ TEST_F(TablesTests, test_constraint_map_cast)
 
 class TestTablePlugin : public TablePlugin {
 public:
-	void testSetCache(size_t step, size_t interval)
+	size_t cacheTTL() const override
+	{
+		return 60;
+	}
+
+	void testSetCache(const QueryContext& ctx)
 	{
 		TableRows r;
-		QueryContext ctx;
-		ctx.useCache(true);
-		setCache(step, interval, ctx, r);
+		setCache(ctx, r);
 	}
 
-	bool testIsCached(size_t interval)
+	bool testIsCached(const QueryContext& ctx)
 	{
-		QueryContext ctx;
-		ctx.useCache(true);
-		return isCached(interval, ctx);
+		TableRows r;
+		return getCache(ctx, r);
 	}
 };
 
 TEST_F(TablesTests, test_caching)
 {
 	TestTablePlugin test;
-	// By default the interval and step is 0, so a step of 5 will not be cached.
-	EXPECT_FALSE(test.testIsCached(5));
-
-	TablePlugin::kCacheInterval = 5;
-	TablePlugin::kCacheStep = 1;
-	EXPECT_FALSE(test.testIsCached(5));
-	// Set the current time to 1, and the interval at 5.
-	test.testSetCache(TablePlugin::kCacheStep, TablePlugin::kCacheInterval);
-	// Time at 1 is cached for an interval of 5, so at time 5 the cache is fresh.
-	EXPECT_TRUE(test.testIsCached(5));
-	// 6 is the end of the cache, it is not fresh.
-	EXPECT_FALSE(test.testIsCached(6));
-	// 7 is past the cache, it is not fresh.
-	EXPECT_FALSE(test.testIsCached(7));
-
-	// Set the time at now to 2.
-	TablePlugin::kCacheStep = 2;
-	test.testSetCache(TablePlugin::kCacheStep, TablePlugin::kCacheInterval);
-	EXPECT_TRUE(test.testIsCached(5));
-	// Now 6 is within the freshness of 2 + 5.
-	EXPECT_TRUE(test.testIsCached(6));
-	EXPECT_FALSE(test.testIsCached(7));
+	test.setName("test_caching");
+
+	QueryContext ctx;
+	// The query did not request the warm cache.
+	test.testSetCache(ctx);
+	EXPECT_FALSE(test.testIsCached(ctx));
+
+	ctx.useCache(true);
+	EXPECT_FALSE(test.testIsCached(ctx));
+	test.testSetCache(ctx);
+	EXPECT_TRUE(test.testIsCached(ctx));
+
+	// Each set of constraints is cached separately.
+	QueryContext constrained;
+	constrained.useCache(true);
+	constrained.constraints["path"].add(Constraint(EQUALS, "some"));
+	EXPECT_FALSE(test.testIsCached(constrained));
+
+	// Invalidation drops every result of the table.
+	test.testSetCache(constrained);
+	TablePlugin::invalidateCache("test_caching");
+	EXPECT_FALSE(test.testIsCached(ctx));
+	EXPECT_FALSE(test.testIsCached(constrained));
 }
 }
@@ -15,6 +15,10 @@
 #include <osquery/query.h>
 #include <osquery/tables.h>
 
+namespace vist {
+class ResultSet;
+} // namespace vist
+
 namespace osquery {
 
 /**
@@ -185,6 +189,21 @@ Status query(const std::string& query,
 			 QueryData& results,
 			 bool use_cache = false);
 
+/**
+ * @brief Execute a query and emit the results column by column.
+ *
+ * This bypasses the SQL plugin (and its string based PluginResponse), so
+ * each value keeps the type SQLite returned for it.
+ *
+ * @param query the query to execute
+ * @param results [output] A ResultSet to emit result columns on success.
+ * @param use_cache [optional] Set true to use the query cache.
+ * @return A status indicating query success.
+ */
+Status queryColumnar(const std::string& query,
+					 vist::ResultSet& results,
+					 bool use_cache = false);
+
 /**
  * @brief Analyze a query, providing information about the result columns.
  *
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <bitset>
+#include <chrono>
+#include <list>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -24,6 +26,7 @@
 #include <osquery/core/sql/column.h>
 #include <osquery/plugins/plugin.h>
 #include <osquery/query.h>
+#include <osquery/utils/mutex.h>
 
 #include <vist/json.hpp>
 
@@ -226,6 +229,9 @@ using AliasColumnMap = std::unordered_map<std::string, std::string>;
 /// Forward declaration of QueryContext for ConstraintList relationships.
 struct QueryContext;
 
+/// Forward declaration of TablePlugin for VirtualTableContent.
+class TablePlugin;
+
 /**
  * @brief A ConstraintList is a set of constraints for a column. This list
  * should be mapped to a left-hand-side column name.
@@ -351,6 +357,12 @@ public:
 		constraints_.push_back(constraint);
 	}
 
+	/// Remove all constraints, the affinity is kept.
+	void clear()
+	{
+		constraints_.clear();
+	}
+
 	/**
 	 * @brief Serialize a ConstraintList into a property tree.
 	 *
@@ -364,7 +376,8 @@ public:
 	 */
 	vist::json::Object serialize() const;
 
-	void deserialize(vist::json::Object& obj);
+	/// Restore from the parsed property tree, see serialize().
+	void deserialize(const vist::json::Document::Node& node);
 
 
 private:
@@ -412,6 +425,22 @@ struct VirtualTableContent {
 	/// Table column structure, retrieved once via the TablePlugin call API.
 	TableColumns columns;
 
+	/// Column options indexed by the column ordinal.
+	std::vector<ColumnOptions> options;
+
+	/// Column ordinals by column name.
+	std::unordered_map<std::string, size_t> ordinals;
+
+	/**
+	 * @brief The table plugin, resolved once when the table is created.
+	 *
+	 * Filtering calls the plugin directly instead of looking it up in the
+	 * registry for every scan. This is empty for tables which are not local
+	 * to this process, e.g. extension tables, those are called through the
+	 * Registry call API.
+	 */
+	std::shared_ptr<TablePlugin> plugin;
+
 	/// Attributes are copied into the content such that they can be quickly
 	/// passed to the SQL and optional Query for inspection.
 	TableAttributes attributes{TableAttributes::NONE};
@@ -672,6 +701,100 @@ private:
 using QueryContext = struct QueryContext;
 using Constraint = struct Constraint;
 
+/**
+ * @brief In-process cache of generated table results.
+ *
+ * Results are keyed by the table name, a fingerprint of the query constraints
+ * and the used-column bitset. An entry is fresh for the TTL of its table and
+ * is dropped early when the table is invalidated, e.g. after a write to the
+ * data a table reports.
+ */
+class TableCache : private boost::noncopyable {
+public:
+	/// Hit and miss counters of a table.
+	struct Stats {
+		size_t hits{0};
+		size_t misses{0};
+		size_t invalidations{0};
+	};
+
+	static TableCache& instance();
+
+	/// Build the key of the generated results from a query context.
+	static std::string fingerprint(const QueryContext& context);
+
+	/// Copy fresh results into rows, return false on a miss.
+	bool get(const std::string& table, const std::string& key, TableRows& rows);
+
+	/// Store a copy of generated results for ttl seconds.
+	void set(const std::string& table,
+			 const std::string& key,
+			 size_t ttl,
+			 const TableRows& rows);
+
+	/// Drop every result of a table.
+	void invalidate(const std::string& table);
+
+	/// Drop every result of all tables.
+	void invalidateAll();
+
+	/// Override the TTL of a table, 0 disables caching of the table.
+	void setTTL(const std::string& table, size_t ttl);
+
+	/// The TTL of a table, or the given default if it is not overridden.
+	size_t getTTL(const std::string& table, size_t ttl) const;
+
+	/// The hit and miss counters of a table.
+	Stats getStats(const std::string& table) const;
+
+public:
+	/// Maximum number of fingerprints kept per table.
+	static const size_t kMaxEntries;
+
+private:
+	TableCache() = default;
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string key;
+		Clock::time_point expires;
+		TableRows rows;
+	};
+
+	struct Table {
+		/// Most recently stored entries first.
+		std::list<Entry> entries;
+		Stats stats;
+	};
+
+	mutable Mutex mutex_;
+	std::unordered_map<std::string, Table> tables_;
+	std::unordered_map<std::string, size_t> ttls_;
+};
+
+/**
+ * @brief A pull based producer of table rows, see TablePlugin::generate.
+ *
+ * SQLite pulls rows from the generator while the cursor advances, so a query
+ * that stops early, e.g. with LIMIT or EXISTS, does not generate every row.
+ */
+class RowGenerator : private boost::noncopyable {
+public:
+	virtual ~RowGenerator() = default;
+
+	/**
+	 * @brief Append the next rows of the table.
+	 *
+	 * Generators should append a single row or a bounded chunk of rows per call,
+	 * the rows are kept in memory until the cursor walked over them.
+	 *
+	 * @param rows The output parameter, empty when called.
+	 * @return False if there are no more rows after the appended ones.
+	 */
+	virtual bool next(QueryData& rows) = 0;
+};
+
 /**
  * @brief The TablePlugin defines the name, types, and column information.
  *
@@ -753,6 +876,22 @@ public:
 		return QueryData();
 	}
 
+	/**
+	 * @brief Stream the result rows instead of selecting them at once.
+	 *
+	 * A table that generates many rows may return a generator, which is pulled
+	 * while SQLite walks the cursor. If no generator is returned, the default,
+	 * the rows are selected at once with select. The context outlives the
+	 * generator. Streamed results are not kept in the table result cache.
+	 *
+	 * @param context A query context filled in by SQLite's virtual table API.
+	 * @return The generator of the result rows, or nullptr to use select.
+	 */
+	virtual std::unique_ptr<RowGenerator> generate(QueryContext&)
+	{
+		return nullptr;
+	}
+
 	/// Callback for DELETE statements
 	virtual QueryData delete_(QueryContext& context,
 							  const PluginRequest& request)
@@ -783,6 +922,35 @@ public:
 		return {{std::make_pair("status", "readonly")}};
 	}
 
+	/**
+	 * @brief Callbacks of the write transaction of a statement.
+	 *
+	 * SQLite calls begin before the first INSERT, UPDATE or DELETE callback of
+	 * a statement, then sync and commit after the last one, or rollback. They
+	 * are called by the thread which runs the statement, so a table may keep
+	 * the writes per thread and apply them at once in sync. A failure of sync
+	 * aborts the statement.
+	 */
+	virtual Status begin()
+	{
+		return Status::success();
+	}
+
+	virtual Status sync()
+	{
+		return Status::success();
+	}
+
+	virtual Status commit()
+	{
+		return Status::success();
+	}
+
+	virtual Status rollback()
+	{
+		return Status::success();
+	}
+
 protected:
 	/// An SQL table containing the table definition/syntax.
 	std::string columnDefinition(bool is_extension = false) const;
@@ -790,73 +958,46 @@ protected:
 	/// Return the name and column pairs for attaching virtual tables.
 	PluginResponse routeInfo() const override;
 
+public:
 	/**
-	 * @brief Check if there are fresh cache results for this table.
-	 *
-	 * Table results are considered fresh when evaluated against a given interval.
-	 * The interval is the expected rate for which this data should be generated.
-	 * Caching and cache freshness only applies to queries acting on tables
-	 * within a schedule. If two queries "one" and "two" both inspect the
-	 * table "processes" at the interval 60. The first executed will cache results
-	 * and the second will use the cached results.
-	 *
-	 * Table results are not cached if a QueryContext contains constraints or
-	 * provides HOB (hand-off blocks) to additional tables within a query.
-	 * Currently, the query scheduler cannot communicate to table implementations.
-	 * An interval is set globally by the scheduler and passed to the table
-	 * implementation as a future-proof API. There is no "shortcut" for caching
-	 * when used in external tables. A cache lookup within an extension means
-	 * a database call API and re-serialization to the virtual table APIs. In
-	 * practice this does not perform well and is explicitly disabled.
-	 *
-	 * @param interval The interval this query expects the tables results.
-	 * @param ctx The query context.
-	 * @return True if the cache contains fresh results, otherwise false.
+	 * @brief The number of seconds generated results of this table stay fresh.
+	 *
+	 * Only CACHEABLE tables are cached by default, for kCacheTTL seconds. The
+	 * TTL of a table may be overridden at runtime with TableCache::setTTL.
+	 * A TTL of 0 disables the result cache of the table.
 	 */
-	bool isCached(size_t interval, const QueryContext& ctx) const;
+	virtual size_t cacheTTL() const
+	{
+		return (attributes() & TableAttributes::CACHEABLE) ? kCacheTTL : 0;
+	}
 
 	/**
-	 * @brief Perform a database lookup of cached results and deserialize.
+	 * @brief Copy the fresh cached results of a query context.
 	 *
-	 * If a query determined the table's cached results are fresh, it may ask the
-	 * table to retrieve results from the database and deserialized them into
-	 * table row data.
+	 * Results are only served from the cache when the query execution requested
+	 * the warm cache, see QueryContext::useCache. Every distinct set of
+	 * constraints and used columns is cached separately.
 	 *
-	 * @return The deserialized row data of cached results.
+	 * @param ctx The query context.
+	 * @param results The cached results, untouched on a miss.
+	 * @return True if the results were cached, otherwise false.
 	 */
-	TableRows getCache() const;
+	bool getCache(const QueryContext& ctx, TableRows& results) const;
 
 	/**
 	 * @brief Similar to getCache, stores the results from generate.
 	 *
-	 * Set will serialize and save the results as JSON to be retrieved later.
-	 * It will inspect the query context, if any required/indexed/optimized or
-	 * additional columns are used then the cache will not be saved.
+	 * Nothing is stored if the query did not request the warm cache or the
+	 * table TTL is 0.
 	 */
-	void setCache(size_t step,
-				  size_t interval,
-				  const QueryContext& ctx,
-				  const TableRows& results);
-
-private:
-	/// The last time in seconds the table data results were saved to cache.
-	size_t last_cached_{0};
+	void setCache(const QueryContext& ctx, const TableRows& results);
 
-	/// The last interval in seconds when the table data was cached.
-	size_t last_interval_{0};
+	/// Drop the cached results of a table, e.g. after its data changed.
+	static void invalidateCache(const std::string& table);
 
 public:
-	/**
-	 * @brief The scheduled interval for the executing query.
-	 *
-	 * Scheduled queries execute within a pseudo-mutex, and each may communicate
-	 * their scheduled interval to internal TablePlugin implementations. If the
-	 * table is cachable then the interval can be used to calculate freshness.
-	 */
-	static size_t kCacheInterval;
-
-	/// The schedule step, this is the current position of the schedule.
-	static size_t kCacheStep;
+	/// The default TTL in seconds of CACHEABLE tables.
+	static size_t kCacheTTL;
 
 public:
 	/**
@@ -905,6 +1046,8 @@ private:
 	FRIEND_TEST(VirtualTableTests, test_tableplugin_statement);
 	FRIEND_TEST(VirtualTableTests, test_indexing_costs);
 	FRIEND_TEST(VirtualTableTests, test_table_results_cache);
+	FRIEND_TEST(VirtualTableTests, test_table_results_cache_invalidation);
+	FRIEND_TEST(VirtualTableTests, test_constraints_refilter);
 	FRIEND_TEST(VirtualTableTests, test_yield_generator);
 };
 
@@ -13,6 +13,8 @@
 namespace osquery {
 void RegistryInterface::remove(const std::string& item_name)
 {
+	WriteLock lock(mutex_);
+
 	if (items_.count(item_name) > 0) {
 		items_[item_name]->tearDown();
 		items_.erase(item_name);
@@ -22,6 +22,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include <vist/logger.hpp>
+#include <vist/result-set.hpp>
 
 namespace osquery {
 
@@ -107,6 +108,11 @@ const std::map<std::string, QueryPlanner::Opcode> kSQLOpcodes = {
 
 RecursiveMutex SQLiteDBInstance::kPrimaryAttachMutex;
 
+const size_t StatementCache::kDefaultCapacity = 32;
+
+/// Maximum number of idle transient connections kept by the DB manager.
+const size_t kMaxIdleConnections = 4;
+
 /// The SQLiteSQLPlugin implements the "sql" registry for internal/core.
 class SQLiteSQLPlugin : public SQLPlugin {
 public:
@@ -184,6 +190,17 @@ SQLInternal::SQLInternal(const std::string& query, bool use_cache)
 	dbc->clearAffectedTables();
 }
 
+Status queryColumnar(const std::string& query,
+					 vist::ResultSet& results,
+					 bool use_cache)
+{
+	auto dbc = SQLiteDBManager::get();
+	dbc->useCache(use_cache);
+	auto status = queryInternal(query, results, dbc);
+	dbc->clearAffectedTables();
+	return status;
+}
+
 QueryDataTyped& SQLInternal::rowsTyped()
 {
 	return resultsTyped_;
@@ -247,6 +264,9 @@ Status SQLiteSQLPlugin::attach(const std::string& name)
 	// primary instance and avoid the contention decisions.
 	auto dbc = SQLiteDBManager::getConnection(true);
 
+	// Pooled connections do not have the new table.
+	SQLiteDBManager::invalidatePool();
+
 	// Attach as an extension, allowing read/write tables
 	return attachTableInternal(name, statement, dbc, is_extension);
 }
@@ -257,19 +277,149 @@ void SQLiteSQLPlugin::detach(const std::string& name)
 	if (!dbc->isPrimary()) {
 		return;
 	}
+	SQLiteDBManager::invalidatePool();
 	detachTableInternal(name, dbc);
 }
 
-SQLiteDBInstance::SQLiteDBInstance(sqlite3*& db, Mutex& mtx)
-	: db_(db), lock_(mtx, std::try_to_lock)
+StatementCache::~StatementCache()
 {
-	if (lock_.owns_lock()) {
-		primary_ = true;
-	} else {
-		db_ = nullptr;
-		DEBUG(OSQUERY) << "DBManager contention: opening transient SQLite database";
-		init();
+	clear();
+}
+
+bool StatementCache::take(const std::string& key, Entry& entry)
+{
+	auto it = index_.find(key);
+	if (it == index_.end()) {
+		return false;
+	}
+
+	// A statement in use is not shared, e.g. with a nested query.
+	entry = std::move(it->second->second);
+	entries_.erase(it->second);
+	index_.erase(it);
+	hits_++;
+	return true;
+}
+
+void StatementCache::put(const std::string& key, Entry entry)
+{
+	if (capacity_ == 0 || index_.count(key) > 0) {
+		sqlite3_finalize(entry.statement);
+		return;
+	}
+
+	entries_.emplace_front(key, std::move(entry));
+	index_[key] = entries_.begin();
+
+	if (entries_.size() > capacity_) {
+		sqlite3_finalize(entries_.back().second.statement);
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
+
+void StatementCache::clear()
+{
+	for (auto& entry : entries_) {
+		sqlite3_finalize(entry.second.statement);
 	}
+	entries_.clear();
+	index_.clear();
+}
+
+void StatementCache::startRecording()
+{
+	recorded_.clear();
+	recording_ = true;
+}
+
+std::vector<StatementCache::Plan> StatementCache::stopRecording()
+{
+	recording_ = false;
+	return std::move(recorded_);
+}
+
+void StatementCache::record(const std::shared_ptr<VirtualTableContent>& table,
+							size_t index)
+{
+	if (!recording_) {
+		return;
+	}
+
+	Plan plan{table, index, table->constraints[index], table->colsUsed[index],
+			  table->colsUsedBitsets[index]};
+	// Expressions are filled in by xFilter, per execution.
+	for (auto& constraint : plan.constraints) {
+		constraint.second.expr.clear();
+	}
+	recorded_.push_back(std::move(plan));
+}
+
+void StatementCache::restore(const std::vector<Plan>& plans)
+{
+	for (const auto& plan : plans) {
+		plan.table->constraints[plan.index] = plan.constraints;
+		plan.table->colsUsed[plan.index] = plan.colsUsed;
+		plan.table->colsUsedBitsets[plan.index] = plan.colsUsedBitset;
+	}
+}
+
+std::string StatementCache::normalize(const std::string& query)
+{
+	std::string key;
+	key.reserve(query.size());
+
+	// A comment is kept as is, since its newline ends a line comment.
+	const char* close = nullptr;
+	char quote = 0;
+	bool space = false;
+	for (size_t i = 0; i < query.size(); i++) {
+		char c = query[i];
+		if (close != nullptr) {
+			key += c;
+			if (c == close[0] && (close[1] == '\0' ||
+								  (i + 1 < query.size() && query[i + 1] == close[1]))) {
+				if (close[1] != '\0') {
+					key += query[++i];
+				}
+				close = nullptr;
+			}
+			continue;
+		}
+
+		if (quote != 0) {
+			key += c;
+			if (c == quote) {
+				quote = 0;
+			}
+			continue;
+		}
+
+		if (isspace(static_cast<unsigned char>(c))) {
+			space = true;
+			continue;
+		}
+
+		if (space && !key.empty()) {
+			key += ' ';
+		}
+		space = false;
+
+		char next = i + 1 < query.size() ? query[i + 1] : 0;
+		if (c == '-' && next == '-') {
+			close = "\n";
+		} else if (c == '/' && next == '*') {
+			close = "*/";
+			key += c;
+			c = query[++i];
+		} else if (c == '\'' || c == '"' || c == '`') {
+			quote = c;
+		} else if (c == '[') {
+			quote = ']';
+		}
+		key += c;
+	}
+	return key;
 }
 
 static inline void openOptimized(sqlite3*& db)
@@ -293,6 +443,11 @@ void SQLiteDBInstance::init()
 
 void SQLiteDBInstance::useCache(bool use_cache)
 {
+	if (isPrimary() && !managed_) {
+		// The virtual tables of the primary database were attached with the
+		// DB manager's 'connection' instance, they read the request from it.
+		SQLiteDBManager::getConnection(true)->useCache(use_cache);
+	}
 	use_cache_ = use_cache;
 }
 
@@ -321,6 +476,15 @@ bool SQLiteDBInstance::tableCalled(VirtualTableContent const& table)
 	return (affected_tables_.count(table.name) > 0);
 }
 
+StatementCache& SQLiteDBInstance::statements()
+{
+	if (isPrimary() && !managed_) {
+		// The virtual tables of the primary database belong to the connection.
+		return SQLiteDBManager::getConnection(true)->statements_;
+	}
+	return statements_;
+}
+
 TableAttributes SQLiteDBInstance::getAttributes() const
 {
 	const SQLiteDBInstance* rdbc = this;
@@ -359,6 +523,8 @@ void SQLiteDBInstance::clearAffectedTables()
 
 SQLiteDBInstance::~SQLiteDBInstance()
 {
+	// Statements must be finalized before their database is closed.
+	statements_.clear();
 	if (!isPrimary() && db_ != nullptr) {
 		sqlite3_close(db_);
 	} else {
@@ -366,11 +532,149 @@ SQLiteDBInstance::~SQLiteDBInstance()
 	}
 }
 
-SQLiteDBManager::SQLiteDBManager() : db_(nullptr)
+/// Read the schema cookies of the main and the temp database.
+static std::pair<int, int> schemaVersions(sqlite3* db)
+{
+	auto read = [db](const char* pragma) {
+		int version = -1;
+		sqlite3_stmt* stmt = nullptr;
+		if (sqlite3_prepare_v2(db, pragma, -1, &stmt, nullptr) == SQLITE_OK &&
+			sqlite3_step(stmt) == SQLITE_ROW) {
+			version = sqlite3_column_int(stmt, 0);
+		}
+		sqlite3_finalize(stmt);
+		return version;
+	};
+
+	return std::make_pair(read("PRAGMA main.schema_version"),
+						  read("PRAGMA temp.schema_version"));
+}
+
+/**
+ * @brief Transient connections kept for the next access contention.
+ *
+ * Opening an in-memory database and attaching every virtual table is the
+ * expensive part of a transient connection. Released connections are kept
+ * idle and handed out again as long as the set of attached tables (the
+ * generation) did not change.
+ */
+class SQLiteDBManager::Pool : public std::enable_shared_from_this<Pool> {
+public:
+	SQLiteDBInstanceRef acquire()
+	{
+		std::unique_ptr<SQLiteDBInstance> instance;
+		std::vector<std::unique_ptr<SQLiteDBInstance>> stale;
+		size_t generation = generation_;
+		{
+			WriteLock lock(mutex_);
+			while (instance == nullptr && !idle_.empty()) {
+				auto candidate = std::move(idle_.back());
+				idle_.pop_back();
+				if (candidate->generation_ == generation) {
+					instance = std::move(candidate);
+				} else {
+					stale.push_back(std::move(candidate));
+				}
+			}
+		}
+
+		bool attach = (instance == nullptr);
+		if (attach) {
+			DEBUG(OSQUERY) << "DBManager contention: opening transient SQLite database";
+			instance.reset(new SQLiteDBInstance());
+			instance->generation_ = generation;
+		}
+
+		std::weak_ptr<Pool> pool = shared_from_this();
+		SQLiteDBInstanceRef ref(instance.release(), [pool](SQLiteDBInstance* p) {
+			auto self = pool.lock();
+			if (self != nullptr) {
+				self->release(p);
+			} else {
+				delete p;
+			}
+		});
+
+		if (attach) {
+			attachVirtualTables(ref);
+			ref->schema_version_ = schemaVersions(ref->db());
+		}
+		return ref;
+	}
+
+	void invalidate()
+	{
+		generation_++;
+
+		std::vector<std::unique_ptr<SQLiteDBInstance>> stale;
+		WriteLock lock(mutex_);
+		stale.swap(idle_);
+	}
+
+private:
+	/// Check if a transient connection was changed beyond its virtual tables.
+	static bool hasUserState(const SQLiteDBInstance& instance)
+	{
+		sqlite3* db = instance.db();
+
+		// "main" and "temp" are the only databases of a transient connection.
+		sqlite3_stmt* stmt = nullptr;
+		if (sqlite3_prepare_v2(db, "PRAGMA database_list", -1, &stmt, nullptr) != SQLITE_OK) {
+			sqlite3_finalize(stmt);
+			return true;
+		}
+
+		bool attached = false;
+		while (!attached && sqlite3_step(stmt) == SQLITE_ROW) {
+			std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+			attached = (name != "main" && name != "temp");
+		}
+		sqlite3_finalize(stmt);
+		if (attached) {
+			return true;
+		}
+
+		// Virtual tables live in "temp", any other schema change is a user's.
+		return schemaVersions(db) != instance.schema_version_;
+	}
+
+	void release(SQLiteDBInstance* instance)
+	{
+		std::unique_ptr<SQLiteDBInstance> released(instance);
+		released->clearAffectedTables();
+
+		// Attached databases, tables or temporary objects created by a query
+		// must not be visible to the next user of the connection.
+		if (hasUserState(*released)) {
+			DEBUG(OSQUERY) << "DBManager: discarding modified transient SQLite database";
+			return;
+		}
+
+		WriteLock lock(mutex_);
+		if (released->generation_ == generation_ &&
+			idle_.size() < kMaxIdleConnections) {
+			idle_.push_back(std::move(released));
+		}
+	}
+
+private:
+	/// Incremented whenever virtual tables are attached or detached.
+	std::atomic<size_t> generation_{0};
+
+	Mutex mutex_;
+	std::vector<std::unique_ptr<SQLiteDBInstance>> idle_;
+};
+
+SQLiteDBManager::SQLiteDBManager() : db_(nullptr), pool_(std::make_shared<Pool>())
 {
 	sqlite3_soft_heap_limit64(1);
 }
 
+void SQLiteDBManager::invalidatePool()
+{
+	instance().pool_->invalidate();
+}
+
 bool SQLiteDBManager::isDisabled(const std::string& table_name)
 {
 	const auto& element = instance().disabled_tables_.find(table_name);
@@ -383,6 +687,7 @@ void SQLiteDBManager::resetPrimary()
 
 	WriteLock connection_lock(self.mutex_);
 	self.connection_.reset();
+	self.pool_->invalidate();
 
 	{
 		WriteLock create_lock(self.create_mutex_);
@@ -416,11 +721,15 @@ SQLiteDBInstanceRef SQLiteDBManager::getConnection(bool primary)
 	}
 
 	// Create a 'database connection' for the managed database instance.
-	auto instance = std::make_shared<SQLiteDBInstance>(self.db_, self.mutex_);
-	if (!instance->isPrimary()) {
-		attachVirtualTables(instance);
+	WriteLock primary_lock(self.mutex_, std::try_to_lock);
+	if (primary_lock.owns_lock()) {
+		return SQLiteDBInstanceRef(
+				   new SQLiteDBInstance(self.db_, std::move(primary_lock)));
 	}
-	return instance;
+
+	// Contention, reuse an idle transient connection if there is one.
+	lock.unlock();
+	return self.pool_->acquire();
 }
 
 SQLiteDBManager::~SQLiteDBManager()
@@ -578,21 +887,134 @@ Status readRows(sqlite3_stmt* prepared_statement,
 		return Status::failure(sqlite3_errmsg(instance->db()));
 	}
 
-	rc = sqlite3_finalize(prepared_statement);
-	if (rc != SQLITE_OK) {
+	return Status::success();
+}
+
+Status readRows(sqlite3_stmt* prepared_statement,
+				vist::ResultSet& results,
+				const SQLiteDBInstanceRef& instance)
+{
+	if (prepared_statement == nullptr) {
+		return Status::success();
+	}
+
+	// The header is emitted even if the result set is empty.
+	int num_columns = sqlite3_column_count(prepared_statement);
+	if (num_columns == 0) {
+		// Statements without result columns (e.g. UPDATE) only need stepping.
+	} else if (results.getNames().empty()) {
+		std::vector<std::string> colNames;
+		colNames.reserve(num_columns);
+		for (int i = 0; i < num_columns; i++) {
+			colNames.push_back(sqlite3_column_name(prepared_statement, i));
+		}
+		results.setNames(std::move(colNames));
+	} else if (results.getNames().size() != static_cast<std::size_t>(num_columns)) {
+		return Status::failure("Statements returned different columns.");
+	}
+
+	int rc = sqlite3_step(prepared_statement);
+	while (SQLITE_ROW == rc) {
+		for (int i = 0; i < num_columns; i++) {
+			switch (sqlite3_column_type(prepared_statement, i)) {
+			case SQLITE_INTEGER:
+				results.append(i, static_cast<long long>(
+								   sqlite3_column_int64(prepared_statement, i)));
+				break;
+			case SQLITE_FLOAT:
+				results.append(i, sqlite3_column_double(prepared_statement, i));
+				break;
+			case SQLITE_NULL:
+				results.appendNull(i);
+				break;
+			default:
+				results.append(i, std::string(
+								   reinterpret_cast<const char*>(
+									   sqlite3_column_text(prepared_statement, i)),
+								   sqlite3_column_bytes(prepared_statement, i)));
+			}
+		}
+		rc = sqlite3_step(prepared_statement);
+	}
+	if (rc != SQLITE_DONE) {
 		return Status::failure(sqlite3_errmsg(instance->db()));
 	}
 
 	return Status::success();
 }
 
-Status queryInternal(const std::string& query,
-					 QueryDataTyped& results,
+/// Only a single, read-only statement may be reset and stepped again.
+static inline bool isCacheable(sqlite3_stmt* prepared_statement,
+							   const char* leftover_sql)
+{
+	if (prepared_statement == nullptr ||
+		!sqlite3_stmt_readonly(prepared_statement)) {
+		return false;
+	}
+
+	while (isspace(leftover_sql[0])) {
+		leftover_sql++;
+	}
+	return leftover_sql[0] == '\0';
+}
+
+/// Read the rows of a statement, the statement is finalized on failure.
+template <typename Results>
+Status stepStatement(StatementCache::Entry& entry,
+					 Results& results,
 					 const SQLiteDBInstanceRef& instance)
+{
+	auto& statements = instance->statements();
+
+	StatementCache::restore(entry.plans);
+	statements.startRecording();
+	Status s = readRows(entry.statement, results, instance);
+	auto replanned = statements.stopRecording();
+
+	// SQLite re-prepares a statement on a schema change.
+	if (!replanned.empty()) {
+		entry.plans = std::move(replanned);
+	}
+
+	if (!s.ok()) {
+		sqlite3_finalize(entry.statement);
+		entry.statement = nullptr;
+		return s;
+	}
+
+	sqlite3_reset(entry.statement);
+	sqlite3_clear_bindings(entry.statement);
+	return s;
+}
+
+template <typename Results>
+Status queryInternalImpl(const std::string& query,
+						 Results& results,
+						 const SQLiteDBInstanceRef& instance)
 {
 	if (query.empty())
 		return Status::failure("Query cannot be empty.");
 
+	auto& statements = instance->statements();
+	auto key = StatementCache::normalize(query);
+	StatementCache::Entry cached;
+	bool hit = false;
+	{
+		const auto lock = instance->attachLock();
+		hit = statements.take(key, cached);
+	}
+
+	// A taken statement is owned by this query, other queries on the
+	// database do not wait while it is stepped.
+	if (hit) {
+		Status s = stepStatement(cached, results, instance);
+		if (s.ok()) {
+			const auto lock = instance->attachLock();
+			statements.put(key, std::move(cached));
+		}
+		return s;
+	}
+
 	sqlite3_stmt* prepared_statement{nullptr}; /* Statement to execute. */
 
 	int rc = SQLITE_OK; /* Return Code */
@@ -607,15 +1029,29 @@ Status queryInternal(const std::string& query,
 		while (isspace(sql[0])) {
 			sql++;
 		}
+		bool first = (leftover_sql == nullptr);
+		statements.startRecording();
 		rc = sqlite3_prepare_v2(
 				 instance->db(), sql, -1, &prepared_statement, &leftover_sql);
+		auto plans = statements.stopRecording();
 		if (rc != SQLITE_OK) {
 			Status s = Status::failure(sqlite3_errmsg(instance->db()));
 			sqlite3_finalize(prepared_statement);
 			return s;
 		}
 
+		if (first && isCacheable(prepared_statement, leftover_sql)) {
+			StatementCache::Entry entry{prepared_statement, std::move(plans)};
+			Status s = stepStatement(entry, results, instance);
+			if (!s.ok()) {
+				return s;
+			}
+			statements.put(key, std::move(entry));
+			break;
+		}
+
 		Status s = readRows(prepared_statement, results, instance);
+		sqlite3_finalize(prepared_statement);
 		if (!s.ok()) {
 			return s;
 		}
@@ -626,6 +1062,20 @@ Status queryInternal(const std::string& query,
 	return Status::success();
 }
 
+Status queryInternal(const std::string& query,
+					 QueryDataTyped& results,
+					 const SQLiteDBInstanceRef& instance)
+{
+	return queryInternalImpl(query, results, instance);
+}
+
+Status queryInternal(const std::string& query,
+					 vist::ResultSet& results,
+					 const SQLiteDBInstanceRef& instance)
+{
+	return queryInternalImpl(query, results, instance);
+}
+
 Status getQueryColumnsInternal(const std::string& q,
 							   TableColumns& columns,
 							   const SQLiteDBInstanceRef& instance)
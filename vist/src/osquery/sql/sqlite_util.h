@@ -9,8 +9,10 @@
 #pragma once
 
 #include <atomic>
+#include <list>
 #include <map>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <sqlite3.h>
@@ -30,6 +32,97 @@ namespace osquery {
 
 class SQLiteDBManager;
 
+/**
+ * @brief A per-connection LRU of prepared statements.
+ *
+ * Statements are keyed by their normalized SQL text. A cached statement is
+ * reset and stepped again, which skips both the SQLite parser and the virtual
+ * table planning (xBestIndex) for repeated queries.
+ *
+ * The constraint sets xBestIndex records into a VirtualTableContent are
+ * cleared after every query, so each entry keeps a snapshot of the sets
+ * planned for its statement and restores them before it is stepped again.
+ */
+class StatementCache : private boost::noncopyable {
+public:
+	/// A constraint set recorded by xBestIndex while a statement is planned.
+	struct Plan {
+		std::shared_ptr<VirtualTableContent> table;
+		size_t index;
+		ConstraintSet constraints;
+		UsedColumns colsUsed;
+		UsedColumnsBitset colsUsedBitset;
+	};
+
+	struct Entry {
+		sqlite3_stmt* statement{nullptr};
+		std::vector<Plan> plans;
+	};
+
+	explicit StatementCache(size_t capacity = kDefaultCapacity)
+		: capacity_(capacity) {}
+	~StatementCache();
+
+	/// Remove the statement cached for a normalized query from the cache.
+	bool take(const std::string& key, Entry& entry);
+
+	/// Cache a statement, the least recently used one is finalized if full.
+	void put(const std::string& key, Entry entry);
+
+	/// Finalize all cached statements.
+	void clear();
+
+	/// The number of cached statements.
+	size_t size() const
+	{
+		return entries_.size();
+	}
+
+	/// The number of queries served by a cached statement.
+	size_t hits() const
+	{
+		return hits_;
+	}
+
+	/// Start recording the constraint sets planned by xBestIndex.
+	void startRecording();
+
+	/// Stop recording and return the recorded constraint sets.
+	std::vector<Plan> stopRecording();
+
+	/// Allow a virtual table implementation to record a planned index.
+	void record(const std::shared_ptr<VirtualTableContent>& table, size_t index);
+
+	/// Restore recorded constraint sets into their tables.
+	static void restore(const std::vector<Plan>& plans);
+
+	/// Trim and collapse whitespace outside of quoted strings and comments.
+	static std::string normalize(const std::string& query);
+
+public:
+	/// The default number of statements cached per connection.
+	static const size_t kDefaultCapacity;
+
+private:
+	using Entries = std::list<std::pair<std::string, Entry>>;
+
+	/// Maximum number of cached statements.
+	size_t capacity_;
+
+	/// Most recently used statements first.
+	Entries entries_;
+
+	/// Lookup from a normalized query into entries_.
+	std::unordered_map<std::string, Entries::iterator> index_;
+
+	/// Constraint sets planned since startRecording.
+	std::vector<Plan> recorded_;
+
+	bool recording_{false};
+
+	size_t hits_{0};
+};
+
 /**
  * @brief An RAII wrapper around an `sqlite3` object.
  *
@@ -47,7 +140,6 @@ public:
 	{
 		init();
 	}
-	SQLiteDBInstance(sqlite3*& db, Mutex& mtx);
 	~SQLiteDBInstance();
 
 	/// Check if the instance is the osquery primary.
@@ -86,6 +178,14 @@ public:
 	/// Lock the database for attaching virtual tables.
 	RecursiveLock attachLock() const;
 
+	/**
+	 * @brief Prepared statements of the database.
+	 *
+	 * A primary instance forwards to the DB manager's 'connection' instance,
+	 * which owns the virtual tables of the primary database.
+	 */
+	StatementCache& statements();
+
 private:
 	/// Handle the primary/forwarding requests for table attribute accesses.
 	TableAttributes getAttributes() const;
@@ -95,6 +195,10 @@ private:
 	explicit SQLiteDBInstance(sqlite3* db)
 		: primary_(true), managed_(true), db_(db) {}
 
+	/// An opaque constructor for a locked access to the primary database.
+	SQLiteDBInstance(sqlite3* db, WriteLock&& lock)
+		: primary_(true), db_(db), lock_(std::move(lock)) {}
+
 private:
 	/// Introspection into the database pointer, primary means managed.
 	bool primary_{false};
@@ -131,6 +235,15 @@ private:
 	/// Vector of tables that need their constraints cleared after execution.
 	std::map<std::string, std::shared_ptr<VirtualTableContent>> affected_tables_;
 
+	/// Cached prepared statements, finalized before the database is closed.
+	StatementCache statements_;
+
+	/// The set of attached tables a transient instance was created with.
+	size_t generation_{0};
+
+	/// The main and temp schema cookies after attaching the virtual tables.
+	std::pair<int, int> schema_version_{0, 0};
+
 private:
 	friend class SQLiteDBManager;
 	friend class SQLInternal;
@@ -219,6 +332,10 @@ private:
 	/// Mutex and lock around sqlite3 access.
 	Mutex mutex_;
 
+	/// Idle transient connections with all virtual tables attached.
+	class Pool;
+	std::shared_ptr<Pool> pool_;
+
 	/// A write mutex for initializing the primary database.
 	Mutex create_mutex_;
 
@@ -231,6 +348,9 @@ private:
 	/// Request a connection, optionally request the primary connection.
 	static SQLiteDBInstanceRef getConnection(bool primary = false);
 
+	/// Discard pooled connections, the set of attached tables has changed.
+	static void invalidatePool();
+
 private:
 	friend class SQLiteDBInstance;
 	friend class SQLiteSQLPlugin;
@@ -343,6 +463,22 @@ Status queryInternal(const std::string& q,
 					 QueryData& results,
 					 const SQLiteDBInstanceRef& instance);
 
+/**
+ * @brief SQLite Internal: Execute a query on a specific database
+ *
+ * Same as the QueryDataTyped version but the results are emitted column by
+ * column, without building a map per row.
+ *
+ * @param q the query to execute
+ * @param results The ResultSet to emit columns on query success.
+ * @param db the SQLite3 database to execute query q against
+ *
+ * @return A status indicating SQL query results.
+ */
+Status queryInternal(const std::string& q,
+					 vist::ResultSet& results,
+					 const SQLiteDBInstanceRef& instance);
+
 /**
  * @brief SQLite Intern: Analyze a query, providing information about the
  * result columns
@@ -80,6 +80,47 @@ TEST_F(SQLiteUtilTests, test_sqlite_instance_manager)
 	EXPECT_EQ(dbc1->db(), dbc1->db());
 }
 
+TEST_F(SQLiteUtilTests, test_sqlite_instance_pool)
+{
+	auto dbc1 = SQLiteDBManager::get();
+	EXPECT_TRUE(dbc1->isPrimary());
+
+	const std::string query = "SELECT 1 AS pooled";
+	QueryDataTyped results;
+	{
+		auto dbc2 = SQLiteDBManager::get();
+		EXPECT_FALSE(dbc2->isPrimary());
+		EXPECT_TRUE(queryInternal(query, results, dbc2).ok());
+	}
+
+	// The released transient connection is reused, with its statements.
+	auto dbc3 = SQLiteDBManager::get();
+	EXPECT_TRUE(queryInternal(query, results, dbc3).ok());
+	EXPECT_EQ(dbc3->statements().hits(), 1U);
+
+	// A connection with user created objects is not handed out again.
+	const std::string marker = "SELECT * FROM pool_marker";
+	ASSERT_EQ(sqlite3_exec(dbc3->db(), "CREATE TEMP TABLE pool_marker (x int)",
+						   nullptr, nullptr, nullptr), SQLITE_OK);
+	EXPECT_TRUE(queryInternal(marker, results, dbc3).ok());
+	dbc3.reset();
+
+	auto dbc4 = SQLiteDBManager::get();
+	EXPECT_FALSE(queryInternal(marker, results, dbc4).ok());
+	EXPECT_TRUE(queryInternal(query, results, dbc4).ok());
+	EXPECT_EQ(dbc4->statements().hits(), 0U);
+
+	// The set of attached tables changed, the idle connection is discarded.
+	dbc4.reset();
+	dbc1.reset();
+	SQLiteDBManager::resetPrimary();
+	dbc1 = SQLiteDBManager::get();
+	auto dbc5 = SQLiteDBManager::get();
+	EXPECT_FALSE(dbc5->isPrimary());
+	EXPECT_TRUE(queryInternal(query, results, dbc5).ok());
+	EXPECT_EQ(dbc5->statements().hits(), 0U);
+}
+
 TEST_F(SQLiteUtilTests, test_sqlite_instance)
 {
 	// Don't do this at home kids.
@@ -149,6 +190,61 @@ TEST_F(SQLiteUtilTests, test_whitespace_query)
 	EXPECT_TRUE(status.ok());
 }
 
+TEST_F(SQLiteUtilTests, test_statement_cache)
+{
+	auto dbc = getTestDBC();
+	QueryDataTyped results;
+	EXPECT_TRUE(queryInternal(kTestQuery, results, dbc).ok());
+	EXPECT_EQ(dbc->statements().size(), 1U);
+	EXPECT_EQ(dbc->statements().hits(), 0U);
+
+	// Whitespace outside of quoted strings does not change the statement.
+	QueryDataTyped cached;
+	EXPECT_TRUE(queryInternal("  " + kTestQuery + "\n", cached, dbc).ok());
+	EXPECT_EQ(dbc->statements().hits(), 1U);
+	EXPECT_EQ(cached, results);
+
+	EXPECT_EQ(StatementCache::normalize(" select\t'a  b'  from\n t "),
+			  "select 'a  b' from t");
+
+	// A comment ends at its newline, so it is not collapsed.
+	EXPECT_NE(StatementCache::normalize("SELECT a -- x\nFROM t"),
+			  StatementCache::normalize("SELECT a -- x FROM t"));
+	EXPECT_EQ(StatementCache::normalize("SELECT a  -- x\n  FROM t"),
+			  "SELECT a -- x\n FROM t");
+	EXPECT_EQ(StatementCache::normalize("SELECT /*  x\n */  a"),
+			  "SELECT /*  x\n */ a");
+	EXPECT_EQ(StatementCache::normalize("SELECT a /* x */"), "SELECT a /* x */");
+
+	// Statements which modify the database are not cached.
+	EXPECT_TRUE(queryInternal("DELETE FROM test_table", results, dbc).ok());
+	EXPECT_EQ(dbc->statements().size(), 1U);
+
+	QueryDataTyped empty;
+	EXPECT_TRUE(queryInternal(kTestQuery, empty, dbc).ok());
+	EXPECT_EQ(dbc->statements().hits(), 2U);
+	EXPECT_TRUE(empty.empty());
+}
+
+TEST_F(SQLiteUtilTests, test_statement_cache_eviction)
+{
+	StatementCache cache(2);
+	auto dbc = getTestDBC();
+	for (const auto& query : {"select 1", "select 2", "select 3"}) {
+		StatementCache::Entry entry;
+		ASSERT_EQ(sqlite3_prepare_v2(dbc->db(), query, -1, &entry.statement, nullptr),
+				  SQLITE_OK);
+		cache.put(query, std::move(entry));
+	}
+	EXPECT_EQ(cache.size(), 2U);
+
+	StatementCache::Entry entry;
+	EXPECT_FALSE(cache.take("select 1", entry));
+	EXPECT_TRUE(cache.take("select 3", entry));
+	EXPECT_EQ(cache.size(), 1U);
+	sqlite3_finalize(entry.statement);
+}
+
 TEST_F(SQLiteUtilTests, test_get_test_db_result_stream)
 {
 	auto dbc = getTestDBC();
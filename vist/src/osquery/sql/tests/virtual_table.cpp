@@ -341,6 +341,16 @@ TEST_F(VirtualTableTests, test_constraints_stacking)
 		queryInternal(test.first + " union " + test.first, results, dbc);
 		EXPECT_EQ(results, union_results[index++]);
 	}
+
+	// Cached statements restore the constraint sets cleared after each query.
+	auto hits = dbc->statements().hits();
+	for (const auto& test : constraint_tests) {
+		dbc->clearAffectedTables();
+		QueryData results;
+		queryInternal(test.first, results, dbc);
+		EXPECT_EQ(results, test.second) << "Unexpected cached result for the query: " << test.first;
+	}
+	EXPECT_EQ(dbc->statements().hits(), hits + constraint_tests.size());
 }
 
 class jsonTablePlugin : public TablePlugin {
@@ -364,6 +374,54 @@ private:
 	FRIEND_TEST(VirtualTableTests, test_json_extract);
 };
 
+class refilterTablePlugin : public TablePlugin {
+private:
+	TableColumns columns() const override
+	{
+		return {
+			std::make_tuple("i", INTEGER_TYPE, ColumnOptions::INDEX),
+		};
+	}
+
+public:
+	QueryData select(QueryContext& context) override
+	{
+		auto indexes = context.constraints["i"].getAll(EQUALS);
+		filters_.push_back(std::vector<std::string>(indexes.begin(), indexes.end()));
+
+		QueryData results;
+		for (const auto& index : indexes) {
+			results.push_back({{"i", index}});
+		}
+		return results;
+	}
+
+	std::vector<std::vector<std::string>> filters_;
+};
+
+TEST_F(VirtualTableTests, test_constraints_refilter)
+{
+	auto tables = RegistryFactory::get().registry("table");
+	auto refilter = std::make_shared<refilterTablePlugin>();
+	tables->add("p", std::make_shared<pTablePlugin>());
+	tables->add("refilter", refilter);
+	auto dbc = SQLiteDBManager::getUnique();
+	attachTableInternal("p", pTablePlugin().columnDefinition(false), dbc, false);
+	attachTableInternal(
+		"refilter", refilter->columnDefinition(false), dbc, false);
+
+	// The inner table is filtered once per outer row with the same cursor.
+	QueryData results;
+	auto status = queryInternal(
+		"select r.i from p, refilter r where r.i = p.x", results, dbc);
+	ASSERT_TRUE(status.ok());
+	EXPECT_EQ(results, makeResult("i", {"1", "2"}));
+
+	// Constraints of a previous filter must not leak into the next one.
+	std::vector<std::vector<std::string>> expected = {{"1"}, {"2"}};
+	EXPECT_EQ(refilter->filters_, expected);
+}
+
 TEST_F(VirtualTableTests, test_json_extract)
 {
 	// Get a database connection.
@@ -556,6 +614,139 @@ TEST_F(VirtualTableTests, test_table_results_cache)
 	EXPECT_EQ(cache->generates_, 4U);
 }
 
+class writableCacheTablePlugin : public tableCacheTablePlugin {
+public:
+	QueryData insert(QueryContext&, const PluginRequest&) override
+	{
+		return {{std::make_pair("status", "success")}};
+	}
+};
+
+TEST_F(VirtualTableTests, test_table_results_cache_invalidation)
+{
+	auto tables = RegistryFactory::get().registry("table");
+	auto cache = std::make_shared<writableCacheTablePlugin>();
+	tables->add("writable_cache", cache);
+	auto dbc = SQLiteDBManager::getUnique();
+	attachTableInternal(
+		"writable_cache", cache->columnDefinition(false), dbc, false);
+	dbc->useCache(true);
+
+	auto& tableCache = TableCache::instance();
+	auto before = tableCache.getStats("writable_cache");
+
+	QueryData results;
+	std::string statement = "SELECT * from writable_cache;";
+	queryInternal(statement, results, dbc);
+	queryInternal(statement, results, dbc);
+	EXPECT_EQ(cache->generates_, 1U);
+
+	auto stats = tableCache.getStats("writable_cache");
+	EXPECT_EQ(stats.hits, before.hits + 1);
+	EXPECT_EQ(stats.misses, before.misses + 1);
+
+	// A write through the virtual table drops the cached results.
+	statement = "INSERT INTO writable_cache (i, d) VALUES ('2', 'data');";
+	ASSERT_TRUE(queryInternal(statement, results, dbc).ok());
+	EXPECT_EQ(tableCache.getStats("writable_cache").invalidations,
+			  before.invalidations + 1);
+
+	results.clear();
+	statement = "SELECT * from writable_cache;";
+	queryInternal(statement, results, dbc);
+	EXPECT_EQ(results.size(), 1U);
+	EXPECT_EQ(cache->generates_, 2U);
+
+	// The TTL of 0 disables the cache of the table.
+	tableCache.setTTL("writable_cache", 0);
+	queryInternal(statement, results, dbc);
+	EXPECT_EQ(cache->generates_, 3U);
+
+	tableCache.setTTL("writable_cache", cache->cacheTTL());
+	queryInternal(statement, results, dbc);
+	queryInternal(statement, results, dbc);
+	EXPECT_EQ(cache->generates_, 4U);
+
+	TablePlugin::invalidateCache("writable_cache");
+	queryInternal(statement, results, dbc);
+	EXPECT_EQ(cache->generates_, 5U);
+}
+
+class yieldTablePlugin : public TablePlugin {
+private:
+	TableColumns columns() const override
+	{
+		return {
+			std::make_tuple("i", INTEGER_TYPE, ColumnOptions::DEFAULT),
+		};
+	}
+
+	class Generator : public RowGenerator {
+	public:
+		Generator(yieldTablePlugin& table) : table_(table) {}
+
+		bool next(QueryData& rows) override
+		{
+			if (table_.fail_ && table_.generated_ > 0) {
+				throw std::runtime_error("failure");
+			}
+
+			for (size_t i = 0; i < kChunk && table_.generated_ < kRows; i++) {
+				rows.push_back({{"i", std::to_string(table_.generated_++)}});
+			}
+			return table_.generated_ < kRows;
+		}
+
+	private:
+		yieldTablePlugin& table_;
+	};
+
+public:
+	std::unique_ptr<RowGenerator> generate(QueryContext&) override
+	{
+		return std::make_unique<Generator>(*this);
+	}
+
+	static constexpr size_t kRows{100};
+	static constexpr size_t kChunk{10};
+
+	size_t generated_{0};
+	bool fail_{false};
+};
+
+TEST_F(VirtualTableTests, test_yield_generator)
+{
+	auto tables = RegistryFactory::get().registry("table");
+	auto yield = std::make_shared<yieldTablePlugin>();
+	tables->add("yield", yield);
+	auto dbc = SQLiteDBManager::getUnique();
+	attachTableInternal("yield", yield->columnDefinition(false), dbc, false);
+
+	// Every row is streamed in order.
+	QueryData results;
+	auto status = queryInternal("SELECT i FROM yield", results, dbc);
+	ASSERT_TRUE(status.ok());
+	ASSERT_EQ(results.size(), yieldTablePlugin::kRows);
+	EXPECT_EQ(results[0]["i"], "0");
+	EXPECT_EQ(results[99]["i"], "99");
+	EXPECT_EQ(yield->generated_, yieldTablePlugin::kRows);
+
+	// A limit stops pulling after the chunk which contains the last row.
+	yield->generated_ = 0;
+	results.clear();
+	status = queryInternal("SELECT i FROM yield LIMIT 15", results, dbc);
+	ASSERT_TRUE(status.ok());
+	EXPECT_EQ(results.size(), 15U);
+	EXPECT_EQ(yield->generated_, 2 * yieldTablePlugin::kChunk);
+
+	// A generator failure fails the query.
+	yield->generated_ = 0;
+	yield->fail_ = true;
+	results.clear();
+	status = queryInternal("SELECT i FROM yield", results, dbc);
+	EXPECT_FALSE(status.ok());
+}
+
 class likeTablePlugin : public TablePlugin {
 private:
 	TableColumns columns() const override
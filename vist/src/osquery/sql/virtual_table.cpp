@@ -142,7 +142,7 @@ int serializeDeleteParameters(std::string& serialized, VirtualTable* pVtab)
 	json::Json document;
 	document.push("values", values);
 
-	serialized = document.serialize();
+	serialized = document.dump();
 	DEBUG(VIST) << "Serialized sql parameters: " << serialized;
 
 	return SQLITE_OK;
@@ -235,7 +235,7 @@ int serializeUpdateParameters(std::string& serialized,
 	json::Json document;
 	document.push("values", values);
 
-	serialized = document.serialize();
+	serialized = document.dump();
 	DEBUG(VIST) << "Serialized sql parameters: " << serialized;
 
 	return SQLITE_OK;
@@ -261,6 +261,44 @@ void setTableErrorMessage(sqlite3_vtab* vtable,
 		memcpy(vtable->zErrMsg, error_message.c_str(), buffer_size);
 	}
 }
+
+/// End the stream of a cursor, the generator is dropped before its context.
+void stopRows(BaseCursor* pCur)
+{
+	pCur->generator.reset();
+	if (pCur->context != nullptr) {
+		pCur->constraints.swap(pCur->context->constraints);
+		pCur->context.reset();
+	}
+}
+
+/// Pull the next rows of a streaming cursor once the current rows were walked.
+int pullRows(BaseCursor* pCur)
+{
+	while (pCur->row >= pCur->n && pCur->generator != nullptr) {
+		QueryData rows;
+		bool more = false;
+		try {
+			more = pCur->generator->next(rows);
+		} catch (const std::exception& e) {
+			setTableErrorMessage(pCur->base.pVtab,
+								 std::string("Failed to generate rows: ") + e.what());
+			stopRows(pCur);
+			return SQLITE_ERROR;
+		}
+
+		pCur->offset += pCur->n;
+		pCur->rows = tableRowsFromQueryData(std::move(rows));
+		pCur->row = 0;
+		pCur->n = pCur->rows.size();
+
+		if (!more) {
+			stopRows(pCur);
+		}
+	}
+
+	return SQLITE_OK;
+}
 } // namespace
 
 inline std::string table_doc(const std::string& name)
@@ -280,6 +318,12 @@ int xOpen(sqlite3_vtab* tab, sqlite3_vtab_cursor** ppCursor)
 		 ") for table: " + pVtab->content->name);
 	pCur->id = kPlannerCursorID++;
 	pCur->base.pVtab = tab;
+
+	// Set the column affinity for each optional constraint list.
+	// There is a separate list for each column name.
+	for (const auto& column : pVtab->content->columns) {
+		pCur->constraints[std::get<0>(column)].affinity = std::get<1>(column);
+	}
 	*ppCursor = (sqlite3_vtab_cursor*)pCur;
 
 	return SQLITE_OK;
@@ -316,7 +360,7 @@ int xNext(sqlite3_vtab_cursor* cur)
 {
 	BaseCursor* pCur = (BaseCursor*)cur;
 	pCur->row++;
-	return SQLITE_OK;
+	return pullRows(pCur);
 }
 
 int xRowid(sqlite3_vtab_cursor* cur, sqlite_int64* pRowid)
@@ -332,7 +376,7 @@ int xRowid(sqlite3_vtab_cursor* cur, sqlite_int64* pRowid)
 	// Use the rowid returned by the extension, if available; most likely, this
 	// will only be used by extensions providing read/write tables
 	const auto& current_row = *data_it;
-	return current_row->get_rowid(pCur->row, pRowid);
+	return current_row->get_rowid(pCur->offset + pCur->row, pRowid);
 }
 
 int xUpdate(sqlite3_vtab* p,
@@ -487,6 +531,10 @@ int xUpdate(sqlite3_vtab* p,
 		return SQLITE_ERROR;
 	}
 
+	// A write may change what other tables report, e.g. a policy update is
+	// reflected by every table built on the policy, so drop all cached results.
+	TableCache::instance().invalidateAll();
+
 	/*
 	  // INSERT actions must always return a valid rowid to sqlite
 	  if (plugin_request.at("action") == "insert") {
@@ -519,6 +567,50 @@ int xUpdate(sqlite3_vtab* p,
 	return SQLITE_OK;
 }
 
+/// Forward the transaction callbacks of SQLite to the local table plugin.
+template <typename Callback>
+int transaction(sqlite3_vtab* p, Callback&& callback)
+{
+	auto* pVtab = (VirtualTable*)p;
+	const auto& plugin = pVtab->content->plugin;
+	if (plugin == nullptr) {
+		return SQLITE_OK;
+	}
+
+	try {
+		auto status = callback(*plugin);
+		if (status.ok()) {
+			return SQLITE_OK;
+		}
+
+		setTableErrorMessage(p, status.getMessage());
+	} catch (const std::exception& e) {
+		setTableErrorMessage(p, e.what());
+	}
+
+	return SQLITE_ERROR;
+}
+
+int xBegin(sqlite3_vtab* p)
+{
+	return transaction(p, [](TablePlugin& table) { return table.begin(); });
+}
+
+int xSync(sqlite3_vtab* p)
+{
+	return transaction(p, [](TablePlugin& table) { return table.sync(); });
+}
+
+int xCommit(sqlite3_vtab* p)
+{
+	return transaction(p, [](TablePlugin& table) { return table.commit(); });
+}
+
+int xRollback(sqlite3_vtab* p)
+{
+	return transaction(p, [](TablePlugin& table) { return table.rollback(); });
+}
+
 int xCreate(sqlite3* db,
 			void* pAux,
 			int argc,
@@ -635,6 +727,19 @@ int xCreate(sqlite3* db,
 		}
 	}
 
+	// Resolve the filter metadata once, xFilter is called for every scan.
+	auto& content = *pVtab->content;
+	content.options.reserve(content.columns.size());
+	for (size_t i = 0; i < content.columns.size(); i++) {
+		content.options.push_back(std::get<2>(content.columns[i]));
+		content.ordinals.emplace(std::get<0>(content.columns[i]), i);
+	}
+
+	if (Registry::get().exists("table", name, true)) {
+		auto plugin = Registry::get().plugin("table", name);
+		content.plugin = std::dynamic_pointer_cast<TablePlugin>(plugin);
+	}
+
 	// Create the requested 'aliases'.
 	for (const auto& view : views) {
 		statement = "CREATE VIEW " + view + " AS SELECT * FROM " + name;
@@ -791,6 +896,8 @@ static int xBestIndex(sqlite3_vtab* tab, sqlite3_index_info* pIdxInfo)
 	pVtab->content->constraints[pIdxInfo->idxNum] = std::move(constraints);
 	pVtab->content->colsUsed[pIdxInfo->idxNum] = std::move(colsUsed);
 	pVtab->content->colsUsedBitsets[pIdxInfo->idxNum] = colsUsedBitset;
+	// A cached statement restores the set instead of planning again.
+	pVtab->instance->statements().record(pVtab->content, pIdxInfo->idxNum);
 	pIdxInfo->estimatedCost = cost;
 	return SQLITE_OK;
 }
@@ -808,7 +915,11 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
 
 	pCur->row = 0;
 	pCur->n = 0;
-	QueryContext context(content);
+	pCur->offset = 0;
+	stopRows(pCur);
+
+	auto streamContext = std::make_unique<QueryContext>(content);
+	auto& context = *streamContext;
 
 	// The SQLite instance communicates to the TablePlugin via the context.
 	context.useCache(pVtab->instance->useCache());
@@ -829,16 +940,15 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
 	bool events_satisfied =
 		((content->attributes & TableAttributes::EVENT_BASED) == 0);
 
-	std::map<std::string, ColumnOptions> options;
-	for (size_t i = 0; i < content->columns.size(); ++i) {
-		// Set the column affinity for each optional constraint list.
-		// There is a separate list for each column name.
-		auto column_name = std::get<0>(content->columns[i]);
-		context.constraints[column_name].affinity =
-			std::get<1>(content->columns[i]);
-		// Save the column options for comparison within constraints enumeration.
-		options[column_name] = std::get<2>(content->columns[i]);
-		if (options[column_name] & ColumnOptions::REQUIRED) {
+	// Reuse the constraint lists of the cursor, see BaseCursor::constraints.
+	for (auto& constraint : pCur->constraints) {
+		constraint.second.clear();
+	}
+	context.constraints.swap(pCur->constraints);
+
+	const auto& options = content->options;
+	for (const auto& option : options) {
+		if (option & ColumnOptions::REQUIRED) {
 			required_satisfied = false;
 		}
 	}
@@ -878,7 +988,9 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
 		// Evaluate index and optimized constraint requirements.
 		// These are satisfied regardless of expression content availability.
 		for (const auto& constraint : constraints) {
-			if (options[constraint.first] & ColumnOptions::REQUIRED) {
+			auto ordinal = content->ordinals.find(constraint.first);
+			if (ordinal != content->ordinals.end() &&
+				(options[ordinal->second] & ColumnOptions::REQUIRED)) {
 				// A required option exists in the constraints.
 				required_satisfied = true;
 			}
@@ -916,14 +1028,18 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
 
 	// Reset the virtual table contents.
 	pCur->rows.clear();
-	options.clear();
 
 	// Generate the row data set.
 	plan("Scanning rows for cursor (" + std::to_string(pCur->id) + ")");
-	if (Registry::get().exists("table", pVtab->content->name, true)) {
-		auto plugin = Registry::get().plugin("table", pVtab->content->name);
-		auto table = std::dynamic_pointer_cast<TablePlugin>(plugin);
-		pCur->rows = tableRowsFromQueryData(table->select(context));
+	if (content->plugin != nullptr) {
+		const auto& table = content->plugin;
+		if (!table->getCache(context, pCur->rows)) {
+			pCur->generator = table->generate(context);
+			if (pCur->generator == nullptr) {
+				pCur->rows = tableRowsFromQueryData(table->select(context));
+				table->setCache(context, pCur->rows);
+			}
+		}
 	} else {
 		PluginRequest request = {{"action", "select"}};
 		TablePlugin::setRequestFromContext(context, request);
@@ -932,6 +1048,15 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
 		pCur->rows = tableRowsFromQueryData(std::move(qd));
 	}
 
+	if (pCur->generator != nullptr) {
+		// The generator uses the context until the stream ends.
+		pCur->context = std::move(streamContext);
+		return pullRows(pCur);
+	}
+
+	// Give the constraint lists back to the cursor for the next filter.
+	pCur->constraints.swap(context.constraints);
+
 	// Set the number of rows.
 	pCur->n = pCur->rows.size();
 	return SQLITE_OK;
@@ -963,6 +1088,10 @@ struct sqlite3_module* getVirtualTableModule(const std::string& table_name,
 	sqlite_module_map[table_name].xColumn = tables::sqlite::xColumn;
 	sqlite_module_map[table_name].xRowid = tables::sqlite::xRowid;
 	sqlite_module_map[table_name].xUpdate = tables::sqlite::xUpdate;
+	sqlite_module_map[table_name].xBegin = tables::sqlite::xBegin;
+	sqlite_module_map[table_name].xSync = tables::sqlite::xSync;
+	sqlite_module_map[table_name].xCommit = tables::sqlite::xCommit;
+	sqlite_module_map[table_name].xRollback = tables::sqlite::xRollback;
 
 	// Allow the table to receive INSERT/UPDATE/DROP events if it is
 	// implemented from an extension and is overwriting the right methods
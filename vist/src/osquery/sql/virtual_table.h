@@ -51,6 +51,23 @@ public:
 
 	/// Total number of rows.
 	size_t n{0};
+
+	/// Number of the streamed rows before the current ones.
+	size_t offset{0};
+
+	/**
+	 * @brief Constraint lists of every column, built when the cursor is opened.
+	 *
+	 * The lists are cleared and lent to the QueryContext on each filter, so
+	 * that re-filtering the cursor in a join does not rebuild the map.
+	 */
+	ConstraintMap constraints;
+
+	/// Context of the streaming filter, it outlives the generator.
+	std::unique_ptr<QueryContext> context;
+
+	/// Generator of the rows after the current ones, see TablePlugin::generate.
+	std::unique_ptr<RowGenerator> generator;
 };
 
 /**
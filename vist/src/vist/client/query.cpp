@@ -41,4 +41,16 @@ Rows Query::Execute(const std::string& statement)
 	return rows;
 }
 
+ResultSet Query::Fetch(const std::string& statement)
+{
+	INFO(VIST_CLIENT) << "Query execution: " << statement;
+	rmi::Remote remote(SOCK_ADDR);
+
+	auto fetch = REMOTE_METHOD(remote, &Vistd::fetch);
+	auto result = fetch.invoke<ResultSet>(statement);
+
+	DEBUG(VIST_CLIENT) << "Result's size: " << result.size();
+	return result;
+}
+
 } // namespace vist
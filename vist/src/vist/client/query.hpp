@@ -16,17 +16,16 @@
 
 #pragma once
 
-#include <map>
+#include <vist/result-set.hpp>
+
 #include <string>
-#include <vector>
 
 namespace vist {
 
-using Row = std::map<std::string, std::string>;
-using Rows = std::vector<Row>;
-
 struct Query final {
 	static Rows Execute(const std::string& statement);
+	/// Same as Execute() but the result is transported column by column.
+	static ResultSet Fetch(const std::string& statement);
 };
 
 } // namespace vist
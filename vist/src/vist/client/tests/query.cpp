@@ -80,3 +80,26 @@ TEST(QueryTests, admin_activation)
 	rows = Query::Execute("DELETE FROM policy_admin WHERE name = 'testAdmin'");
 	EXPECT_EQ(rows.size(), 0);
 }
+
+TEST(QueryTests, fetch)
+{
+	auto rows = Query::Execute("SELECT * FROM policy");
+	auto result = Query::Fetch("SELECT * FROM policy");
+
+	EXPECT_EQ(result.size(), rows.size());
+	EXPECT_EQ(result.rows(), rows);
+
+	auto& names = result.column<std::string>("name");
+	EXPECT_EQ(names.size(), rows.size());
+	for (std::size_t i = 0; i < names.size(); i++)
+		EXPECT_EQ(names[i], rows[i]["name"]);
+}
+
+TEST(QueryTests, fetch_typed)
+{
+	auto result = Query::Fetch("SELECT * FROM policy_admin");
+	EXPECT_EQ(result.size(), 1);
+	EXPECT_EQ(result.type(result.ordinal("activated")), ResultSet::Type::Integer);
+	EXPECT_EQ(result.column<long long>("activated").front(), 0);
+	EXPECT_EQ(result.column<std::string>("name").front(), "vist-cli");
+}
@@ -77,3 +77,23 @@ TEST(VirtualTableTests, policy_str_filter)
 	EXPECT_TRUE(!value.empty());
 	EXPECT_EQ(row[&Policy<std::string>::name], "sample_str_policy");
 }
+
+TEST(VirtualTableTests, policy_row_decode)
+{
+	VirtualRow<Policy<int>> row({{"name", "sample_int_policy"}, {"value", "I/7"}});
+	EXPECT_EQ(row.size(), 2);
+	EXPECT_EQ(row[&Policy<int>::name], "sample_int_policy");
+	EXPECT_EQ(row[&Policy<int>::value], 7);
+
+	/// Fields are read without copy.
+	EXPECT_EQ(&row.at(&Policy<int>::name), &row[&Policy<int>::name]);
+
+	using KeyValuePair = VirtualRow<Policy<int>>::KeyValuePair;
+	EXPECT_THROW(VirtualRow<Policy<int>>(KeyValuePair {{"name", "sample_str_policy"},
+													   {"value", "S/text"}}),
+				 vist::Exception<ErrCode>);
+
+	VirtualRow<Policy<int>> empty(KeyValuePair {});
+	EXPECT_EQ(empty.size(), 0);
+	EXPECT_THROW(empty[&Policy<int>::value], vist::Exception<ErrCode>);
+}
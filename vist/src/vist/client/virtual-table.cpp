@@ -23,10 +23,9 @@
 #include <vist/schema/policy.hpp>
 #include <vist/stringfy.hpp>
 
-#include <boost/lexical_cast.hpp>
-
 namespace {
 
+using namespace vist;
 using namespace vist::tsqb;
 using namespace vist::schema;
 
@@ -38,95 +37,91 @@ Table policyStr { "policy", Column("name", &Policy<std::string>::name),
 
 Database metaDB { "db", policyInt, policyStr };
 
-} // anonymous namespace
-
-namespace vist {
+const std::size_t PolicyColumns = 2;
 
-template <typename T>
-VirtualRow<T>::VirtualRow()
+bool hasType(const std::string& value, Stringify::Type type)
 {
-	auto results = Query::Execute(metaDB.selectAll<T>());
-	if (results.size() > 0)
-		this->data = std::move(results[0]);
+	return value.size() >= 2 && value[0] == static_cast<char>(type) && value[1] == '/';
 }
 
+/// Decode a row once. Return false if the type of value is unmatched.
 template <typename T>
-VirtualRow<T>::VirtualRow(KeyValuePair&& kvp) : data(std::move(kvp))
+bool decode(std::string&& name, std::string&& value, T& row);
+
+template <>
+bool decode(std::string&& name, std::string&& value, Policy<int>& row)
 {
+	if (!hasType(value, Stringify::Type::Integer))
+		return false;
+
+	row.name = std::move(name);
+	row.value = Stringify::Restore(value);
+	return true;
 }
 
-template <typename T>
-template<typename Struct, typename Member>
-Member VirtualRow<T>::at(Member Struct::* field) const
+template <>
+bool decode(std::string&& name, std::string&& value, Policy<std::string>& row)
 {
-	if (this->data.size() == 0)
-		THROW(ErrCode::RuntimeError) << "Data is not exist.";
-
-	/// TODO: Refactor
-	Column anonymous("anonymous", field);
-	std::string key = metaDB.getColumnName(anonymous);
-	if (key.empty())
-		THROW(ErrCode::RuntimeError) << "Column is not exist.";
-
-	/// Convert "table.column" to "column"
-	std::size_t pos = key.find(".");
-	if (pos != std::string::npos && pos != key.size() - 1)
-		key = key.substr(pos + 1);
-
-	std::string value = this->data.at(key);
-	if (value.empty()) {
-		ERROR(VIST) << "The value of column[" << key << "] is empty.";
-		return Member();
-	}
+	if (!hasType(value, Stringify::Type::String))
+		return false;
+
+	/// The value is kept as dumped.
+	row.name = std::move(name);
+	row.value = std::move(value);
+	return true;
+}
+
+} // anonymous namespace
 
-	if (std::is_same<T, Policy<int>>::value && key == "value")
-		return static_cast<Member>(Stringify::Restore(value));
+namespace vist {
 
-	try {
-		return boost::lexical_cast<Member>(value);
-	} catch (...) {
-		THROW(ErrCode::BadCast) << "Failed to casting [key]: " << key;
-		return Member();
+template <typename T>
+VirtualRow<T>::VirtualRow()
+{
+	auto results = Query::Execute(metaDB.selectAll<T>());
+	for (auto& row : results) {
+		if (decode(std::move(row["name"]), std::move(row["value"]), this->data)) {
+			this->columns = PolicyColumns;
+			return;
+		}
 	}
 }
 
 template <typename T>
-template <typename Struct, typename Member>
-Member VirtualRow<T>::operator[](Member Struct::*field) const
+VirtualRow<T>::VirtualRow(KeyValuePair&& kvp)
 {
-	return this->at(field);
+	if (kvp.empty())
+		return;
+
+	if (!decode(std::move(kvp["name"]), std::move(kvp["value"]), this->data))
+		THROW(ErrCode::TypeUnsafed) << "Type is not safed.";
+
+	this->columns = PolicyColumns;
 }
 
 template <typename T>
 VirtualTable<T>::VirtualTable()
 {
-	auto results = Query::Execute(metaDB.selectAll<T>());
-	for (auto& row : results) {
-		/// Filter unsafe(unmatched) type
-		if (std::is_same<T, Policy<int>>::value && row["value"].find("I/") == std::string::npos)
-			continue;
-		else if (std::is_same<T, Policy<std::string>>::value &&
-				 row["value"].find("S/") == std::string::npos)
-			continue;
+	auto results = Query::Fetch(metaDB.selectAll<T>());
+	if (results.empty())
+		return;
+
+	auto name = results.ordinal("name");
+	auto value = results.ordinal("value");
 
-		this->rows.emplace_back(VirtualRow<T>(std::move(row)));
+	this->rows.reserve(results.size());
+	for (std::size_t i = 0; i < results.size(); i++) {
+		/// Filter unsafe(unmatched) type
+		T row;
+		if (decode(results.text(i, name), results.text(i, value), row))
+			this->rows.emplace_back(VirtualRow<T>(std::move(row), PolicyColumns));
 	}
 }
 
 template class VirtualTable<Policy<int>>;
 template class VirtualRow<Policy<int>>;
-/// name column
-template std::string VirtualRow<Policy<int>>::at(std::string Policy<int>::*) const;
-template std::string VirtualRow<Policy<int>>::operator[](std::string Policy<int>::*) const;
-/// value<T> column
-template int VirtualRow<Policy<int>>::at(int Policy<int>::*) const;
-template int VirtualRow<Policy<int>>::operator[](int Policy<int>::*) const;
 
 template class VirtualTable<Policy<std::string>>;
 template class VirtualRow<Policy<std::string>>;
-template
-std::string VirtualRow<Policy<std::string>>::at(std::string Policy<std::string>::*) const;
-template
-std::string VirtualRow<Policy<std::string>>::operator[](std::string Policy<std::string>::*) const;
 
 } // namespace vist
@@ -20,31 +20,64 @@
 
 #include <map>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace vist {
 
+template <typename T>
+class VirtualTable;
+
+/// The row keeps the values decoded as T when the result arrives,
+/// so reading a field is a member access without conversion.
+/// The type of the value is checked once when the row is made.
 template <typename T>
 class VirtualRow final {
 public:
 	using KeyValuePair = std::map<std::string, std::string>;
 
+	/// Load the first row of which value has the type of T.
+	/// Rows of other types are skipped, not the first row of the table.
+	/// The row is empty if there is no such row.
 	explicit VirtualRow();
+
+	/// Throws ErrCode::TypeUnsafed if the value doesn't have the type of T.
+	/// An empty map makes an empty row.
 	explicit VirtualRow(KeyValuePair&&);
 
+	/// Returns the reference to the decoded member, which is valid
+	/// while the row lives. Copy it to keep it longer.
+	/// Throws ErrCode::RuntimeError if the row is empty.
 	template<typename Struct, typename Member>
-	Member at(Member Struct::*) const;
+	const Member& at(Member Struct::* field) const
+	{
+		static_assert(std::is_base_of_v<Struct, T>, "Not a column of the row.");
+
+		if (this->columns == 0)
+			THROW(ErrCode::RuntimeError) << "Data is not exist.";
+
+		return this->data.*field;
+	}
 
 	template<typename Struct, typename Member>
-	Member operator[](Member Struct::*) const;
+	const Member& operator[](Member Struct::* field) const
+	{
+		return this->at(field);
+	}
 
 	inline std::size_t size() const
 	{
-		return data.size();
+		return columns;
 	}
 
 private:
-	KeyValuePair data;
+	VirtualRow(T&& data, std::size_t columns) noexcept :
+		data(std::move(data)), columns(columns) {}
+
+	T data {};
+	std::size_t columns = 0;
+
+	friend class VirtualTable<T>;
 };
 
 template <typename T>
@@ -24,9 +24,8 @@ namespace vist {
 
 Archive& Archive::operator<<(const Archive& archive)
 {
-	auto data = archive.buffer;
-	auto index = archive.current;
-	std::copy(data.begin() + index, data.end(), std::back_inserter(this->buffer));
+	const auto& data = archive.buffer;
+	this->buffer.insert(this->buffer.end(), data.begin() + archive.current, data.end());
 
 	return *this;
 }
@@ -42,9 +41,8 @@ Archive& Archive::operator<<(const std::string& value)
 
 Archive& Archive::operator>>(Archive& archive)
 {
-	auto data = this->buffer;
-	auto index = this->current;
-	std::copy(data.begin() + index, data.end(), std::back_inserter(archive.buffer));
+	const auto& data = this->buffer;
+	archive.buffer.insert(archive.buffer.end(), data.begin() + this->current, data.end());
 
 	return *this;
 }
@@ -82,9 +80,8 @@ void Archive::resize(std::size_t size)
 
 void Archive::save(const void* bytes, std::size_t size)
 {
-	auto binary = reinterpret_cast<unsigned char*>(const_cast<void*>(bytes));
-	std::vector<unsigned char> next(binary, binary + size);
-	std::copy(next.begin(), next.end(), std::back_inserter(this->buffer));
+	auto binary = reinterpret_cast<const unsigned char*>(bytes);
+	this->buffer.insert(this->buffer.end(), binary, binary + size);
 }
 
 void Archive::load(void* bytes, std::size_t size)
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+#include <gtest/gtest.h>
+
+#include <vist/archive.hpp>
+#include <vist/result-set.hpp>
+
+using namespace vist;
+
+namespace {
+
+ResultSet make()
+{
+	ResultSet result;
+	result.setNames({"id", "ratio", "name", "mixed", "nullable"});
+
+	result.append(0, 1LL);
+	result.append(1, 0.0);
+	result.append(2, std::string("first"));
+	result.append(3, 10LL);
+	result.appendNull(4);
+
+	result.append(0, 2LL);
+	result.append(1, 1.5);
+	result.append(2, std::string("second"));
+	result.append(3, std::string("text"));
+	result.append(4, 7LL);
+
+	return result;
+}
+
+} // anonymous namespace
+
+TEST(ResultSetTests, typed_column)
+{
+	auto result = make();
+	EXPECT_EQ(result.size(), 2);
+
+	EXPECT_EQ(result.type(0), ResultSet::Type::Integer);
+	EXPECT_EQ(result.column<long long>("id"), std::vector<long long>({1, 2}));
+
+	EXPECT_EQ(result.type(1), ResultSet::Type::Real);
+	EXPECT_EQ(result.column<double>("ratio"), std::vector<double>({0.0, 1.5}));
+
+	EXPECT_EQ(result.type(2), ResultSet::Type::Text);
+	EXPECT_EQ(result.column<std::string>("name").back(), "second");
+
+	EXPECT_THROW(result.column<std::string>("id"), vist::Exception<ErrCode>);
+	EXPECT_THROW(result.ordinal("unknown"), vist::Exception<ErrCode>);
+}
+
+TEST(ResultSetTests, text_fallback)
+{
+	auto result = make();
+
+	EXPECT_EQ(result.type(3), ResultSet::Type::Text);
+	EXPECT_EQ(result.column<std::string>("mixed"), std::vector<std::string>({"10", "text"}));
+
+	EXPECT_EQ(result.type(4), ResultSet::Type::Text);
+	EXPECT_EQ(result.column<std::string>("nullable"), std::vector<std::string>({"", "7"}));
+}
+
+TEST(ResultSetTests, rows)
+{
+	auto rows = make().rows();
+	EXPECT_EQ(rows.size(), 2);
+	EXPECT_EQ(rows[0]["id"], "1");
+	EXPECT_EQ(rows[0]["ratio"], "0.0");
+	EXPECT_EQ(rows[1]["ratio"], "1.5");
+	EXPECT_EQ(rows[1]["mixed"], "text");
+	EXPECT_EQ(rows[0]["nullable"], "");
+}
+
+TEST(ResultSetTests, archive)
+{
+	auto input = make();
+
+	Archive archive;
+	archive << input;
+
+	ResultSet output;
+	archive >> output;
+
+	EXPECT_EQ(output.getNames(), input.getNames());
+	EXPECT_EQ(output.rows(), input.rows());
+	EXPECT_EQ(output.column<long long>("id"), input.column<long long>("id"));
+}
@@ -63,6 +63,11 @@ public:
 		this->exec("END TRANSACTION;");
 	}
 
+	void transactionRollback()
+	{
+		this->exec("ROLLBACK TRANSACTION;");
+	}
+
 	int getErrorCode() const
 	{
 		return ::sqlite3_errcode(handle);
@@ -16,9 +16,7 @@
 
 #pragma once
 
-#include <vist/json/util.hpp>
 #include <vist/json/value.hpp>
-#include <vist/string.hpp>
 
 #include <string>
 #include <vector>
@@ -60,42 +58,26 @@ struct Array : public Value {
 		return *(this->buffer[index]);
 	}
 
-	std::string serialize() const override
+	using Value::dump;
+
+	void dump(std::string& out) const override
 	{
-		std::stringstream ss;
-		ss << "[ ";
+		out += "[ ";
 
 		std::size_t i = 0;
-		for (const auto& value : buffer) {
-			ss << value->serialize();
+		for (const auto& value : this->buffer) {
+			value->dump(out);
 
-			if (i++ < buffer.size() - 1)
-				ss << ",";
+			if (i++ < this->buffer.size() - 1)
+				out += ",";
 
-			ss << " ";
+			out += " ";
 		}
-		ss << "]";
-
-		return ss.str();
+		out += "]";
 	}
 
-	void deserialize(const std::string& dumped) override
-	{
-		if (dumped.empty())
-			throw std::invalid_argument("Dumped value cannot empty.");
-
-		auto stripped = strip(trim(dumped), '[', ']');
-		if (trim(stripped).empty())
-			return;
-
-		auto divided = split(stripped, ",");
-		auto tokens = canonicalize(divided);
-		for (const auto& token : tokens) {
-			auto value = std::make_shared<Value>();
-			value->deserialize(trim(token));
-			this->buffer.emplace_back(std::move(value));
-		}
-	}
+	/// Defined in builder.hpp.
+	void deserialize(const std::string& dumped) override;
 
 	std::size_t size() const noexcept
 	{
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * Reader handler which builds the composite values.
+ * The deserializers of the composite values are defined here.
+ */
+
+#pragma once
+
+#include <vist/json/array.hpp>
+#include <vist/json/object.hpp>
+#include <vist/json/reader.hpp>
+#include <vist/json/value.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vist {
+namespace json {
+
+class Builder final {
+public:
+	static std::shared_ptr<Value> Build(const std::string& dumped)
+	{
+		if (dumped.empty())
+			throw std::invalid_argument("Dumped value cannot empty.");
+
+		Builder builder;
+		Reader<Builder>::Parse(dumped, builder);
+		return std::move(builder.root);
+	}
+
+	void onNull()
+	{
+		this->add(std::make_shared<Null>());
+	}
+
+	void onBool(bool data)
+	{
+		this->add(std::make_shared<Bool>(data));
+	}
+
+	void onInt(long long data)
+	{
+		this->add(std::make_shared<Int>(data));
+	}
+
+	void onDouble(double data)
+	{
+		this->add(std::make_shared<Double>(data));
+	}
+
+	void onString(std::string&& data)
+	{
+		this->add(std::make_shared<String>(std::move(data)));
+	}
+
+	void onKey(std::string&& key)
+	{
+		this->stack.back().key = std::move(key);
+	}
+
+	void onStartObject()
+	{
+		auto object = std::make_shared<Object>();
+		Frame frame {nullptr, object.get(), {}};
+		this->add(std::move(object));
+		this->stack.emplace_back(std::move(frame));
+	}
+
+	void onEndObject()
+	{
+		this->stack.pop_back();
+	}
+
+	void onStartArray()
+	{
+		auto array = std::make_shared<Array>();
+		Frame frame {array.get(), nullptr, {}};
+		this->add(std::move(array));
+		this->stack.emplace_back(std::move(frame));
+	}
+
+	void onEndArray()
+	{
+		this->stack.pop_back();
+	}
+
+private:
+	struct Frame {
+		Array* array;
+		Object* object;
+		std::string key;
+	};
+
+	void add(std::shared_ptr<Value> leaf)
+	{
+		if (this->stack.empty()) {
+			this->root = std::move(leaf);
+			return;
+		}
+
+		auto value = std::make_shared<Value>();
+		value->leaf = std::move(leaf);
+
+		auto& top = this->stack.back();
+		if (top.array != nullptr)
+			top.array->buffer.emplace_back(std::move(value));
+		else
+			top.object->pairs[std::move(top.key)] = std::move(value);
+	}
+
+	std::shared_ptr<Value> root;
+	std::vector<Frame> stack;
+};
+
+inline void Value::deserialize(const std::string& dumped)
+{
+	this->leaf = Builder::Build(dumped);
+}
+
+inline void String::deserialize(const std::string& dumped)
+{
+	auto built = std::dynamic_pointer_cast<String>(Builder::Build(dumped));
+	if (built == nullptr)
+		throw std::invalid_argument("Wrong format.");
+
+	this->data = std::move(built->data);
+}
+
+inline void Array::deserialize(const std::string& dumped)
+{
+	auto built = std::dynamic_pointer_cast<Array>(Builder::Build(dumped));
+	if (built == nullptr)
+		throw std::invalid_argument("Wrong format.");
+
+	for (auto& value : built->buffer)
+		this->buffer.emplace_back(std::move(value));
+}
+
+inline void Object::deserialize(const std::string& dumped)
+{
+	auto built = std::dynamic_pointer_cast<Object>(Builder::Build(dumped));
+	if (built == nullptr)
+		throw std::invalid_argument("Wrong format.");
+
+	if (this->pairs.empty()) {
+		this->pairs = std::move(built->pairs);
+		return;
+	}
+
+	for (auto& [key, value] : built->pairs)
+		this->pairs[key] = std::move(value);
+}
+
+} // namespace json
+} // namespace vist
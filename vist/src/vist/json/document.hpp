@@ -0,0 +1,486 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * Read-only JSON document backed by an arena.
+ *   - All nodes live in one vector as tagged values,
+ *     all strings (keys and values) live in one string buffer.
+ *   - Node is a lightweight view which is valid while the document lives.
+ *   - Object keys keep the order of the text.
+ */
+/*
+ * Usage:
+ *     auto document = Document::Parse("{\"values\": [1, \"two\"]}");
+ *     auto values = document.root()["values"];
+ *     int one = values.at(0).get<int>();
+ *     std::string_view two = values.at(1).get<std::string_view>();
+ *
+ *     for (auto value : values)
+ *       value.type();
+ *
+ *     std::string buffer;
+ *     document.dump(buffer);
+ */
+
+#pragma once
+
+#include <vist/json/reader.hpp>
+#include <vist/json/util.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace vist {
+namespace json {
+
+class Document final {
+public:
+	enum class Type : unsigned char {
+		Null,
+		Bool,
+		Int,
+		Double,
+		String,
+		Array,
+		Object
+	};
+
+	class Node;
+
+	static Document Parse(const std::string& text)
+	{
+		Document document;
+		Handler handler(document);
+		Reader<Handler>::Parse(text, handler);
+		return document;
+	}
+
+	inline Node root() const;
+
+	std::size_t size() const noexcept
+	{
+		return this->nodes.size();
+	}
+
+	std::string dump() const
+	{
+		std::string buffer;
+		this->dump(buffer);
+		return buffer;
+	}
+
+	/// Append the serialized document to buffer, which can be reused.
+	void dump(std::string& buffer) const
+	{
+		if (!this->nodes.empty())
+			this->dump(buffer, 0);
+	}
+
+	[[deprecated("Use dump().")]]
+	std::string serialize() const
+	{
+		return this->dump();
+	}
+
+	[[deprecated("Use dump(buffer) on the cleared buffer.")]]
+	void serialize(std::string& buffer) const
+	{
+		buffer.clear();
+		this->dump(buffer);
+	}
+
+private:
+	static constexpr std::uint32_t None = std::numeric_limits<std::uint32_t>::max();
+
+	struct Entry {
+		Type type;
+		bool boolean = false;
+		union {
+			long long integer;
+			double real;
+			std::uint32_t offset;	///< String: position in strings
+			std::uint32_t first;	///< Array, Object: the first child
+		};
+		std::uint32_t size = 0;		///< String: length, Array, Object: children
+		std::uint32_t next = None;	///< The next sibling
+		std::uint32_t key = None;	///< Object member: position of key in strings
+		std::uint32_t keySize = 0;
+		std::uint32_t children = None;	///< Array, Object: position in children
+	};
+
+	/// Reader handler which appends entries in a single pass.
+	class Handler final {
+	public:
+		explicit Handler(Document& document) : document(document) {}
+
+		void onNull()
+		{
+			this->add(Type::Null);
+		}
+
+		void onBool(bool data)
+		{
+			this->document.nodes[this->add(Type::Bool)].boolean = data;
+		}
+
+		void onInt(long long data)
+		{
+			this->document.nodes[this->add(Type::Int)].integer = data;
+		}
+
+		void onDouble(double data)
+		{
+			this->document.nodes[this->add(Type::Double)].real = data;
+		}
+
+		void onString(std::string&& data)
+		{
+			auto offset = this->document.intern(data);
+			auto& entry = this->document.nodes[this->add(Type::String)];
+			entry.offset = offset;
+			entry.size = static_cast<std::uint32_t>(data.size());
+		}
+
+		void onKey(std::string&& key)
+		{
+			this->key = this->document.intern(key);
+			this->keySize = static_cast<std::uint32_t>(key.size());
+		}
+
+		void onStartObject()
+		{
+			this->open(Type::Object);
+		}
+
+		void onEndObject()
+		{
+			this->close();
+		}
+
+		void onStartArray()
+		{
+			this->open(Type::Array);
+		}
+
+		void onEndArray()
+		{
+			this->close();
+		}
+
+	private:
+		struct Frame {
+			std::uint32_t node;
+			std::uint32_t last;
+		};
+
+		void open(Type type)
+		{
+			auto index = this->add(type);
+			this->document.nodes[index].first = None;
+			this->stack.push_back({index, None});
+		}
+
+		/// Index the children of a closed composite at once, so that at()
+		/// doesn't walk the siblings. Nested ones are closed earlier,
+		/// hence the children of each composite are contiguous.
+		void close()
+		{
+			auto& document = this->document;
+			auto& parent = document.nodes[this->stack.back().node];
+			parent.children = static_cast<std::uint32_t>(document.children.size());
+			for (auto index = parent.first; index != None; index = document.nodes[index].next)
+				document.children.push_back(index);
+
+			this->stack.pop_back();
+		}
+
+		std::uint32_t add(Type type)
+		{
+			auto& nodes = this->document.nodes;
+			if (nodes.size() >= None)
+				throw std::length_error("Too many nodes.");
+
+			auto index = static_cast<std::uint32_t>(nodes.size());
+			Entry entry;
+			entry.type = type;
+			entry.integer = 0;
+			nodes.push_back(entry);
+
+			if (this->stack.empty())
+				return index;
+
+			auto& frame = this->stack.back();
+			auto& parent = nodes[frame.node];
+			if (parent.type == Type::Object) {
+				nodes[index].key = this->key;
+				nodes[index].keySize = this->keySize;
+			}
+
+			if (frame.last == None)
+				parent.first = index;
+			else
+				nodes[frame.last].next = index;
+
+			frame.last = index;
+			parent.size++;
+
+			return index;
+		}
+
+		Document& document;
+		std::vector<Frame> stack;
+		std::uint32_t key = None;
+		std::uint32_t keySize = 0;
+	};
+
+	std::uint32_t intern(const std::string& data)
+	{
+		if (this->strings.size() + data.size() >= None)
+			throw std::length_error("Too large document.");
+
+		auto offset = static_cast<std::uint32_t>(this->strings.size());
+		this->strings += data;
+		return offset;
+	}
+
+	std::string_view text(std::uint32_t offset, std::uint32_t size) const
+	{
+		return std::string_view(this->strings.data() + offset, size);
+	}
+
+	inline void dump(std::string& out, std::uint32_t index) const;
+
+	std::vector<Entry> nodes;
+	std::vector<std::uint32_t> children;
+	std::string strings;
+};
+
+class Document::Node final {
+public:
+	class Iterator final {
+	public:
+		Iterator(const Document* document, std::uint32_t index) :
+			document(document), index(index) {}
+
+		Node operator*() const
+		{
+			return Node(this->document, this->index);
+		}
+
+		Iterator& operator++()
+		{
+			this->index = this->document->nodes[this->index].next;
+			return *this;
+		}
+
+		bool operator!=(const Iterator& rhs) const noexcept
+		{
+			return this->index != rhs.index;
+		}
+
+	private:
+		const Document* document;
+		std::uint32_t index;
+	};
+
+	Type type() const
+	{
+		return this->entry().type;
+	}
+
+	bool is(Type type) const
+	{
+		return this->type() == type;
+	}
+
+	/// The number of children (Array, Object).
+	std::size_t size() const
+	{
+		const auto& entry = this->entry();
+		if (entry.type != Type::Array && entry.type != Type::Object)
+			throw std::runtime_error("Mismatched type.");
+
+		return entry.size;
+	}
+
+	/// The key of object member.
+	std::string_view key() const
+	{
+		const auto& entry = this->entry();
+		if (entry.key == None)
+			throw std::runtime_error("Not object member.");
+
+		return this->document->text(entry.key, entry.keySize);
+	}
+
+	Node at(std::size_t index) const
+	{
+		if (index >= this->size())
+			throw std::invalid_argument("Wrong index.");
+
+		return Node(this->document, this->document->children[this->entry().children + index]);
+	}
+
+	bool exist(std::string_view key) const
+	{
+		return this->find(key) != None;
+	}
+
+	Node operator[](std::string_view key) const
+	{
+		auto index = this->find(key);
+		if (index == None)
+			throw std::runtime_error("Not exist key.");
+
+		return Node(this->document, index);
+	}
+
+	/// T: bool, int, long long, double, std::string, std::string_view
+	template <typename T>
+	T get() const
+	{
+		const auto& entry = this->entry();
+		if constexpr(std::is_same_v<T, bool>) {
+			this->expect(Type::Bool);
+			return entry.boolean;
+		} else if constexpr(std::is_same_v<T, long long>) {
+			this->expect(Type::Int);
+			return entry.integer;
+		} else if constexpr(std::is_same_v<T, int>) {
+			this->expect(Type::Int);
+			if (entry.integer < std::numeric_limits<int>::min() ||
+				entry.integer > std::numeric_limits<int>::max())
+				throw std::out_of_range("Out of range.");
+			return static_cast<int>(entry.integer);
+		} else if constexpr(std::is_same_v<T, double>) {
+			if (entry.type == Type::Int)
+				return static_cast<double>(entry.integer);
+			this->expect(Type::Double);
+			return entry.real;
+		} else if constexpr(std::is_same_v<T, std::string_view> ||
+							std::is_same_v<T, std::string>) {
+			this->expect(Type::String);
+			return T(this->document->text(entry.offset, entry.size));
+		} else {
+			static_assert(std::is_void_v<T> && !std::is_void_v<T>, "Not supported type.");
+		}
+	}
+
+	Iterator begin() const
+	{
+		const auto& entry = this->entry();
+		bool composite = entry.type == Type::Array || entry.type == Type::Object;
+		return Iterator(this->document, composite ? entry.first : None);
+	}
+
+	Iterator end() const
+	{
+		return Iterator(this->document, None);
+	}
+
+private:
+	friend class Document;
+
+	Node(const Document* document, std::uint32_t index) :
+		document(document), index(index) {}
+
+	const Entry& entry() const
+	{
+		return this->document->nodes.at(this->index);
+	}
+
+	void expect(Type type) const
+	{
+		if (this->type() != type)
+			throw std::runtime_error("Mismatched type.");
+	}
+
+	std::uint32_t find(std::string_view key) const
+	{
+		if (this->type() != Type::Object)
+			throw std::runtime_error("Mismatched type.");
+
+		for (auto index = this->entry().first; index != None;) {
+			const auto& child = this->document->nodes[index];
+			if (this->document->text(child.key, child.keySize) == key)
+				return index;
+			index = child.next;
+		}
+
+		return None;
+	}
+
+	const Document* document;
+	std::uint32_t index;
+};
+
+inline Document::Node Document::root() const
+{
+	if (this->nodes.empty())
+		throw std::runtime_error("Empty document.");
+
+	return Node(this, 0);
+}
+
+inline void Document::dump(std::string& out, std::uint32_t index) const
+{
+	const auto& entry = this->nodes[index];
+	switch (entry.type) {
+	case Type::Null:
+		out += "null";
+		break;
+	case Type::Bool:
+		out += entry.boolean ? "true" : "false";
+		break;
+	case Type::Int:
+		out += std::to_string(entry.integer);
+		break;
+	case Type::Double:
+		writeDouble(out, entry.real);
+		break;
+	case Type::String:
+		writeString(out, this->text(entry.offset, entry.size));
+		break;
+	case Type::Array:
+	case Type::Object: {
+		bool object = entry.type == Type::Object;
+		out += object ? "{ " : "[ ";
+		for (auto child = entry.first; child != None;) {
+			const auto& current = this->nodes[child];
+			if (object) {
+				writeString(out, this->text(current.key, current.keySize));
+				out += ": ";
+			}
+
+			this->dump(out, child);
+
+			child = current.next;
+			if (child != None)
+				out += ",";
+			out += " ";
+		}
+		out += object ? "}" : "]";
+		break;
+	}
+	}
+}
+
+} // namespace json
+} // namespace vist
@@ -19,6 +19,8 @@
  *     - Component structure: Value
  *     - Leaf structure: Int, String, Bool, Null
  *     - Composite structure: Array, Object
+ *   - Parsing is done by the single-pass Reader. (SAX style)
+ *   - Document is the read-only, arena backed alternative for large text.
  */
 /*
  * Usage:
@@ -32,17 +34,18 @@
  *     int age = json["age"];
  *
  *     // Serialize json value
- *     std::string serialized = json.serialize();
+ *     std::string serialized = json.dump();
  */
 
 #pragma once
 
 #include <vist/json/array.hpp>
+#include <vist/json/builder.hpp>
+#include <vist/json/document.hpp>
 #include <vist/json/object.hpp>
+#include <vist/json/reader.hpp>
 #include <vist/json/value.hpp>
-#include <vist/string.hpp>
 
-#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -102,9 +105,28 @@ struct Json {
 		return this->root.exist(key);
 	}
 
+	std::string dump() const
+	{
+		return this->root.dump();
+	}
+
+	/// Append the serialized value to buffer, which can be reused.
+	void dump(std::string& buffer) const
+	{
+		this->root.dump(buffer);
+	}
+
+	[[deprecated("Use dump().")]]
 	std::string serialize() const
 	{
-		return this->root.serialize();
+		return this->dump();
+	}
+
+	[[deprecated("Use dump(buffer) on the cleared buffer.")]]
+	void serialize(std::string& buffer) const
+	{
+		buffer.clear();
+		this->dump(buffer);
 	}
 
 	void deserialize(const std::string& dumped)
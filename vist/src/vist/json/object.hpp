@@ -18,7 +18,6 @@
 
 #include <vist/json/util.hpp>
 #include <vist/json/value.hpp>
-#include <vist/string.hpp>
 
 #include <string>
 #include <unordered_map>
@@ -73,49 +72,28 @@ struct Object : public Value {
 		}
 	}
 
-	std::string serialize() const override
+	using Value::dump;
+
+	void dump(std::string& out) const override
 	{
-		std::stringstream ss;
-		ss << "{ ";
+		out += "{ ";
 
 		std::size_t i = 0;
 		for (const auto& [key, value] : pairs) {
-			ss << "\"" << key << "\": ";
-			ss << value->serialize();
+			writeString(out, key);
+			out += ": ";
+			value->dump(out);
 
 			if (i++ < pairs.size() - 1)
-				ss << ",";
+				out += ",";
 
-			ss << " ";
+			out += " ";
 		}
-		ss << "}";
-
-		return ss.str();
+		out += "}";
 	}
 
-	void deserialize(const std::string& dumped) override
-	{
-		if (dumped.empty())
-			throw std::invalid_argument("Dumped value cannot empty.");
-
-		auto stripped = strip(trim(dumped), '{', '}');
-		auto divided = split(stripped, ",");
-		auto tokens = canonicalize(divided);
-		for (const auto& token : tokens) {
-			if (auto pos = token.find(":"); pos != std::string::npos) {
-				auto lhs = token.substr(0, pos);
-				auto rhs = token.substr(pos + 1);
-
-				auto key = strip(trim(lhs), '"', '"');
-				auto value = std::make_shared<Value>();
-
-				value->deserialize(trim(rhs));
-				this->pairs[key] = value;
-			} else {
-				throw std::runtime_error("Wrong format.");
-			}
-		}
-	}
+	/// Defined in builder.hpp.
+	void deserialize(const std::string& dumped) override;
 
 	std::size_t size() const noexcept
 	{
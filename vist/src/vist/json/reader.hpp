@@ -0,0 +1,361 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * Single-pass, SAX style JSON reader.
+ *   - The handler receives events while the text is scanned once.
+ *   - Handler interface:
+ *       void onNull();
+ *       void onBool(bool);
+ *       void onInt(long long);
+ *       void onDouble(double);
+ *       void onString(std::string&&);
+ *       void onKey(std::string&&);
+ *       void onStartObject();
+ *       void onEndObject();
+ *       void onStartArray();
+ *       void onEndArray();
+ */
+/*
+ * Usage:
+ *     struct Counter {
+ *       void onInt(long long) { count++; }
+ *       ...
+ *       int count = 0;
+ *     };
+ *
+ *     Counter counter;
+ *     Reader<Counter>::Parse("[1, 2, 3]", counter);
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace vist {
+namespace json {
+
+template <typename Handler>
+class Reader final {
+public:
+	static void Parse(const std::string& text, Handler& handler)
+	{
+		Reader reader(text, handler);
+		reader.skip();
+		reader.value(0);
+		reader.skip();
+
+		if (reader.pos != text.size())
+			reader.fail("Unexpected trailing characters");
+	}
+
+private:
+	/// Protects the stack from deeply nested input.
+	static constexpr std::size_t MaxDepth = 512;
+
+	Reader(const std::string& text, Handler& handler) : text(text), handler(handler) {}
+
+	void value(std::size_t depth)
+	{
+		if (depth > MaxDepth)
+			this->fail("Too deep nesting");
+
+		switch (this->peek()) {
+		case '{':
+			this->object(depth);
+			break;
+		case '[':
+			this->array(depth);
+			break;
+		case '"':
+			this->handler.onString(this->string());
+			break;
+		case 't':
+			this->literal("true");
+			this->handler.onBool(true);
+			break;
+		case 'f':
+			this->literal("false");
+			this->handler.onBool(false);
+			break;
+		case 'n':
+			this->literal("null");
+			this->handler.onNull();
+			break;
+		default:
+			this->number();
+		}
+	}
+
+	void object(std::size_t depth)
+	{
+		this->pos++;
+		this->handler.onStartObject();
+
+		this->skip();
+		if (this->peek() == '}') {
+			this->pos++;
+			this->handler.onEndObject();
+			return;
+		}
+
+		while (true) {
+			this->skip();
+			if (this->peek() != '"')
+				this->fail("Expected key");
+
+			this->handler.onKey(this->string());
+
+			this->skip();
+			this->expect(':');
+			this->skip();
+			this->value(depth + 1);
+			this->skip();
+
+			if (this->peek() == ',') {
+				this->pos++;
+				continue;
+			}
+
+			this->expect('}');
+			break;
+		}
+
+		this->handler.onEndObject();
+	}
+
+	void array(std::size_t depth)
+	{
+		this->pos++;
+		this->handler.onStartArray();
+
+		this->skip();
+		if (this->peek() == ']') {
+			this->pos++;
+			this->handler.onEndArray();
+			return;
+		}
+
+		while (true) {
+			this->skip();
+			this->value(depth + 1);
+			this->skip();
+
+			if (this->peek() == ',') {
+				this->pos++;
+				continue;
+			}
+
+			this->expect(']');
+			break;
+		}
+
+		this->handler.onEndArray();
+	}
+
+	std::string string()
+	{
+		this->expect('"');
+
+		std::string result;
+		while (true) {
+			/// Copy the plain run at once.
+			std::size_t begin = this->pos;
+			while (this->pos < this->text.size() &&
+				   this->text[this->pos] != '"' && this->text[this->pos] != '\\')
+				this->pos++;
+			result.append(this->text, begin, this->pos - begin);
+
+			char ch = this->peek();
+			this->pos++;
+			if (ch == '"')
+				return result;
+
+			if (ch != '\\')
+				this->fail("Unterminated string");
+
+			switch (this->peek()) {
+			case '"': result += '"'; break;
+			case '\\': result += '\\'; break;
+			case '/': result += '/'; break;
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'n': result += '\n'; break;
+			case 'r': result += '\r'; break;
+			case 't': result += '\t'; break;
+			case 'u':
+				this->pos++;
+				this->unicode(result);
+				continue;
+			default:
+				this->fail("Invalid escape");
+			}
+			this->pos++;
+		}
+	}
+
+	void unicode(std::string& out)
+	{
+		unsigned long code = this->hex4();
+		if (code >= 0xD800 && code <= 0xDBFF) {
+			if (this->text.compare(this->pos, 2, "\\u") != 0)
+				this->fail("Invalid surrogate pair");
+
+			this->pos += 2;
+			unsigned long low = this->hex4();
+			if (low < 0xDC00 || low > 0xDFFF)
+				this->fail("Invalid surrogate pair");
+
+			code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+		}
+
+		if (code < 0x80) {
+			out += static_cast<char>(code);
+		} else if (code < 0x800) {
+			out += static_cast<char>(0xC0 | (code >> 6));
+			out += static_cast<char>(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			out += static_cast<char>(0xE0 | (code >> 12));
+			out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (code & 0x3F));
+		} else {
+			out += static_cast<char>(0xF0 | (code >> 18));
+			out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (code & 0x3F));
+		}
+	}
+
+	unsigned long hex4()
+	{
+		if (this->pos + 4 > this->text.size())
+			this->fail("Invalid unicode escape");
+
+		unsigned long code = 0;
+		for (int i = 0; i < 4; i++) {
+			char ch = this->text[this->pos++];
+			code <<= 4;
+			if (ch >= '0' && ch <= '9')
+				code |= ch - '0';
+			else if (ch >= 'a' && ch <= 'f')
+				code |= ch - 'a' + 10;
+			else if (ch >= 'A' && ch <= 'F')
+				code |= ch - 'A' + 10;
+			else
+				this->fail("Invalid unicode escape");
+		}
+
+		return code;
+	}
+
+	void number()
+	{
+		std::size_t begin = this->pos;
+		bool integral = true;
+
+		if (this->peek() == '-')
+			this->pos++;
+
+		if (!this->digits())
+			this->fail("Unexpected character");
+
+		if (this->peek() == '.') {
+			integral = false;
+			this->pos++;
+			if (!this->digits())
+				this->fail("Invalid number");
+		}
+
+		if (this->peek() == 'e' || this->peek() == 'E') {
+			integral = false;
+			this->pos++;
+			if (this->peek() == '+' || this->peek() == '-')
+				this->pos++;
+			if (!this->digits())
+				this->fail("Invalid number");
+		}
+
+		/// std::string keeps its buffer null-terminated, strto* stop at pos.
+		const char* start = this->text.c_str() + begin;
+		errno = 0;
+		if (integral) {
+			long long value = std::strtoll(start, nullptr, 10);
+			if (errno != ERANGE) {
+				this->handler.onInt(value);
+				return;
+			}
+		}
+
+		this->handler.onDouble(std::strtod(start, nullptr));
+	}
+
+	bool digits()
+	{
+		std::size_t begin = this->pos;
+		while (this->pos < this->text.size() &&
+			   this->text[this->pos] >= '0' && this->text[this->pos] <= '9')
+			this->pos++;
+
+		return this->pos != begin;
+	}
+
+	void literal(const char* word)
+	{
+		std::string_view expected(word);
+		if (this->text.compare(this->pos, expected.size(), word) != 0)
+			this->fail("Invalid literal");
+
+		this->pos += expected.size();
+	}
+
+	void skip() noexcept
+	{
+		while (this->pos < this->text.size()) {
+			char ch = this->text[this->pos];
+			if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+				break;
+			this->pos++;
+		}
+	}
+
+	char peek() const noexcept
+	{
+		return this->pos < this->text.size() ? this->text[this->pos] : '\0';
+	}
+
+	void expect(char ch)
+	{
+		if (this->peek() != ch)
+			this->fail(std::string("Expected '") + ch + "'");
+
+		this->pos++;
+	}
+
+	[[noreturn]] void fail(const std::string& message) const
+	{
+		throw std::invalid_argument(message + " at offset " + std::to_string(this->pos));
+	}
+
+	const std::string& text;
+	Handler& handler;
+	std::size_t pos = 0;
+};
+
+} // namespace json
+} // namespace vist
@@ -28,7 +28,7 @@ TEST(JsonTests, usage)
 	int stars = json["stars"];
 	json["stars"] = stars + 1;
 
-	EXPECT_EQ(json.serialize(), "{ \"stars\": 11, \"project\": \"vist\" }");
+	EXPECT_EQ(json.dump(), "{ \"stars\": 11, \"project\": \"vist\" }");
 }
 
 TEST(JsonTests, int)
@@ -45,7 +45,7 @@ TEST(JsonTests, int)
 
 	EXPECT_EQ(static_cast<int>(json["int"]), -1);
 
-	EXPECT_EQ(json["int"].serialize(), "-1");
+	EXPECT_EQ(json["int"].dump(), "-1");
 
 	json["int"].deserialize("1");
 	EXPECT_EQ(static_cast<int>(json["int"]), 1);
@@ -65,7 +65,7 @@ TEST(JsonTests, double)
 
 	EXPECT_EQ(static_cast<double>(json["double"]), -1.1);
 
-	EXPECT_NE(json["double"].serialize().find("-1.1"), std::string::npos);
+	EXPECT_NE(json["double"].dump().find("-1.1"), std::string::npos);
 
 	json["double"].deserialize("1.1");
 	EXPECT_EQ(static_cast<double>(json["double"]), 1.1);
@@ -96,7 +96,7 @@ TEST(JsonTests, string)
 	value = static_cast<std::string>(json["string"]);
 	EXPECT_EQ(value, "changed value");
 
-	EXPECT_EQ(json["string"].serialize(), "\"changed value\"");
+	EXPECT_EQ(json["string"].dump(), "\"changed value\"");
 
 	json["string"].deserialize("\"deserialized value\"");
 	EXPECT_EQ(static_cast<std::string>(json["string"]), "deserialized value");
@@ -122,13 +122,13 @@ TEST(JsonTests, bool)
 
 	bool value = json["bool"];
 	EXPECT_EQ(value, true);
-	EXPECT_EQ(json["bool"].serialize(), "true");
+	EXPECT_EQ(json["bool"].dump(), "true");
 
 	json["bool"] = false;
 	value = static_cast<bool>(json["bool"]);
 	EXPECT_EQ(value, false);
 
-	EXPECT_EQ(json["bool"].serialize(), "false");
+	EXPECT_EQ(json["bool"].dump(), "false");
 
 	json["bool"].deserialize("true");
 	EXPECT_EQ(static_cast<bool>(json["bool"]), true);
@@ -139,7 +139,7 @@ TEST(JsonTests, null)
 	Json json;
 	json["null"] = nullptr;
 
-	EXPECT_EQ(json["null"].serialize(), "null");
+	EXPECT_EQ(json["null"].dump(), "null");
 }
 
 TEST(JsonTests, type_check)
@@ -180,7 +180,7 @@ TEST(JsonTests, array)
 	EXPECT_EQ(static_cast<int>(array.at(0)), 100);
 	EXPECT_EQ(static_cast<std::string>(array.at(1)), "string");
 
-	auto serialized = array.serialize();
+	auto serialized = array.dump();
 	EXPECT_EQ(serialized, "[ 100, \"string\" ]");
 
 	Array restore;
@@ -211,7 +211,7 @@ TEST(JsonTests, object)
 	EXPECT_EQ(static_cast<int>(object["int"]), 1);
 	EXPECT_EQ(static_cast<std::string>(object["string"]), "initial value");
 
-	std::string serialized = object.serialize();
+	std::string serialized = object.dump();
 	EXPECT_EQ(serialized, "{ \"string\": \"initial value\", \"int\": 1 }");
 
 	Object restore;
@@ -261,13 +261,13 @@ TEST(JsonTests, osquery_format)
 		constraints.push(child);
 		document.push("constraints", constraints);
 
-		EXPECT_EQ(document.serialize(), "{ \"constraints\": [ { \"affinity\": \"TEXT\", "
+		EXPECT_EQ(document.dump(), "{ \"constraints\": [ { \"affinity\": \"TEXT\", "
 				  "\"name\": \"test_int\", "
 				  "\"list\": [ { \"expr\": \"2\", \"op\": 2 } ] } ] }");
 	}
 
 	{
-		Json restore = Json::Parse(document.serialize());
+		Json restore = Json::Parse(document.dump());
 		EXPECT_TRUE(restore.exist("constraints"));
 
 		Array constraints = restore.get<Array>("constraints");
@@ -287,7 +287,7 @@ TEST(JsonTests, serialize)
 	json["int"] = 1;
 	json["string"] = "root value";
 	// expected: { "string": "root value", "int": 1 }
-	EXPECT_EQ(json.serialize(), "{ \"string\": \"root value\", \"int\": 1 }");
+	EXPECT_EQ(json.dump(), "{ \"string\": \"root value\", \"int\": 1 }");
 
 	Object object;
 	object["int"] = 2;
@@ -304,7 +304,7 @@ TEST(JsonTests, serialize)
 	//             "object": { "string": "child value", "int": 2 },
 	//             "int": 1,
 	//             "string": "root value" }
-	auto serialized = json.serialize();
+	auto serialized = json.dump();
 	EXPECT_EQ(serialized, "{ \"array\": [ 3, \"array value\" ], "
 			  "\"object\": { \"string\": \"child value\", \"int\": 2 }, "
 			  "\"int\": 1, "
@@ -324,3 +324,164 @@ TEST(JsonTests, serialize)
 	EXPECT_EQ(static_cast<int>(child2.at(0)), 3);
 	EXPECT_EQ(static_cast<std::string>(child2.at(1)), "array value");
 }
+
+TEST(JsonTests, escape)
+{
+	Json json;
+	json["string"] = "quote\" backslash\\ newline\n";
+
+	auto serialized = json.dump();
+	EXPECT_EQ(serialized, "{ \"string\": \"quote\\\" backslash\\\\ newline\\n\" }");
+
+	Json restore = Json::Parse(serialized);
+	EXPECT_EQ(static_cast<std::string>(restore["string"]), "quote\" backslash\\ newline\n");
+
+	restore = Json::Parse("{ \"unicode\": \"\\u0041\\u00e9\\ud83d\\ude00\" }");
+	EXPECT_EQ(static_cast<std::string>(restore["unicode"]), "A\xc3\xa9\xf0\x9f\x98\x80");
+}
+
+TEST(JsonTests, nested_commas)
+{
+	Json json = Json::Parse("{ \"list\": [ \"a, b\", { \"k\": [1, 2] }, [] ], \"s\": \"{,}\" }");
+
+	Array list = json.get<Array>("list");
+	EXPECT_EQ(list.size(), 3);
+	EXPECT_EQ(static_cast<std::string>(list.at(0)), "a, b");
+	EXPECT_EQ(Object::Create(list.at(1)).get<Array>("k").size(), 2);
+	EXPECT_EQ(static_cast<std::string>(json["s"]), "{,}");
+}
+
+TEST(JsonTests, wrong_format)
+{
+	EXPECT_THROW(Json::Parse("{ \"key\": }"), std::invalid_argument);
+	EXPECT_THROW(Json::Parse("{ \"key\": 1 } trailing"), std::invalid_argument);
+	EXPECT_THROW(Json::Parse("{ \"key\": \"unterminated }"), std::invalid_argument);
+	EXPECT_THROW(Json::Parse("[ 1, 2"), std::invalid_argument);
+}
+
+TEST(JsonTests, dump_buffer)
+{
+	Json json;
+	json["int"] = 1;
+
+	/// The serialized value is appended.
+	std::string buffer = "previous contents";
+	json.dump(buffer);
+	EXPECT_EQ(buffer, "previous contents" + json.dump());
+}
+
+TEST(JsonTests, serialize_deprecated)
+{
+	Json json;
+	json["int"] = 1;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+	EXPECT_EQ(json.serialize(), json.dump());
+	EXPECT_EQ(json["int"].serialize(), "1");
+
+	std::string buffer = "previous contents";
+	json.serialize(buffer);
+	EXPECT_EQ(buffer, json.dump());
+#pragma GCC diagnostic pop
+}
+
+TEST(JsonTests, int64)
+{
+	Json json = Json::Parse("{ \"big\": 9000000000, \"small\": -9000000000 }");
+	EXPECT_TRUE(json["big"].is<Int>());
+	EXPECT_EQ(static_cast<long long>(json["big"]), 9000000000LL);
+	EXPECT_EQ(static_cast<long long>(json["small"]), -9000000000LL);
+	EXPECT_THROW(static_cast<int>(json["big"]), std::out_of_range);
+	EXPECT_EQ(json["big"].dump(), "9000000000");
+
+	json["assigned"] = 9000000000LL;
+	EXPECT_EQ(static_cast<long long>(json["assigned"]), 9000000000LL);
+}
+
+TEST(JsonTests, reader)
+{
+	struct Counter {
+		void onNull() { nulls++; }
+		void onBool(bool) { bools++; }
+		void onInt(long long data) { sum += data; }
+		void onDouble(double) { doubles++; }
+		void onString(std::string&& data) { strings.emplace_back(std::move(data)); }
+		void onKey(std::string&& key) { keys.emplace_back(std::move(key)); }
+		void onStartObject() { depth++; }
+		void onEndObject() { depth--; }
+		void onStartArray() { depth++; }
+		void onEndArray() { depth--; }
+
+		int nulls = 0, bools = 0, doubles = 0, depth = 0;
+		long long sum = 0;
+		std::vector<std::string> strings, keys;
+	} counter;
+
+	Reader<Counter>::Parse("{\"a\": [1, 2, 3.5e1, null, true], \"b\": {\"c\": \"d\"}}", counter);
+	EXPECT_EQ(counter.sum, 3);
+	EXPECT_EQ(counter.doubles, 1);
+	EXPECT_EQ(counter.nulls, 1);
+	EXPECT_EQ(counter.bools, 1);
+	EXPECT_EQ(counter.depth, 0);
+	EXPECT_EQ(counter.keys, std::vector<std::string>({"a", "b", "c"}));
+	EXPECT_EQ(counter.strings, std::vector<std::string>({"d"}));
+}
+
+TEST(JsonTests, document)
+{
+	std::string raw = "{ \"values\": [ 1, \"two\", 3.5, true, null ], "
+					  "\"object\": { \"key\": \"value\" }, "
+					  "\"big\": 9000000000 }";
+	auto document = Document::Parse(raw);
+	auto root = document.root();
+
+	EXPECT_EQ(root.size(), 3);
+	EXPECT_TRUE(root.exist("values"));
+	EXPECT_FALSE(root.exist("none"));
+
+	auto values = root["values"];
+	EXPECT_EQ(values.size(), 5);
+	EXPECT_EQ(values.at(0).get<int>(), 1);
+	EXPECT_EQ(values.at(1).get<std::string_view>(), "two");
+	EXPECT_EQ(values.at(2).get<double>(), 3.5);
+	EXPECT_EQ(values.at(3).get<bool>(), true);
+	EXPECT_TRUE(values.at(4).is(Document::Type::Null));
+	EXPECT_THROW(values.at(1).get<int>(), std::runtime_error);
+
+	EXPECT_EQ(root["object"]["key"].get<std::string>(), "value");
+	EXPECT_EQ(root["big"].get<long long>(), 9000000000LL);
+	EXPECT_THROW(root["big"].get<int>(), std::out_of_range);
+
+	std::vector<std::string> keys;
+	for (auto member : root)
+		keys.emplace_back(member.key());
+	EXPECT_EQ(keys, std::vector<std::string>({"values", "object", "big"}));
+
+	/// Keys keep the order, so the text round-trips.
+	std::string buffer;
+	document.dump(buffer);
+	EXPECT_EQ(buffer, raw);
+	EXPECT_EQ(Document::Parse(buffer).dump(), raw);
+}
+
+TEST(JsonTests, document_index)
+{
+	/// Nested composites are between the elements in the arena.
+	auto document = Document::Parse("[ [ 1, 2 ], { \"k\": [ 3 ] }, 4, [], 5 ]");
+	auto root = document.root();
+
+	EXPECT_EQ(root.size(), 5);
+	EXPECT_EQ(root.at(0).at(1).get<int>(), 2);
+	EXPECT_EQ(root.at(1)["k"].at(0).get<int>(), 3);
+	EXPECT_EQ(root.at(2).get<int>(), 4);
+	EXPECT_EQ(root.at(3).size(), 0);
+	EXPECT_EQ(root.at(4).get<int>(), 5);
+	EXPECT_THROW(root.at(5), std::invalid_argument);
+	EXPECT_THROW(root.at(3).at(0), std::invalid_argument);
+	EXPECT_EQ(root.at(1).at(0).key(), "k");
+
+	std::size_t i = 0;
+	for (auto value : root)
+		EXPECT_EQ(value.type(), root.at(i++).type());
+}
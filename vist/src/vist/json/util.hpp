@@ -16,53 +16,59 @@
 
 #pragma once
 
-#include <vist/string.hpp>
-
+#include <cstdio>
+#include <cstdlib>
 #include <string>
-#include <vector>
+#include <string_view>
 
 namespace vist {
 namespace json {
 
-inline std::vector<std::string> canonicalize(std::vector<std::string>& tokens)
+/// Append the quoted and escaped string to buffer.
+inline void writeString(std::string& buffer, std::string_view data)
 {
-	std::vector<std::string> result;
-	auto rearrange = [&](std::vector<std::string>::iterator & iter, char first, char last) {
-		if ((*iter).find(first) == std::string::npos)
-			return false;
-
-		std::string origin = *iter;
-		iter++;
+	static const char hex[] = "0123456789abcdef";
 
-		std::size_t lcount = 1, rcount = 0;
-		while (iter != tokens.end()) {
-			lcount += count(*iter, first);
-			rcount += count(*iter, last);
+	buffer += '"';
+	std::size_t begin = 0;
+	for (std::size_t i = 0; i < data.size(); i++) {
+		unsigned char ch = static_cast<unsigned char>(data[i]);
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
 
-			origin += ", " + *iter;
+		buffer.append(data.data() + begin, i - begin);
+		begin = i + 1;
 
-			if (lcount == rcount)
-				break;
-			else
-				iter++;
+		switch (ch) {
+		case '"': buffer += "\\\""; break;
+		case '\\': buffer += "\\\\"; break;
+		case '\b': buffer += "\\b"; break;
+		case '\f': buffer += "\\f"; break;
+		case '\n': buffer += "\\n"; break;
+		case '\r': buffer += "\\r"; break;
+		case '\t': buffer += "\\t"; break;
+		default:
+			buffer += "\\u00";
+			buffer += hex[ch >> 4];
+			buffer += hex[ch & 0x0F];
 		}
-		result.emplace_back(std::move(origin));
-
-		return true;
-	};
+	}
+	buffer.append(data.data() + begin, data.size() - begin);
+	buffer += '"';
+}
 
-	for (auto iter = tokens.begin() ; iter != tokens.end(); iter++) {
-		if (rearrange(iter, '{', '}') || rearrange(iter, '[', ']')) {
-			if (iter == tokens.end())
-				break;
-			else
-				continue;
-		}
+/// Append the text which restores the same double.
+inline void writeDouble(std::string& buffer, double data)
+{
+	char text[32];
+	int size = std::snprintf(text, sizeof(text), "%.15g", data);
+	if (std::strtod(text, nullptr) != data)
+		size = std::snprintf(text, sizeof(text), "%.17g", data);
 
-		result.emplace_back(std::move(*iter));
-	}
+	buffer.append(text, size);
 
-	return result;
+	if (std::string_view(text, size).find_first_of(".en") == std::string_view::npos)
+		buffer += ".0";
 }
 
 } // namespace json
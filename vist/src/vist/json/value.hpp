@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <vist/json/util.hpp>
+
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -35,12 +39,35 @@ struct Object;
 template<class T> struct dependent_false : std::false_type {};
 
 struct Value {
-	virtual std::string serialize() const
+	virtual ~Value() = default;
+
+	std::string dump() const
+	{
+		std::string buffer;
+		this->dump(buffer);
+		return buffer;
+	}
+
+	/// Append the serialized value to buffer.
+	virtual void dump(std::string& buffer) const
 	{
 		if (leaf == nullptr)
 			throw std::runtime_error("Leaf is not set yet.");
 
-		return this->leaf->serialize();
+		this->leaf->dump(buffer);
+	}
+
+	[[deprecated("Use dump().")]]
+	std::string serialize() const
+	{
+		return this->dump();
+	}
+
+	[[deprecated("Use dump(buffer) on the cleared buffer.")]]
+	void serialize(std::string& buffer) const
+	{
+		buffer.clear();
+		this->dump(buffer);
 	}
 
 	template <typename Type>
@@ -49,43 +76,13 @@ struct Value {
 		this->leaf = std::make_shared<Type>();
 	}
 
-	virtual void deserialize(const std::string& dumped)
-	{
-		if (dumped.empty())
-			throw std::invalid_argument("Dumped value cannot empty.");
-
-		switch (dumped[0]) {
-		case '{' :
-			this->convert<Object>();
-			break;
-		case '[' :
-			this->convert<Array>();
-			break;
-		case '"':
-			this->convert<String>();
-			break;
-		case 'n':
-			this->convert<Null>();
-			break;
-		case 't': // fall through
-		case 'f' :
-			this->convert<Bool>();
-			break;
-		default : {
-			if (dumped.find(".") == std::string::npos)
-				this->convert<Int>();
-			else
-				this->convert<Double>();
-		}
-		}
-
-		this->leaf->deserialize(dumped);
-	}
+	/// Defined in builder.hpp, it parses the whole text in a single pass.
+	virtual void deserialize(const std::string& dumped);
 
 	template <typename Type>
 	Value& operator=(const Type& data)
 	{
-		if constexpr(std::is_same_v<Type, int>)
+		if constexpr(std::is_same_v<Type, int> || std::is_same_v<Type, long long>)
 			this->leaf = std::make_shared<Int>(data);
 		else if constexpr(std::is_same_v<Type, double>)
 			this->leaf = std::make_shared<Double>(data);
@@ -110,6 +107,14 @@ struct Value {
 		return (*this->leaf).operator int();
 	}
 
+	virtual operator long long()
+	{
+		if (auto downcast = std::dynamic_pointer_cast<Int>(this->leaf); downcast == nullptr)
+			throw std::runtime_error("Mismatched type.");
+
+		return (*this->leaf).operator long long();
+	}
+
 	virtual operator double()
 	{
 		if (auto downcast = std::dynamic_pointer_cast<Double>(this->leaf); downcast == nullptr)
@@ -144,35 +149,45 @@ struct Value {
 	std::shared_ptr<Value> leaf;
 };
 
+/// Holds 64-bit integer, operator int() throws if the value doesn't fit.
 struct Int : public Value {
 	explicit Int() {}
 	explicit Int(int data) : data(data) {}
+	explicit Int(long long data) : data(data) {}
 
-	std::string serialize() const override
+	void dump(std::string& buffer) const override
 	{
-		return std::to_string(data);
+		buffer += std::to_string(data);
 	}
 
 	void deserialize(const std::string& dumped) override
 	{
-		this->data = std::stoi(dumped);
+		this->data = std::stoll(dumped);
 	}
 
 	operator int() override
+	{
+		if (data < std::numeric_limits<int>::min() || data > std::numeric_limits<int>::max())
+			throw std::out_of_range("Out of range.");
+
+		return static_cast<int>(data);
+	}
+
+	operator long long() override
 	{
 		return data;
 	}
 
-	int data = 0;
+	long long data = 0;
 };
 
 struct Double : public Value {
 	explicit Double() {}
 	explicit Double(double data) : data(data) {}
 
-	std::string serialize() const override
+	void dump(std::string& buffer) const override
 	{
-		return std::to_string(data);
+		writeDouble(buffer, data);
 	}
 
 	void deserialize(const std::string& dumped) override
@@ -185,28 +200,21 @@ struct Double : public Value {
 		return data;
 	}
 
-	double data = 0.0;
+	double data = 0;
 };
 
 struct String : public Value {
 	explicit String() {}
 	explicit String(const std::string& data) : data(data) {}
+	explicit String(std::string&& data) : data(std::move(data)) {}
 
-	std::string serialize() const override
+	void dump(std::string& buffer) const override
 	{
-		return "\"" + this->data + "\"";
+		writeString(buffer, data);
 	}
 
-	void deserialize(const std::string& dumped) override
-	{
-		if (dumped.empty())
-			throw std::invalid_argument("Dumped value cannot empty.");
-
-		if (dumped[0] != '"' || dumped[dumped.size() - 1] != '"')
-			throw std::invalid_argument("Wrong format.");
-
-		this->data = dumped.substr(1, dumped.size() - 2);
-	}
+	/// Defined in builder.hpp to unescape the text.
+	void deserialize(const std::string& dumped) override;
 
 	operator std::string() override
 	{
@@ -220,9 +228,9 @@ struct Bool : public Value {
 	explicit Bool() {}
 	explicit Bool(bool data) : data(data) {}
 
-	std::string serialize() const override
+	void dump(std::string& buffer) const override
 	{
-		return this->data ? "true" : "false";
+		buffer += this->data ? "true" : "false";
 	}
 
 	void deserialize(const std::string& dumped) override
@@ -246,9 +254,9 @@ struct Bool : public Value {
 struct Null : public Value {
 	explicit Null() {}
 
-	std::string serialize() const override
+	void dump(std::string& buffer) const override
 	{
-		return "null";
+		buffer += "null";
 	}
 
 	void deserialize(const std::string& dumped) override
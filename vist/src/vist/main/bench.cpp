@@ -0,0 +1,444 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @brief   Benchmarks of the hot paths. (RMI, Archive, policy storage, SQL)
+ * @details Each benchmark repeats its body until --min_time_ms elapsed and the
+ *          results are written as JSON, so that runs can be compared by tools.
+ * @usage
+ *  vist-bench --filter=rmi --output=/tmp/rmi.json
+ *
+ *  { "benchmarks": [ { "name": "rmi/round-trip", "ops": 8192,
+ *                      "ns_per_op": 41234.5, "ops_per_sec": 24251.4 }, ... ] }
+ */
+
+#include <vist/archive.hpp>
+#include <vist/exception.hpp>
+#include <vist/json.hpp>
+#include <vist/logger.hpp>
+#include <vist/policy/policy-storage.hpp>
+#include <vist/rmi/message.hpp>
+#include <vist/rmi/impl/client.hpp>
+#include <vist/rmi/impl/server.hpp>
+#include <vist/sdk/policy-model.hpp>
+#include <vist/result-set.hpp>
+
+#include <gflags/gflags.h>
+
+#include <osquery/registry.h>
+#include <osquery/registry_interface.h>
+#include <osquery/sql.h>
+#include <osquery/tables.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace vist;
+
+DEFINE_string(filter, "", "Run only the benchmarks whose name contains this.");
+DEFINE_string(output, "", "File to write the results. (default: stdout)");
+DEFINE_int32(min_time_ms, 200, "Minimum running time of each benchmark.");
+DEFINE_int32(threads, 4, "The number of clients of the RMI throughput benchmark.");
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Logs are dropped except errors, they would be measured otherwise.
+struct Quiet final : public LogBackend {
+	void info(const LogRecord&) const noexcept override {}
+	void debug(const LogRecord&) const noexcept override {}
+	void warn(const LogRecord&) const noexcept override {}
+
+	void error(const LogRecord& record) const noexcept override
+	{
+		std::cerr << "[E][" << record.tag << "]" << record.message << std::endl;
+	}
+};
+
+class Bench final {
+public:
+	/// Repeat the body, which performs a single operation per call.
+	template <typename Body>
+	void run(const std::string& name, Body&& body)
+	{
+		if (!this->selected(name))
+			return;
+
+		/// Warm up caches and lazy initialization.
+		body();
+
+		std::size_t iterations = 1;
+		while (true) {
+			auto begin = Clock::now();
+			for (std::size_t i = 0; i < iterations; i++)
+				body();
+			auto elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+			if (elapsed >= this->minTime() || iterations >= MaxIterations) {
+				this->record(name, iterations, elapsed);
+				return;
+			}
+
+			iterations *= 2;
+		}
+	}
+
+	/// Record a benchmark which measures by itself.
+	void record(const std::string& name, std::size_t ops, double seconds)
+	{
+		json::Object result;
+		result["name"] = name;
+		result["ops"] = static_cast<int>(ops);
+		result["ns_per_op"] = seconds * 1e9 / static_cast<double>(ops);
+		result["ops_per_sec"] = static_cast<double>(ops) / seconds;
+		this->results.push(result);
+
+		std::cerr << name << ": " << ops << " ops in " << seconds << " s" << std::endl;
+	}
+
+	bool selected(const std::string& name) const
+	{
+		return name.find(FLAGS_filter) != std::string::npos;
+	}
+
+	double minTime() const
+	{
+		return FLAGS_min_time_ms / 1000.0;
+	}
+
+	std::string serialize()
+	{
+		json::Json document;
+		document.push("benchmarks", this->results);
+		return document.dump();
+	}
+
+private:
+	static constexpr std::size_t MaxIterations = 1 << 24;
+
+	json::Array results;
+};
+
+/// Keep the optimizer from discarding the measured value.
+template <typename T>
+void use(const T& value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+void benchArchive(Bench& bench)
+{
+	std::vector<std::string> names;
+	std::map<std::string, std::string> policies;
+	for (int i = 0; i < 64; i++) {
+		names.emplace_back("column_name_" + std::to_string(i));
+		policies.emplace("policy_" + std::to_string(i), "I/" + std::to_string(i));
+	}
+
+	bench.run("archive/encode/scalars", [] {
+		Archive archive;
+		archive << 100 << true << std::string("request argument");
+		use(archive);
+	});
+
+	bench.run("archive/encode/vector-64", [&] {
+		Archive archive;
+		archive << names;
+		use(archive);
+	});
+
+	bench.run("archive/encode/map-64", [&] {
+		Archive archive;
+		archive << policies;
+		use(archive);
+	});
+
+	Archive scalars;
+	scalars << 100 << true << std::string("request argument");
+	bench.run("archive/decode/scalars", [&] {
+		Archive archive = scalars;
+		int number;
+		bool boolean;
+		std::string text;
+		archive >> number >> boolean >> text;
+		use(text);
+	});
+
+	Archive vector;
+	vector << names;
+	bench.run("archive/decode/vector-64", [&] {
+		Archive archive = vector;
+		std::vector<std::string> decoded;
+		archive >> decoded;
+		use(decoded);
+	});
+
+	Archive map;
+	map << policies;
+	bench.run("archive/decode/map-64", [&] {
+		Archive archive = map;
+		std::map<std::string, std::string> decoded;
+		archive >> decoded;
+		use(decoded);
+	});
+}
+
+void benchRmi(Bench& bench)
+{
+	if (!bench.selected("rmi/"))
+		return;
+
+	using namespace rmi;
+	using namespace rmi::impl;
+
+	const std::string path = "@vist-bench.sock";
+	auto echo = [](Message& message) -> Message {
+		int number;
+		std::string text;
+		message.disclose(number, text);
+
+		Message reply(Message::Type::Reply, message.signature);
+		reply.enclose(number, text);
+		return reply;
+	};
+
+	Server server(path, echo);
+	auto serverThread = std::thread([&]() {
+		server.run();
+	});
+
+	{
+		Client client(path);
+		bench.run("rmi/round-trip", [&] {
+			Message message(Message::Type::MethodCall, "Bench::echo");
+			message.enclose(100, std::string("request argument"));
+			use(client.request(message));
+		});
+	}
+
+	if (bench.selected("rmi/throughput")) {
+		std::atomic<bool> stop(false);
+		std::atomic<std::size_t> total(0);
+		std::vector<std::thread> clients;
+
+		auto begin = Clock::now();
+		for (int i = 0; i < FLAGS_threads; i++) {
+			clients.emplace_back([&]() {
+				Client client(path);
+				std::size_t count = 0;
+				while (!stop) {
+					Message message(Message::Type::MethodCall, "Bench::echo");
+					message.enclose(100, std::string("request argument"));
+					client.request(message);
+					count++;
+				}
+				total += count;
+			});
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_min_time_ms));
+		stop = true;
+		for (auto& client : clients)
+			client.join();
+
+		auto elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+		bench.record("rmi/throughput/clients-" + std::to_string(FLAGS_threads),
+					 total, elapsed);
+	}
+
+	server.stop();
+	if (serverThread.joinable())
+		serverThread.join();
+}
+
+struct BenchPolicy final : public policy::PolicyModel {
+	explicit BenchPolicy(const std::string& name) :
+		PolicyModel(name, policy::PolicyValue(0)) {}
+
+	void onChanged(const policy::PolicyValue&) override {}
+};
+
+void benchPolicyStorage(Bench& bench)
+{
+	if (!bench.selected("policy-storage/"))
+		return;
+
+	/// The database is created exclusively, an existing file is never reused.
+	char path[] = "/tmp/vist-bench-XXXXXX";
+	int fd = ::mkstemp(path);
+	if (fd == -1)
+		THROW(ErrCode::RuntimeError) << "Failed to create the benchmark database.";
+	::close(fd);
+
+	try {
+		policy::PolicyStorage storage(path);
+
+		/// Policies are looked up by name as PolicyManager does.
+		const int policies = 64;
+		std::unordered_map<std::string, std::shared_ptr<policy::PolicyModel>> models;
+		for (int i = 0; i < policies; i++) {
+			auto model = std::make_shared<BenchPolicy>("bench_policy_" + std::to_string(i));
+			storage.define(model->getName(), model->getInitial());
+			models.emplace(model->getName(), model);
+		}
+
+		const int admins = 4;
+		for (int i = 0; i < admins; i++)
+			storage.enroll("bench-admin-" + std::to_string(i));
+
+		auto model = models.at("bench_policy_0");
+		int value = 0;
+		bench.run("policy-storage/set", [&] {
+			auto admin = "bench-admin-" + std::to_string(value % admins);
+			storage.update(admin, model->getName(), policy::PolicyValue(value++));
+		});
+
+		std::vector<std::string> names;
+		for (int i = 0; i < policies; i++)
+			names.emplace_back("bench_policy_" + std::to_string(i));
+
+		std::size_t next = 0;
+		bench.run("policy-storage/get/policies-" + std::to_string(policies), [&] {
+			const auto& name = names[next++ % names.size()];
+			use(storage.strictest(models.at(name)));
+		});
+
+		bench.run("policy-storage/strictest/admins-" + std::to_string(admins), [&] {
+			use(storage.strictest(model));
+		});
+
+		bench.run("policy-storage/sync", [&] {
+			storage.sync();
+		});
+	} catch (...) {
+		::unlink(path);
+		throw;
+	}
+
+	::unlink(path);
+}
+
+/// Rows shaped like the policy table, without PolicyManager behind them.
+class BenchTable final : public osquery::TablePlugin {
+public:
+	explicit BenchTable(std::size_t rows) : rows(rows) {}
+
+	osquery::TableColumns columns() const override
+	{
+		return {
+			std::make_tuple("name", osquery::TEXT_TYPE, osquery::ColumnOptions::DEFAULT),
+			std::make_tuple("value", osquery::TEXT_TYPE, osquery::ColumnOptions::DEFAULT),
+		};
+	}
+
+	osquery::QueryData select(osquery::QueryContext&) override
+	{
+		osquery::QueryData results;
+		results.reserve(this->rows);
+		for (std::size_t i = 0; i < this->rows; i++) {
+			results.push_back({{"name", "bench_policy_" + std::to_string(i)},
+							   {"value", "I/" + std::to_string(i)}});
+		}
+
+		return results;
+	}
+
+private:
+	std::size_t rows;
+};
+
+/// The SQL layers under Vistd::Query/Fetch, on tables of the benchmark.
+/// Vistd itself is not constructed, since it would open the policy database,
+/// enroll the default admin and rewrite the table manifest.
+void benchQuery(Bench& bench)
+{
+	if (!bench.selected("sql/"))
+		return;
+
+	osquery::registryAndPluginInit();
+
+	/// Tables are attached when the first connection opens, so add them all first.
+	const std::vector<std::size_t> sizes = {1, 100, 1000};
+	auto tables = osquery::RegistryFactory::get().registry("table");
+	for (std::size_t rows : sizes)
+		tables->add("bench_rows_" + std::to_string(rows), std::make_shared<BenchTable>(rows));
+
+	for (std::size_t rows : sizes) {
+		/// The bench tables are not cacheable, every query generates its rows.
+		std::string statement = "SELECT name, value FROM bench_rows_" + std::to_string(rows);
+		bench.run("sql/query/rows-" + std::to_string(rows), [&] {
+			osquery::SQL sql(statement, false);
+			if (!sql.ok())
+				THROW(ErrCode::RuntimeError) << "Failed to query: " << sql.getMessageString();
+
+			use(sql.rows());
+		});
+
+		bench.run("sql/fetch/rows-" + std::to_string(rows), [&] {
+			ResultSet result;
+			auto status = osquery::queryColumnar(statement, result, false);
+			if (!status.ok())
+				THROW(ErrCode::RuntimeError) << "Failed to fetch: " << status.getMessage();
+
+			use(result);
+		});
+	}
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) try
+{
+	gflags::SetUsageMessage("ViST benchmarks.");
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	LogStream::Init(std::make_shared<Quiet>());
+
+	Bench bench;
+	benchArchive(bench);
+	benchRmi(bench);
+	benchPolicyStorage(bench);
+	benchQuery(bench);
+
+	if (FLAGS_output.empty()) {
+		std::cout << bench.serialize() << std::endl;
+	} else {
+		std::ofstream file(FLAGS_output);
+		file << bench.serialize() << std::endl;
+		if (!file)
+			THROW(ErrCode::RuntimeError) << "Failed to write results: " << FLAGS_output;
+	}
+
+	return EXIT_SUCCESS;
+} catch (const Exception<ErrCode>& e)
+{
+	std::cerr << "Failed message: " << e.what() << std::endl;
+	return EXIT_FAILURE;
+} catch (const std::exception& e)
+{
+	std::cerr << "Failed message: " << e.what() << std::endl;
+	return EXIT_FAILURE;
+}
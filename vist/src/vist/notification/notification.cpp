@@ -16,18 +16,47 @@
 
 #include "notification.hpp"
 
+#include <atomic>
+#include <deque>
+#include <future>
 #include <mutex>
 
 #include <vist/logger.hpp>
+#include <vist/thread-pool.hpp>
 
 namespace {
+/// Serializes writers only, emit() does not take it.
 std::mutex mutex;
+
+/// Set on the dispatcher thread by the tasks it runs.
+thread_local bool onDispatcher = false;
 } // anonymous namespace
 
 namespace vist {
 
 using namespace osquery;
 
+struct Notification::Subscriber final {
+	Subscriber(const NotifyCallback& callback, const NotifyOption& option) :
+		callback(callback), option(option) {}
+
+	NotifyCallback callback;
+	NotifyOption option;
+
+	/// Pending rows of an async subscriber.
+	std::mutex queueMutex;
+	std::deque<Row> queue;
+	bool scheduled = false;
+};
+
+Notification::Notification() :
+	subscribers(std::make_shared<const Subscribers>()),
+	dispatcher(std::make_unique<ThreadPool>(1))
+{
+}
+
+Notification::~Notification() = default;
+
 Notification& Notification::instance()
 {
 	static Notification notifier;
@@ -35,39 +64,119 @@ Notification& Notification::instance()
 }
 
 Status Notification::add(const std::string& table, const NotifyCallback& callback)
+{
+	return this->add(table, callback, NotifyOption());
+}
+
+Status Notification::add(const std::string& table, const NotifyCallback& callback,
+						 const NotifyOption& option)
 {
 	if (table.empty())
 		return Status(1, "Wrong table name");
 
+	if (option.capacity == 0)
+		return Status(1, "Wrong queue capacity");
+
 	INFO(VIST) << "Add NotifyCallback to:" << table;
 	{
 		std::lock_guard<std::mutex> lock(mutex);
-		this->callbacks.insert(std::make_pair(table, callback));
+		auto next = std::make_shared<Subscribers>(*std::atomic_load(&this->subscribers));
+		(*next)[table].emplace_back(std::make_shared<Subscriber>(callback, option));
+		std::atomic_store(&this->subscribers, std::shared_ptr<const Subscribers>(next));
 	}
 
 	return Status(0, "OK");
 }
 
 Status Notification::emit(const std::string& table, const Row& result) const
+{
+	return this->emitBatch(table, Rows {result});
+}
+
+Status Notification::emitBatch(const std::string& table, const Rows& results) const
 {
 	if (table.empty())
 		return Status(1, "Wrong table name");
 
-	auto iter = this->callbacks.find(table);
-	if (iter == this->callbacks.end())
+	auto snapshot = std::atomic_load(&this->subscribers);
+	auto iter = snapshot->find(table);
+	if (iter == snapshot->end())
 		return Status(1, "Registered callback not found");
 
 	INFO(VIST) << "Emit notification about:" << table;
-	{
-		std::lock_guard<std::mutex> lock(mutex);
-		while (iter != this->callbacks.end())  {
-			const auto& callback = iter->second;
-			callback(result);
-			iter++;
+	for (const auto& subscriber : iter->second) {
+		if (subscriber->option.dispatch == NotifyOption::Dispatch::Sync) {
+			for (const auto& result : results)
+				subscriber->callback(result);
+		} else {
+			this->post(subscriber, results);
 		}
 	}
 
 	return Status(0, "OK");
 }
 
+void Notification::post(const std::shared_ptr<Subscriber>& subscriber, const Rows& results) const
+{
+	{
+		std::lock_guard<std::mutex> lock(subscriber->queueMutex);
+		auto& queue = subscriber->queue;
+		if (subscriber->option.overflow == NotifyOption::Overflow::Coalesce)
+			queue.clear();
+
+		for (const auto& result : results) {
+			if (queue.size() >= subscriber->option.capacity) {
+				if (subscriber->option.overflow == NotifyOption::Overflow::DropNewest) {
+					DEBUG(VIST) << "Notification queue is full, drop the newest.";
+					break;
+				}
+
+				DEBUG(VIST) << "Notification queue is full, drop the oldest.";
+				queue.pop_front();
+			}
+
+			queue.push_back(result);
+		}
+
+		if (subscriber->scheduled || queue.empty())
+			return;
+
+		subscriber->scheduled = true;
+	}
+
+	/// The dispatcher has one thread, so rows of a subscriber keep their order.
+	this->dispatcher->submit([subscriber]() {
+		onDispatcher = true;
+		while (true) {
+			Row row;
+			{
+				std::lock_guard<std::mutex> lock(subscriber->queueMutex);
+				if (subscriber->queue.empty()) {
+					subscriber->scheduled = false;
+					return;
+				}
+
+				row = std::move(subscriber->queue.front());
+				subscriber->queue.pop_front();
+			}
+
+			subscriber->callback(row);
+		}
+	});
+}
+
+void Notification::flush() const
+{
+	/// The task below would wait behind the running callback forever.
+	if (onDispatcher) {
+		WARN(VIST) << "Notification is flushed by the dispatcher, skip it.";
+		return;
+	}
+
+	std::promise<void> done;
+	auto future = done.get_future();
+	this->dispatcher->submit([&done]() { done.set_value(); });
+	future.wait();
+}
+
 } // namespace vist
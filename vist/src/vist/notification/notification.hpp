@@ -16,8 +16,12 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <osquery/status.h>
@@ -31,6 +35,31 @@ using Callback = std::function<void(const Row&)>;
 
 using NotifyCallback = Callback;
 
+/// How a subscriber receives notifications.
+struct NotifyOption final {
+	/// Async subscribers of all tables share one dispatcher thread.
+	/// It keeps the order of rows, but a slow callback delays the other
+	/// async subscribers until it returns. Keep the callback short or
+	/// hand the work over to another thread.
+	enum class Dispatch {
+		Sync,	///< Called by the emitter. (default)
+		Async	///< Called by the dispatcher thread.
+	};
+
+	/// What to do when the queue of an async subscriber is full.
+	enum class Overflow {
+		DropOldest,
+		DropNewest,
+		Coalesce	///< Keep the latest emitted rows only.
+	};
+
+	Dispatch dispatch = Dispatch::Sync;
+	Overflow overflow = Overflow::DropOldest;
+	std::size_t capacity = 64;
+};
+
+class ThreadPool;
+
 class Notification final {
 public:
 	static Notification& instance();
@@ -39,13 +68,32 @@ public:
 	Notification& operator=(const Notification&) = delete;
 
 	osquery::Status add(const std::string& table, const NotifyCallback& callback);
+	osquery::Status add(const std::string& table, const NotifyCallback& callback,
+						const NotifyOption& option);
 	osquery::Status emit(const std::string& table, const Row& result) const;
 
+	/// Emit the rows of a change set at once, e.g. a committed transaction.
+	/// A coalescing subscriber keeps the latest change set.
+	osquery::Status emitBatch(const std::string& table, const Rows& results) const;
+
+	/// Wait until async subscribers handle the rows emitted so far.
+	/// Called by an async subscriber, it returns at once since the dispatcher
+	/// cannot wait for itself.
+	void flush() const;
+
 private:
-	Notification() = default;
-	~Notification() = default;
+	struct Subscriber;
+	using Subscribers = std::unordered_map<std::string,
+										   std::vector<std::shared_ptr<Subscriber>>>;
+
+	Notification();
+	~Notification();
+
+	void post(const std::shared_ptr<Subscriber>& subscriber, const Rows& results) const;
 
-	std::multimap<std::string, NotifyCallback> callbacks;
+	/// Copy-on-write snapshot, emit() only loads it.
+	std::shared_ptr<const Subscribers> subscribers;
+	std::unique_ptr<ThreadPool> dispatcher;
 };
 
 } // namespace vist
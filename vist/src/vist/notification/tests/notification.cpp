@@ -19,6 +19,11 @@
 #include <vist/logger.hpp>
 #include <vist/notification/notification.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
 using namespace vist;
 
 class NotificationTests : public testing::Test {};
@@ -73,3 +78,122 @@ TEST_F(NotificationTests, test_emit_positive)
 	EXPECT_TRUE(s.ok());
 	EXPECT_EQ(called, 1);
 }
+
+TEST_F(NotificationTests, test_emit_other_table)
+{
+	auto& notifier = Notification::instance();
+
+	int called = 0;
+	notifier.add("test3", [&](const Row&) { called++; });
+	notifier.add("test4", [&](const Row&) { called += 10; });
+
+	auto s = notifier.emit("test3", Row());
+	EXPECT_TRUE(s.ok());
+	EXPECT_EQ(called, 1);
+}
+
+TEST_F(NotificationTests, test_emit_async)
+{
+	auto& notifier = Notification::instance();
+
+	std::atomic<int> called(0);
+	NotifyOption option;
+	option.dispatch = NotifyOption::Dispatch::Async;
+	auto s = notifier.add("test_async", [&](const Row&) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		called++;
+	}, option);
+	EXPECT_TRUE(s.ok());
+
+	/// The emitter does not wait for the slow subscriber.
+	for (int i = 0; i < 5; i++)
+		notifier.emit("test_async", Row());
+	EXPECT_LT(called, 5);
+
+	notifier.flush();
+	EXPECT_EQ(called, 5);
+}
+
+TEST_F(NotificationTests, test_emit_async_overflow)
+{
+	auto& notifier = Notification::instance();
+
+	auto run = [&notifier](const std::string& table, NotifyOption::Overflow overflow) {
+		std::vector<std::string> received;
+		std::promise<void> entered, release;
+		auto released = release.get_future().share();
+
+		NotifyOption option;
+		option.dispatch = NotifyOption::Dispatch::Async;
+		option.overflow = overflow;
+		option.capacity = 2;
+		notifier.add(table, [&, released](const Row& row) {
+			received.push_back(row.at("seq"));
+			if (received.size() == 1) {
+				entered.set_value();
+				released.wait();
+			}
+		}, option);
+
+		/// Hold the dispatcher in the first callback while the queue fills up.
+		notifier.emit(table, {{"seq", "0"}});
+		entered.get_future().wait();
+		for (int i = 1; i < 4; i++)
+			notifier.emit(table, {{"seq", std::to_string(i)}});
+
+		release.set_value();
+		notifier.flush();
+
+		return received;
+	};
+
+	EXPECT_EQ(run("test_drop_newest", NotifyOption::Overflow::DropNewest),
+			  std::vector<std::string>({"0", "1", "2"}));
+	EXPECT_EQ(run("test_drop_oldest", NotifyOption::Overflow::DropOldest),
+			  std::vector<std::string>({"0", "2", "3"}));
+	EXPECT_EQ(run("test_coalesce", NotifyOption::Overflow::Coalesce),
+			  std::vector<std::string>({"0", "3"}));
+}
+
+TEST_F(NotificationTests, test_emit_batch)
+{
+	auto& notifier = Notification::instance();
+
+	std::vector<std::string> synced;
+	notifier.add("test_batch", [&](const Row& row) { synced.push_back(row.at("seq")); });
+
+	std::vector<std::string> coalesced;
+	NotifyOption option;
+	option.dispatch = NotifyOption::Dispatch::Async;
+	option.overflow = NotifyOption::Overflow::Coalesce;
+	notifier.add("test_batch", [&](const Row& row) { coalesced.push_back(row.at("seq")); },
+				 option);
+
+	Rows rows = {{{"seq", "0"}}, {{"seq", "1"}}};
+	EXPECT_TRUE(notifier.emitBatch("test_batch", rows).ok());
+	notifier.flush();
+
+	/// The whole change set is delivered in order, a coalescing one included.
+	EXPECT_EQ(synced, std::vector<std::string>({"0", "1"}));
+	EXPECT_EQ(coalesced, std::vector<std::string>({"0", "1"}));
+}
+
+TEST_F(NotificationTests, test_flush_in_async_callback)
+{
+	auto& notifier = Notification::instance();
+
+	std::promise<void> done;
+	NotifyOption option;
+	option.dispatch = NotifyOption::Dispatch::Async;
+	notifier.add("test_flush_async", [&](const Row&) {
+		/// The dispatcher does not wait for itself.
+		notifier.flush();
+		done.set_value();
+	}, option);
+
+	notifier.emit("test_flush_async", Row());
+	auto status = done.get_future().wait_for(std::chrono::seconds(5));
+	EXPECT_EQ(status, std::future_status::ready);
+
+	notifier.flush();
+}
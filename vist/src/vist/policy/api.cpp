@@ -29,21 +29,38 @@ PolicyValue API::Get(const std::string& policy)
 	return PolicyManager::Instance().get(policy);
 }
 
+std::vector<PolicyValue> API::GetMany(const std::vector<std::string>& policies)
+{
+	return PolicyManager::Instance().getMany(policies);
+}
+
 std::unordered_map<std::string, PolicyValue> API::GetAll()
 {
 	return PolicyManager::Instance().getAll();
 }
 
-void API::Admin::Set(const std::string& policy, const PolicyValue& value)
+namespace {
+
+/// The admin is the identifier of the peer process, or this process.
+std::string getAdmin()
 {
-	std::string admin;
 	auto peer = rmi::Gateway::GetPeerCredentials();
 	if (peer == nullptr)
-		admin = Process::GetIdentifier(Process::GetPid());
+		return Process::GetIdentifier(Process::GetPid());
 	else
-		admin = Process::GetIdentifier(peer->pid);
+		return Process::GetIdentifier(peer->pid);
+}
 
-	PolicyManager::Instance().set(policy, value, admin);
+} // anonymous namespace
+
+void API::Admin::Set(const std::string& policy, const PolicyValue& value)
+{
+	PolicyManager::Instance().set(policy, value, getAdmin());
+}
+
+void API::Admin::SetMany(const std::vector<std::pair<std::string, PolicyValue>>& policies)
+{
+	PolicyManager::Instance().setMany(policies, getAdmin());
 }
 
 void API::Admin::Enroll(const std::string& admin)
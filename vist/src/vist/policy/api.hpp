@@ -22,16 +22,22 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace vist {
 namespace policy {
 
 struct API {
 	static PolicyValue Get(const std::string& policy);
+	/// Get the values of policies in the given order at once.
+	static std::vector<PolicyValue> GetMany(const std::vector<std::string>& policies);
 	static std::unordered_map<std::string, PolicyValue> GetAll();
 
 	struct Admin {
 		static void Set(const std::string& policy, const PolicyValue& value);
+		/// Set the values of policies at once, all or nothing.
+		static void SetMany(const std::vector<std::pair<std::string, PolicyValue>>& policies);
 
 		static void Enroll(const std::string& admin);
 		static void Disenroll(const std::string& admin);
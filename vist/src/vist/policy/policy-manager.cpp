@@ -26,12 +26,13 @@
 namespace vist {
 namespace policy {
 
-PolicyManager::PolicyManager() : storage(DB_PATH)
+PolicyManager::PolicyManager() : storage(DB_PATH, {DB_JOURNAL_MODE, DB_SYNCHRONOUS})
 {
 }
 
 void PolicyManager::addProvider(std::shared_ptr<PolicyProvider>&& provider)
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	for (const auto& p : this->providers) {
 		if (p->getName() == provider->getName()) {
 			INFO(VIST) << "Previous added provider: " << provider->getName();
@@ -41,6 +42,7 @@ void PolicyManager::addProvider(std::shared_ptr<PolicyProvider>&& provider)
 
 	for (const auto& [name, policy] : provider->policies) {
 		this->policies[name] = provider->getName();
+		this->lazyPolicies.erase(name);
 
 		if (!storage.exists(name))
 			storage.define(name, policy->getInitial());
@@ -49,25 +51,68 @@ void PolicyManager::addProvider(std::shared_ptr<PolicyProvider>&& provider)
 	INFO(VIST) << "Added " << provider->policies.size()
 			   << "-policies from " << provider->getName();
 	this->providers.emplace_back(std::move(provider));
+	this->notifyChanged();
+}
+
+void PolicyManager::addLazyPolicies(const std::vector<std::string>& policies,
+									std::function<void()> loader)
+{
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	for (const auto& policy : policies)
+		if (this->policies.find(policy) == this->policies.end())
+			this->lazyPolicies[policy] = loader;
+}
+
+void PolicyManager::resolve(const std::vector<std::string>& policies)
+{
+	std::vector<std::function<void()>> loaders;
+	{
+		std::lock_guard<std::recursive_mutex> lock(this->mutex);
+		for (const auto& policy : policies)
+			if (auto iter = this->lazyPolicies.find(policy); iter != this->lazyPolicies.end())
+				loaders.push_back(iter->second);
+	}
+
+	for (const auto& loader : loaders)
+		loader();
+}
+
+void PolicyManager::resolveAll()
+{
+	std::vector<std::string> names;
+	{
+		std::lock_guard<std::recursive_mutex> lock(this->mutex);
+		for (const auto& pair : this->lazyPolicies)
+			names.push_back(pair.first);
+	}
+
+	this->resolve(names);
 }
 
 void PolicyManager::enroll(const std::string& admin)
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	this->storage.enroll(admin);
+	this->notifyChanged();
 }
 
 void PolicyManager::disenroll(const std::string& admin)
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	this->storage.disenroll(admin);
+	this->notifyChanged();
 }
 
 void PolicyManager::activate(const std::string& admin, bool state)
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	this->storage.activate(admin, state);
+	this->notifyChanged();
 }
 
 bool PolicyManager::isActivated()
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	return this->storage.isActivated();
 }
 
@@ -75,33 +120,107 @@ void PolicyManager::set(const std::string& policy,
 						const PolicyValue& value,
 						const std::string& admin)
 {
+	this->resolve({policy});
+
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	this->storage.update(admin, policy, value);
 	this->getPolicy(policy)->set(value);
+	this->notifyChanged();
+}
+
+void PolicyManager::setMany(const std::vector<std::pair<std::string, PolicyValue>>& policies,
+							const std::string& admin)
+{
+	std::vector<std::string> names;
+	names.reserve(policies.size());
+	for (const auto& pair : policies)
+		names.push_back(pair.first);
+
+	this->resolve(names);
+
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	std::vector<std::shared_ptr<PolicyModel>> models;
+	models.reserve(names.size());
+	for (const auto& name : names)
+		models.push_back(this->getPolicy(name));
+
+	this->storage.update(admin, policies);
+	for (std::size_t i = 0; i < models.size(); i++)
+		models[i]->set(policies[i].second);
+	this->notifyChanged();
 }
 
 PolicyValue PolicyManager::get(const std::string& policy)
 {
+	this->resolve({policy});
+
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	return storage.strictest(this->getPolicy(policy));
 }
 
+std::vector<PolicyValue> PolicyManager::getMany(const std::vector<std::string>& policies)
+{
+	this->resolve(policies);
+
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	std::vector<std::shared_ptr<PolicyModel>> models;
+	models.reserve(policies.size());
+	for (const auto& policy : policies)
+		models.push_back(this->getPolicy(policy));
+
+	return storage.strictest(models);
+}
+
 std::unordered_map<std::string, PolicyValue> PolicyManager::getAll()
 {
-	std::unordered_map<std::string, PolicyValue> policies;
-	for (const auto& pair : this->policies) {
-		std::string policyName = pair.first;
-		auto value = this->get(policyName);
+	this->resolveAll();
 
-		policies.emplace(std::move(policyName), std::move(value));
-	}
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	std::vector<std::string> names;
+	names.reserve(this->policies.size());
+	for (const auto& pair : this->policies)
+		names.push_back(pair.first);
+
+	auto values = this->getMany(names);
+
+	std::unordered_map<std::string, PolicyValue> policies;
+	for (std::size_t i = 0; i < names.size(); i++)
+		policies.emplace(std::move(names[i]), std::move(values[i]));
 
 	return policies;
 }
 
+std::vector<std::string> PolicyManager::getNames()
+{
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	std::vector<std::string> names;
+	names.reserve(this->policies.size() + this->lazyPolicies.size());
+	for (const auto& pair : this->policies)
+		names.push_back(pair.first);
+	for (const auto& pair : this->lazyPolicies)
+		names.push_back(pair.first);
+
+	return names;
+}
+
 std::unordered_map<std::string, int> PolicyManager::getAdmins()
 {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
 	return storage.getAdmins();
 }
 
+void PolicyManager::addChangeListener(std::function<void()> listener)
+{
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	this->listeners.emplace_back(std::move(listener));
+}
+
+void PolicyManager::notifyChanged()
+{
+	for (const auto& listener : this->listeners)
+		listener();
+}
+
 const std::shared_ptr<PolicyModel>& PolicyManager::getPolicy(const std::string& name)
 {
 	if (this->policies.find(name) == this->policies.end())
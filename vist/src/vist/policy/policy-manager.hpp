@@ -21,9 +21,12 @@
 
 #include "policy-storage.hpp"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest_prod.h>
@@ -52,26 +55,53 @@ public:
 	bool isActivated();
 
 	void addProvider(std::shared_ptr<PolicyProvider>&& provider);
+	/// Register the policies of a provider which is not loaded yet.
+	/// The loader is called when one of them is used first.
+	void addLazyPolicies(const std::vector<std::string>& policies,
+						 std::function<void()> loader);
 
 	void set(const std::string& policy,
 			 const PolicyValue& value,
 			 const std::string& admin);
+	/// Set the values of policies in a single transaction of the storage.
+	void setMany(const std::vector<std::pair<std::string, PolicyValue>>& policies,
+				 const std::string& admin);
 	PolicyValue get(const std::string& policy);
+	/// Get the values of policies in the given order under a single lock.
+	std::vector<PolicyValue> getMany(const std::vector<std::string>& policies);
 	std::unordered_map<std::string, PolicyValue> getAll();
+	/// Get the names of policies including the lazy ones without loading.
+	std::vector<std::string> getNames();
 
 	std::unordered_map<std::string, int> getAdmins();
 
+	/// Register a listener which is called after policies or admins changed.
+	void addChangeListener(std::function<void()> listener);
+
 private:
 	explicit PolicyManager();
 	~PolicyManager() = default;
 
+	/// Policy models may query policies while they are changed.
+	std::recursive_mutex mutex;
+
 	PolicyStorage storage;
 	std::vector<std::shared_ptr<PolicyProvider>> providers;
 
 	const std::shared_ptr<PolicyModel>& getPolicy(const std::string& name);
 
+	/// Loaders are called without the lock, they add providers by themselves.
+	void resolve(const std::vector<std::string>& policies);
+	void resolveAll();
+
 	/// Policy-Provider
 	std::unordered_map<std::string, std::string> policies;
+	/// Policy-Loader of the providers which are not loaded yet
+	std::unordered_map<std::string, std::function<void()>> lazyPolicies;
+
+	/// Called after a write, e.g. to drop the cached results of tables.
+	void notifyChanged();
+	std::vector<std::function<void()>> listeners;
 
 	FRIEND_TEST(PolicyCoreTests, policy_get_policy);
 };
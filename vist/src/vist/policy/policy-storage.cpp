@@ -30,15 +30,33 @@ namespace {
 const std::string SCRIPT_BASE = SCRIPT_INSTALL_DIR;
 const std::string SCRIPT_CREATE_SCHEMA  = "create-schema";
 
+const std::vector<std::string> JOURNAL_MODES = {"DELETE", "TRUNCATE", "PERSIST", "WAL"};
+const std::vector<std::string> SYNCHRONOUS_LEVELS = {"OFF", "NORMAL", "FULL"};
+
+const std::string& pragma(const std::vector<std::string>& allowed, const std::string& value)
+{
+	auto iter = std::find(allowed.begin(), allowed.end(), value);
+	if (iter == allowed.end())
+		THROW(vist::ErrCode::LogicError) << "Not supported database option: " << value;
+
+	return *iter;
+}
+
 } // anonymous namespace
 
 namespace vist {
 namespace policy {
 
-PolicyStorage::PolicyStorage(const std::string& path) :
+PolicyStorage::PolicyStorage(const std::string& path) : PolicyStorage(path, Option())
+{
+}
+
+PolicyStorage::PolicyStorage(const std::string& path, const Option& option) :
 	database(std::make_shared<database::Connection>(path))
 {
 	database->exec("PRAGMA foreign_keys = ON;");
+	database->exec("PRAGMA journal_mode = " + pragma(JOURNAL_MODES, option.journalMode) + ";");
+	database->exec("PRAGMA synchronous = " + pragma(SYNCHRONOUS_LEVELS, option.synchronous) + ";");
 	database->transactionBegin();
 	database->exec(getScript(SCRIPT_CREATE_SCHEMA));
 	database->transactionEnd();
@@ -90,11 +108,11 @@ void PolicyStorage::syncPolicyManaged()
 	database::Statement stmt(*database, query);
 
 	while (stmt.step()) {
-		PolicyManaged pa;
-		pa.admin = std::string(stmt.getColumn(0));
-		pa.policy = std::string(stmt.getColumn(1));
-		pa.value = std::string(stmt.getColumn(2));
-		this->managedPolicies.emplace(pa.policy, std::move(pa));
+		ManagedValue managed;
+		managed.admin = std::string(stmt.getColumn(0));
+		std::string policy = std::string(stmt.getColumn(1));
+		managed.value = PolicyValue(std::string(stmt.getColumn(2)), true);
+		this->managedPolicies.emplace(std::move(policy), std::move(managed));
 	}
 
 	DEBUG(VIST) << managedPolicies.size() << "-managed-policies synced.";
@@ -220,22 +238,44 @@ bool PolicyStorage::isActivated()
 void PolicyStorage::update(const std::string& admin,
 						   const std::string& policy,
 						   const PolicyValue& value)
+{
+	this->update(admin, {{policy, value}});
+}
+
+void PolicyStorage::update(const std::string& admin,
+						   const std::vector<std::pair<std::string, PolicyValue>>& policies)
 {
 	DEBUG(VIST) << "Policy-update is called by admin: " << admin
-				<< ", about: " << policy << ", value: " << value.dump();
+				<< ", about " << policies.size() << "-policies";
 
 	if (this->admins.find(admin) == this->admins.end())
 		THROW(ErrCode::LogicError) << "Not exist admin: " << admin;
 
-	if (this->definitions.find(policy) == this->definitions.end())
-		THROW(ErrCode::LogicError) << "Not exist policy: " << policy;
+	for (const auto& [policy, value] : policies) {
+		if (this->definitions.find(policy) == this->definitions.end())
+			THROW(ErrCode::LogicError) << "Not exist policy: " << policy;
+	}
 
-	std::string query = schema::PolicyManagedTable.update(PolicyManaged::Value = value.dump())
-						.where(PolicyManaged::Admin == admin &&
-							   PolicyManaged::Policy == policy);
-	database::Statement stmt(*this->database, query);
-	if (!stmt.exec())
-		THROW(ErrCode::RuntimeError) << stmt.getErrorMessage();
+	/// A single journal sync for all of them.
+	this->database->transactionBegin();
+	try {
+		for (const auto& [policy, value] : policies) {
+			DEBUG(VIST) << "Update policy: " << policy << ", value: " << value.dump();
+			std::string query =
+				schema::PolicyManagedTable.update(PolicyManaged::Value = value.dump())
+				.where(PolicyManaged::Admin == admin && PolicyManaged::Policy == policy);
+			database::Statement stmt(*this->database, query);
+			if (!stmt.exec())
+				THROW(ErrCode::RuntimeError) << stmt.getErrorMessage();
+		}
+
+		this->database->transactionEnd();
+	} catch (...) {
+		/// SQLite may have rolled back already.
+		if (::sqlite3_get_autocommit(this->database->get()) == 0)
+			this->database->transactionRollback();
+		throw;
+	}
 
 	/// TODO: Fix to sync without db i/o
 	this->syncPolicyManaged();
@@ -251,28 +291,53 @@ PolicyValue PolicyStorage::strictest(const std::shared_ptr<PolicyModel>& policy)
 		return policy->getInitial();
 	}
 
-	std::shared_ptr<PolicyValue> strictestPtr = nullptr;
+	const auto& strictest = this->findStrictest(policy);
+	DEBUG(VIST) << "The strictest value of [" << policy->getName()
+				<< "] is " << strictest.dump();
+
+	return strictest;
+}
+
+std::vector<PolicyValue> PolicyStorage::strictest(
+	const std::vector<std::shared_ptr<PolicyModel>>& policies)
+{
+	for (const auto& policy : policies) {
+		if (this->definitions.find(policy->getName()) == this->definitions.end())
+			THROW(ErrCode::LogicError) << "Not exist policy: " << policy->getName();
+	}
+
+	std::vector<PolicyValue> values;
+	values.reserve(policies.size());
+
+	if (this->managedPolicies.size() == 0) {
+		INFO(VIST) << "There is no enrolled admin. Return policy initial values.";
+		for (const auto& policy : policies)
+			values.emplace_back(policy->getInitial());
+
+		return values;
+	}
+
+	for (const auto& policy : policies)
+		values.emplace_back(this->findStrictest(policy));
+
+	return values;
+}
+
+const PolicyValue& PolicyStorage::findStrictest(
+	const std::shared_ptr<PolicyModel>& policy) const
+{
+	const PolicyValue* strictest = nullptr;
 	auto range = managedPolicies.equal_range(policy->getName());
 	for (auto iter = range.first; iter != range.second; iter++) {
-		DEBUG(VIST) << "Admin: " << iter->second.admin << ", "
-					<< "Policy: " << iter->second.policy  << ", "
-					<< "Value: " << iter->second.value;
-
-		if (strictestPtr == nullptr) {
-			strictestPtr = std::make_shared<PolicyValue>(iter->second.value, true);
-		} else {
-			if (policy->compare(*strictestPtr, PolicyValue(iter->second.value, true)) > 0)
-				strictestPtr.reset(new PolicyValue(iter->second.value, true));
-		}
+		const auto& value = iter->second.value;
+		if (strictest == nullptr || policy->compare(*strictest, value) > 0)
+			strictest = &value;
 	}
 
-	if (strictestPtr == nullptr)
-		THROW(ErrCode::RuntimeError) << "Not exist managed policy: " << policy;
-
-	DEBUG(VIST) << "The strictest value of [" << policy->getName()
-				<< "] is " << strictestPtr->dump();
+	if (strictest == nullptr)
+		THROW(ErrCode::RuntimeError) << "Not exist managed policy: " << policy->getName();
 
-	return std::move(*strictestPtr);
+	return *strictest;
 }
 
 std::unordered_map<std::string, int> PolicyStorage::getAdmins() const noexcept
@@ -23,7 +23,10 @@
 #include "db-schema.hpp"
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace vist {
 namespace policy {
@@ -32,7 +35,15 @@ using namespace schema;
 
 class PolicyStorage final {
 public:
+	struct Option {
+		/// SQLite journal_mode: DELETE, TRUNCATE, PERSIST or WAL
+		std::string journalMode = "DELETE";
+		/// SQLite synchronous: OFF, NORMAL or FULL
+		std::string synchronous = "FULL";
+	};
+
 	explicit PolicyStorage(const std::string& path);
+	PolicyStorage(const std::string& path, const Option& option);
 
 	/// TODO(Sangwan): Consider to support lazy sync
 	void sync();
@@ -57,20 +68,33 @@ public:
 	void update(const std::string& admin,
 				const std::string& policy,
 				const PolicyValue& value);
+	/// Update the values of policies in a single transaction, all or nothing.
+	void update(const std::string& admin,
+				const std::vector<std::pair<std::string, PolicyValue>>& policies);
 
 	PolicyValue strictest(const std::shared_ptr<PolicyModel>& policy);
+	/// Resolve the strictest values of policies at once, in the given order.
+	std::vector<PolicyValue> strictest(
+		const std::vector<std::shared_ptr<PolicyModel>>& policies);
 
 	std::unordered_map<std::string, int> getAdmins() const noexcept;
 
 private:
 	std::string getScript(const std::string& name);
 
+	const PolicyValue& findStrictest(const std::shared_ptr<PolicyModel>& policy) const;
+
 	std::shared_ptr<database::Connection> database;
 
 	/// DB Cache objects
 	/// TODO(Sangwan): add locking mechanism
 	std::unordered_map<std::string, Admin> admins;
-	std::unordered_multimap<std::string, PolicyManaged> managedPolicies;
+	/// The values of admins are parsed once when synced.
+	struct ManagedValue {
+		std::string admin;
+		PolicyValue value;
+	};
+	std::unordered_multimap<std::string, ManagedValue> managedPolicies;
 	std::unordered_map<std::string, PolicyDefinition> definitions;
 };
 
@@ -19,6 +19,8 @@
 #include <vist/policy/policy-manager.hpp>
 #include <vist/service/vistd.hpp>
 
+#include <memory>
+
 namespace vist {
 namespace policy {
 
@@ -86,6 +88,34 @@ TEST(PolicyCoreTests, policy_get_all)
 	EXPECT_TRUE(policies.size() > 0);
 }
 
+TEST(PolicyCoreTests, policy_get_many)
+{
+	test::init();
+
+	auto& manager = PolicyManager::Instance();
+	manager.enroll("testAdmin");
+	manager.set("sample_int_policy", PolicyValue(10), "testAdmin");
+	manager.set("sample_str_policy", PolicyValue("AAA"), "testAdmin");
+
+	auto values = manager.getMany({"sample_str_policy", "sample_int_policy"});
+	ASSERT_EQ(values.size(), 2);
+	EXPECT_EQ(static_cast<std::string>(values[0]), "AAA");
+	EXPECT_EQ(static_cast<int>(values[1]), 10);
+
+	/// Same as the single lookups.
+	EXPECT_EQ(values[1].dump(), manager.get("sample_int_policy").dump());
+
+	bool raised = false;
+	try {
+		manager.getMany({"sample_int_policy", "fakePolicy"});
+	} catch (const vist::Exception<ErrCode>&) {
+		raised = true;
+	}
+	EXPECT_TRUE(raised);
+
+	manager.disenroll("testAdmin");
+}
+
 TEST(PolicyCoreTests, policy_get_policy)
 {
 	test::init();
@@ -103,6 +133,33 @@ TEST(PolicyCoreTests, policy_get_policy)
 	EXPECT_TRUE(raised);
 }
 
+TEST(PolicyCoreTests, change_listener)
+{
+	test::init();
+
+	auto& manager = PolicyManager::Instance();
+	/// Load the provider of the policy beforehand.
+	manager.get("sample_int_policy");
+
+	auto changed = std::make_shared<int>(0);
+	manager.addChangeListener([changed]() { (*changed)++; });
+
+	manager.enroll("testAdmin");
+	EXPECT_EQ(*changed, 1);
+
+	manager.set("sample_int_policy", PolicyValue(10), "testAdmin");
+	manager.setMany({{"sample_int_policy", PolicyValue(5)}}, "testAdmin");
+	EXPECT_EQ(*changed, 3);
+
+	/// Reads do not notify.
+	manager.get("sample_int_policy");
+	manager.getAll();
+	EXPECT_EQ(*changed, 3);
+
+	manager.disenroll("testAdmin");
+	EXPECT_EQ(*changed, 4);
+}
+
 TEST(PolicyCoreTests, admin)
 {
 	auto& manager = PolicyManager::Instance();
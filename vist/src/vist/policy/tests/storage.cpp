@@ -16,7 +16,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
 #include <memory>
+#include <string>
 
 #include <vist/policy/policy-storage.hpp>
 
@@ -156,3 +158,42 @@ TEST_F(PolicyStorageTests, activate_failed)
 	EXPECT_TRUE(isRaised);
 }
 
+TEST_F(PolicyStorageTests, update_batch)
+{
+	struct IntPolicy : public PolicyModel {
+		IntPolicy() : PolicyModel("sample_int_policy", PolicyValue(7)) {}
+		void onChanged(const PolicyValue&) override {}
+	};
+
+	auto storage = getStorage();
+	auto policy = std::make_shared<IntPolicy>();
+	storage->enroll("testAdmin");
+
+	storage->update("testAdmin", {{"sample_int_policy", PolicyValue(10)},
+								  {"sample_str_policy", PolicyValue("batch")}});
+	EXPECT_EQ(static_cast<int>(storage->strictest(policy)), 10);
+
+	/// Nothing is applied if any of them fails.
+	bool isRaised = false;
+	try {
+		storage->update("testAdmin", {{"sample_int_policy", PolicyValue(20)},
+									  {"FakePolicy", PolicyValue(0)}});
+	} catch (const std::exception&) {
+		isRaised = true;
+	}
+	EXPECT_TRUE(isRaised);
+	EXPECT_EQ(static_cast<int>(storage->strictest(policy)), 10);
+
+	storage->disenroll("testAdmin");
+}
+
+TEST_F(PolicyStorageTests, option)
+{
+	const std::string path = "/tmp/vist-test-wal.db";
+	EXPECT_NO_THROW(PolicyStorage(path, {"WAL", "NORMAL"}));
+	EXPECT_THROW(PolicyStorage(path, {"WAL", "SOMETIMES"}), std::exception);
+
+	std::remove(path.c_str());
+	std::remove((path + "-wal").c_str());
+	std::remove((path + "-shm").c_str());
+}
@@ -0,0 +1,334 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @brief   Columnar, typed result of a query.
+ * @details Column names are kept once as a header and each column keeps its
+ *          values in a vector of its own type. A column that receives cells
+ *          of mixed types (or NULL among numbers) falls back to text, which
+ *          is the same representation as the row based result.
+ * @usage
+ *  ResultSet result = Query::Fetch("SELECT name, value FROM policy");
+ *  auto& names = result.column<std::string>("name");
+ *  for (std::size_t i = 0; i < result.size(); i++)
+ *    std::string value = result.text(i, result.ordinal("value"));
+ */
+
+#pragma once
+
+#include <vist/archive.hpp>
+#include <vist/exception.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+namespace vist {
+
+using Row = std::map<std::string, std::string>;
+using Rows = std::vector<Row>;
+
+class ResultSet final : public Archival {
+public:
+	enum class Type : unsigned char {
+		Null = 0,
+		Integer,
+		Real,
+		Text
+	};
+
+	/// Set column header. The previous values are discarded.
+	inline void setNames(std::vector<std::string> names)
+	{
+		this->names = std::move(names);
+		this->columns.assign(this->names.size(), Column());
+	}
+
+	inline void append(std::size_t col, long long value)
+	{
+		this->columns.at(col).append(value);
+	}
+
+	inline void append(std::size_t col, double value)
+	{
+		this->columns.at(col).append(value);
+	}
+
+	inline void append(std::size_t col, std::string value)
+	{
+		this->columns.at(col).append(std::move(value));
+	}
+
+	inline void appendNull(std::size_t col)
+	{
+		this->columns.at(col).appendNull();
+	}
+
+	/// The number of rows.
+	inline std::size_t size() const noexcept
+	{
+		return this->columns.empty() ? 0 : this->columns.front().size();
+	}
+
+	inline bool empty() const noexcept
+	{
+		return this->size() == 0;
+	}
+
+	inline const std::vector<std::string>& getNames() const noexcept
+	{
+		return this->names;
+	}
+
+	inline std::size_t ordinal(const std::string& name) const
+	{
+		for (std::size_t i = 0; i < this->names.size(); i++)
+			if (this->names[i] == name)
+				return i;
+
+		THROW(ErrCode::LogicError) << "Not exist column: " << name;
+	}
+
+	inline Type type(std::size_t col) const
+	{
+		return this->columns.at(col).type;
+	}
+
+	/// Typed access to a whole column. (T: long long, double, std::string)
+	template <typename T>
+	const std::vector<T>& column(std::size_t col) const;
+
+	template <typename T>
+	const std::vector<T>& column(const std::string& name) const
+	{
+		return this->column<T>(this->ordinal(name));
+	}
+
+	/// Text representation of a cell. (Same as the row based result.)
+	inline std::string text(std::size_t row, std::size_t col) const
+	{
+		return this->columns.at(col).text(row);
+	}
+
+	/// Convert to the row based result.
+	inline Rows rows() const
+	{
+		Rows rows(this->size());
+		for (std::size_t col = 0; col < this->columns.size(); col++)
+			for (std::size_t row = 0; row < rows.size(); row++)
+				rows[row].emplace(this->names[col], this->columns[col].text(row));
+
+		return rows;
+	}
+
+	inline void pack(Archive& archive) const override
+	{
+		archive << this->names << this->columns;
+	}
+
+	inline void unpack(Archive& archive) override
+	{
+		archive >> this->names >> this->columns;
+	}
+
+private:
+	struct Column final : public Archival {
+		Type type = Type::Null;
+		/// The number of rows while type is Null.
+		std::size_t nulls = 0;
+
+		std::vector<long long> integers;
+		std::vector<double> reals;
+		std::vector<std::string> texts;
+
+		void append(long long value)
+		{
+			if (this->type == Type::Null && this->nulls == 0)
+				this->type = Type::Integer;
+
+			if (this->type == Type::Integer)
+				this->integers.push_back(value);
+			else
+				this->appendText(std::to_string(value));
+		}
+
+		void append(double value)
+		{
+			if (this->type == Type::Null && this->nulls == 0)
+				this->type = Type::Real;
+
+			if (this->type == Type::Real)
+				this->reals.push_back(value);
+			else
+				this->appendText(ResultSet::Format(value));
+		}
+
+		void append(std::string&& value)
+		{
+			this->appendText(std::move(value));
+		}
+
+		void appendNull()
+		{
+			if (this->type == Type::Null)
+				this->nulls++;
+			else
+				this->appendText(std::string());
+		}
+
+		void appendText(std::string&& value)
+		{
+			if (this->type != Type::Text)
+				this->toText();
+
+			this->texts.emplace_back(std::move(value));
+		}
+
+		void toText()
+		{
+			std::vector<std::string> converted;
+			converted.reserve(this->size() + 1);
+			for (std::size_t i = 0; i < this->size(); i++)
+				converted.emplace_back(this->text(i));
+
+			this->integers.clear();
+			this->reals.clear();
+			this->nulls = 0;
+			this->texts = std::move(converted);
+			this->type = Type::Text;
+		}
+
+		std::size_t size() const noexcept
+		{
+			switch (this->type) {
+			case Type::Integer:
+				return this->integers.size();
+			case Type::Real:
+				return this->reals.size();
+			case Type::Text:
+				return this->texts.size();
+			default:
+				return this->nulls;
+			}
+		}
+
+		std::string text(std::size_t row) const
+		{
+			switch (this->type) {
+			case Type::Integer:
+				return std::to_string(this->integers.at(row));
+			case Type::Real:
+				return ResultSet::Format(this->reals.at(row));
+			case Type::Text:
+				return this->texts.at(row);
+			default:
+				if (row >= this->nulls)
+					THROW(ErrCode::LogicError) << "Out of range: " << row;
+				return std::string();
+			}
+		}
+
+		void pack(Archive& archive) const override
+		{
+			archive << static_cast<unsigned char>(this->type);
+			switch (this->type) {
+			case Type::Integer:
+				archive << this->integers;
+				break;
+			case Type::Real:
+				archive << this->reals;
+				break;
+			case Type::Text:
+				archive << this->texts;
+				break;
+			default:
+				archive << this->nulls;
+			}
+		}
+
+		void unpack(Archive& archive) override
+		{
+			unsigned char type;
+			archive >> type;
+			this->type = static_cast<Type>(type);
+			switch (this->type) {
+			case Type::Integer:
+				archive >> this->integers;
+				break;
+			case Type::Real:
+				archive >> this->reals;
+				break;
+			case Type::Text:
+				archive >> this->texts;
+				break;
+			case Type::Null:
+				archive >> this->nulls;
+				break;
+			default:
+				THROW(ErrCode::ProtocolBroken) << "Invalid column type: " << static_cast<int>(type);
+			}
+		}
+	};
+
+	/// Keep '0.0' from double 0.0 instead of '0' like osquery does.
+	static std::string Format(double value)
+	{
+		std::string s = boost::lexical_cast<std::string>(value);
+		if (s.find('.') == std::string::npos)
+			s += ".0";
+
+		return s;
+	}
+
+	template <typename T>
+	const std::vector<T>& get(const Column& column) const;
+
+	std::vector<std::string> names;
+	std::vector<Column> columns;
+};
+
+template <>
+inline const std::vector<long long>& ResultSet::get(const Column& column) const
+{
+	return column.integers;
+}
+
+template <>
+inline const std::vector<double>& ResultSet::get(const Column& column) const
+{
+	return column.reals;
+}
+
+template <>
+inline const std::vector<std::string>& ResultSet::get(const Column& column) const
+{
+	return column.texts;
+}
+
+template <typename T>
+const std::vector<T>& ResultSet::column(std::size_t col) const
+{
+	const auto& column = this->columns.at(col);
+	constexpr Type expected = std::is_same<T, long long>::value ? Type::Integer :
+							  std::is_same<T, double>::value ? Type::Real : Type::Text;
+	if (column.type != expected)
+		THROW(ErrCode::BadCast) << "Column type is mismatched: " << this->names.at(col);
+
+	return this->get<T>(column);
+}
+
+} // namespace vist
@@ -34,17 +34,28 @@ public:
 	explicit Impl(Gateway& gateway, const std::string& path, Gateway::ServiceType type)
 	{
 		auto dispatcher = [&gateway](auto & message) -> Message {
-			std::string function = message.signature;
-			auto iter = gateway.functorMap.find(function);
-			if (iter == gateway.functorMap.end())
-				THROW(ErrCode::ProtocolBroken) << "Not found function: " << function;
+			bool indexed = (message.header.type == Message::Type::IndexedCall);
+			unsigned int id = indexed ? message.method : Message::Bind(message.signature);
 
-			DEBUG(VIST) << "Remote method invokation: " << function;
+			auto method = gateway.find(id);
+			if (method == nullptr || (!indexed && method->name != message.signature))
+				THROW(ErrCode::ProtocolBroken) << "Not found function: "
+											   << (indexed ? std::to_string(id) :
+												   message.signature);
 
-			auto functor = iter->second;
-			auto result = functor->invoke(message.buffer);
+			DEBUG(VIST) << "Remote method invokation: " << method->name;
 
-			Message reply(Message::Type::Reply, function);
+			auto result = method->functor->invoke(message.buffer);
+
+			/// The method id lets the client skip the signature from the next call.
+			/// It is sent only on request, other clients read the result directly.
+			if (message.header.type == Message::Type::BindingCall) {
+				Message reply(Message::Type::BoundReply, method->name);
+				reply.enclose(id, result);
+				return reply;
+			}
+
+			Message reply(Message::Type::Reply, method->name);
 			reply.enclose(result);
 
 			return reply;
@@ -74,6 +85,22 @@ Gateway::Gateway(const std::string& path, ServiceType type) :
 
 Gateway::~Gateway() = default;
 
+const Gateway::Method* Gateway::find(unsigned int id) const
+{
+	auto iter = this->methods.find(id);
+	return (iter == this->methods.end()) ? nullptr : &iter->second;
+}
+
+void Gateway::add(const std::string& name, std::shared_ptr<klass::AbstractFunctor>&& functor)
+{
+	auto id = Message::Bind(name);
+	if (auto method = this->find(id); method != nullptr && method->name != name)
+		THROW(ErrCode::LogicError) << "Method id of " << name
+								   << " collides with " << method->name;
+
+	this->methods[id] = {name, std::move(functor)};
+}
+
 void Gateway::start(int timeout, std::function<bool()> stopper)
 {
 	this->pImpl->start(timeout, stopper);
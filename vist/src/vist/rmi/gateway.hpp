@@ -25,6 +25,8 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace vist {
 namespace rmi {
@@ -56,15 +58,25 @@ public:
 private:
 	class Impl;
 
-	klass::FunctorMap functorMap;
+	struct Method {
+		std::string name;
+		std::shared_ptr<klass::AbstractFunctor> functor;
+	};
+
+	/// Return the method which is exposed with the id, or nullptr.
+	const Method* find(unsigned int id) const;
+	void add(const std::string& name, std::shared_ptr<klass::AbstractFunctor>&& functor);
+
+	/// Keyed by Message::Bind(name), clients call by id after the first call.
+	std::unordered_map<unsigned int, Method> methods;
+
 	std::unique_ptr<Impl> pImpl;
 };
 
 template<typename O, typename F>
 void Gateway::expose(O& object, const std::string& name, F&& func)
 {
-	auto functor = klass::make_functor_ptr(object, std::forward<F>(func));
-	this->functorMap[name] = functor;
+	this->add(name, klass::make_functor_ptr(object, std::forward<F>(func)));
 }
 
 } // namespace rmi
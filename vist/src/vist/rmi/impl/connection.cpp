@@ -60,7 +60,10 @@ Message Connection::recv(void) const
 
 	Message message(header);
 	this->socket.recv(message.getBuffer().data(), message.size());
-	message.disclose(message.signature);
+	if (header.type == Message::Type::IndexedCall)
+		message.disclose(message.method);
+	else
+		message.disclose(message.signature);
 
 	return message;
 }
@@ -16,6 +16,8 @@
 
 #include "message.hpp"
 
+#include <cstdint>
+
 namespace vist {
 namespace rmi {
 
@@ -26,11 +28,30 @@ Message::Message(unsigned int type, const std::string& signature) :
 	this->enclose(signature);
 }
 
+Message::Message(unsigned int type, unsigned int method) :
+	header({0, type, sizeof(method)}),
+	   method(method)
+{
+	this->enclose(method);
+}
+
 Message::Message(Header header) : header(header)
 {
 	this->buffer.resize(this->header.length);
 }
 
+unsigned int Message::Bind(const std::string& signature) noexcept
+{
+	/// 32-bit FNV-1a
+	std::uint32_t hash = 2166136261u;
+	for (unsigned char c : signature) {
+		hash ^= c;
+		hash *= 16777619u;
+	}
+
+	return (hash == Unbound) ? 1u : static_cast<unsigned int>(hash);
+}
+
 bool Message::success() const noexcept
 {
 	return !error();
@@ -31,9 +31,22 @@ struct VIST_API Message final {
 		MethodCall,
 		Reply,
 		Error,
-		Signal
+		Signal,
+		/// MethodCall which carries the method id instead of the signature
+		IndexedCall,
+		/// MethodCall whose reply carries the method id before the result
+		BindingCall,
+		/// Reply to BindingCall, which carries the method id before the result
+		BoundReply
 	};
 
+	/// The method id which is not assigned by the gateway.
+	static constexpr unsigned int Unbound = 0;
+
+	/// The method id is a hash of the signature, so it is kept over restarts
+	/// and upgrades of the gateway regardless of the order of exposure.
+	static unsigned int Bind(const std::string& signature) noexcept;
+
 	struct Header {
 		unsigned int id;
 		unsigned int type;
@@ -42,6 +55,7 @@ struct VIST_API Message final {
 
 	explicit Message(void) = default;
 	explicit Message(unsigned int type, const std::string& signature);
+	explicit Message(unsigned int type, unsigned int method);
 	explicit Message(Header header);
 
 	~Message(void) noexcept = default;
@@ -67,6 +81,7 @@ struct VIST_API Message final {
 
 	Header header;
 	std::string signature;
+	unsigned int method = Unbound;
 	Archive buffer;
 };
 
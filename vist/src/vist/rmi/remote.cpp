@@ -18,27 +18,97 @@
 
 #include <vist/rmi/impl/client.hpp>
 
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 namespace vist {
 namespace rmi {
 
 using namespace vist::rmi::impl;
 
+namespace {
+
+/// The method ids told by gateways, shared by the remotes of the process.
+class MethodTable final {
+public:
+	static MethodTable& Instance()
+	{
+		static MethodTable table;
+		return table;
+	}
+
+	unsigned int find(const std::string& path, const std::string& method)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto iter = this->ids.find({path, method});
+		return (iter == this->ids.end()) ? Message::Unbound : iter->second;
+	}
+
+	void bind(const std::string& path, const std::string& method, unsigned int id)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->ids[{path, method}] = id;
+	}
+
+	void unbind(const std::string& path, unsigned int id)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		for (auto iter = this->ids.begin(); iter != this->ids.end();) {
+			if (iter->first.first == path && iter->second == id)
+				iter = this->ids.erase(iter);
+			else
+				iter++;
+		}
+	}
+
+private:
+	std::mutex mutex;
+	std::map<std::pair<std::string, std::string>, unsigned int> ids;
+};
+
+} // anonymous namespace
+
 class Remote::Impl {
 public:
-	explicit Impl(const std::string& path) : client(path)
+	explicit Impl(const std::string& path) : path(path), client(path)
+	{
+	}
+
+	Message call(const std::string& method)
 	{
+		auto id = MethodTable::Instance().find(this->path, method);
+		if (id != Message::Unbound)
+			return Message(Message::Type::IndexedCall, id);
+
+		return Message(Message::Type::BindingCall, method);
 	}
 
 	Message request(Message& message)
 	{
-		return this->client.request(message);
+		auto reply = this->client.request(message);
+		if (reply.error()) {
+			/// The gateway may have been replaced, ask for the id again.
+			if (message.header.type == Message::Type::IndexedCall)
+				MethodTable::Instance().unbind(this->path, message.method);
+
+			return reply;
+		}
+
+		/// A gateway which does not know BindingCall replies the result only.
+		if (reply.header.type == Message::Type::BoundReply) {
+			unsigned int id;
+			reply.disclose(id);
+			MethodTable::Instance().bind(this->path, message.signature, id);
+		}
+
+		return reply;
 	}
 
 private:
+	std::string path;
 	Client client;
 };
 
@@ -48,6 +118,11 @@ Remote::Remote(const std::string& path) : pImpl(new Impl(path))
 
 Remote::~Remote() = default;
 
+Message Remote::call(const std::string& method)
+{
+	return pImpl->call(method);
+}
+
 Message Remote::request(Message& message)
 {
 	return pImpl->request(message);
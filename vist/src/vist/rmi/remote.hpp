@@ -54,6 +54,8 @@ public:
 	};
 
 private:
+	/// Make a call by the method id once the gateway told it.
+	Message call(const std::string& method);
 	Message request(Message& message);
 
 	class Impl;
@@ -63,7 +65,7 @@ private:
 template<typename R, typename... Args>
 R Remote::invoke(const std::string& method, Args&& ... args)
 {
-	Message message(Message::Type::MethodCall, method);
+	Message message = this->call(method);
 	message.enclose(std::forward<Args>(args)...);
 
 	Message reply = this->request(message);
@@ -16,7 +16,10 @@
 
 #include <vist/rmi/gateway.hpp>
 #include <vist/rmi/remote.hpp>
+#include <vist/rmi/impl/client.hpp>
+#include <vist/rmi/impl/server.hpp>
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -121,3 +124,134 @@ TEST(RmiTests, not_exist_method)
 	if (client.joinable())
 		client.join();
 }
+
+TEST(RmiTests, method_id)
+{
+	std::string sockPath = ("/tmp/test-gateway");
+
+	// gateway-side
+	Gateway gateway(sockPath);
+
+	Foo foo;
+	gateway.expose(foo, "Foo::setName", &Foo::setName);
+	gateway.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		// caller-side
+		Remote remote(sockPath);
+
+		// The first call is made by name, the others by the method id.
+		for (int i = 0; i < 3; i++) {
+			std::string param = "RMI-TEST-" + std::to_string(i);
+			EXPECT_EQ(remote.invoke<bool>("Foo::setName", param), false);
+			EXPECT_EQ(remote.invoke<std::string>("Foo::getName"), param);
+		}
+
+		// The ids are shared by the remotes of the process.
+		Remote other(sockPath);
+		EXPECT_EQ(other.invoke<std::string>("Foo::getName"), "RMI-TEST-2");
+
+		// A client which did not ask for the id gets the result only.
+		vist::rmi::impl::Client raw(sockPath);
+		Message call(Message::Type::MethodCall, "Foo::getName");
+		auto reply = raw.request(call);
+		std::string name;
+		reply.disclose(name);
+		EXPECT_EQ(name, "RMI-TEST-2");
+
+		// The id told by the gateway is the hash of the signature.
+		Message binding(Message::Type::BindingCall, "Foo::getName");
+		auto bound = raw.request(binding);
+		EXPECT_EQ(bound.header.type, Message::Type::BoundReply);
+		unsigned int id;
+		bound.disclose(id);
+		EXPECT_EQ(id, Message::Bind("Foo::getName"));
+
+		// Unknown method id
+		Message message(Message::Type::IndexedCall, 100u);
+		EXPECT_TRUE(raw.request(message).error());
+
+		gateway.stop();
+	});
+
+	gateway.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(RmiTests, method_id_restarted_gateway)
+{
+	std::string sockPath = ("/tmp/test-gateway-restart");
+
+	Foo foo;
+	Bar bar;
+	auto run = [&](Gateway& gateway, std::function<void()> caller) {
+		auto client = std::thread([&]() {
+			caller();
+			gateway.stop();
+		});
+
+		gateway.start();
+
+		if (client.joinable())
+			client.join();
+	};
+
+	{
+		Gateway gateway(sockPath);
+		gateway.expose(foo, "Foo::setName", &Foo::setName);
+		gateway.expose(foo, "Foo::getName", &Foo::getName);
+		gateway.expose(bar, "Bar::plusTwo", &Bar::plusTwo);
+
+		run(gateway, [&]() {
+			Remote remote(sockPath);
+			EXPECT_EQ(remote.invoke<bool>("Foo::setName", std::string("restart")), false);
+			EXPECT_EQ(remote.invoke<std::string>("Foo::getName"), "restart");
+			EXPECT_EQ(remote.invoke<int>("Bar::plusTwo", 1), 3);
+		});
+	}
+
+	// The cached ids still call the same methods in the other order of exposure.
+	{
+		Gateway gateway(sockPath);
+		gateway.expose(bar, "Bar::plusTwo", &Bar::plusTwo);
+		gateway.expose(foo, "Foo::getName", &Foo::getName);
+		gateway.expose(foo, "Foo::setName", &Foo::setName);
+
+		run(gateway, [&]() {
+			Remote remote(sockPath);
+			EXPECT_EQ(remote.invoke<std::string>("Foo::getName"), "restart");
+			EXPECT_EQ(remote.invoke<int>("Bar::plusTwo", 2), 4);
+		});
+	}
+}
+
+TEST(RmiTests, method_id_not_told)
+{
+	std::string sockPath = ("/tmp/test-gateway-old");
+
+	// A gateway which does not know BindingCall replies the result only.
+	auto task = [](Message& message) -> Message {
+		int number;
+		message.disclose(number);
+
+		Message reply(Message::Type::Reply, message.signature);
+		reply.enclose(number + 2);
+		return reply;
+	};
+
+	vist::rmi::impl::Server server(sockPath, task);
+	auto client = std::thread([&]() {
+		Remote remote(sockPath);
+		for (int i = 0; i < 3; i++)
+			EXPECT_EQ(remote.invoke<int>("Bar::plusTwo", i), i + 2);
+
+		server.stop();
+	});
+
+	server.run();
+
+	if (client.joinable())
+		client.join();
+}
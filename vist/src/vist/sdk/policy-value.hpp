@@ -14,20 +14,54 @@
  *  limitations under the License
  */
 
+/*
+ * @brief   Policy value in a compact tagged representation.
+ * @details The value is kept as an integer or a string and the dumped text
+ *          ("I/1000", "S/text") is produced only at the storage or SQL boundary.
+ */
+
 #pragma once
 
+#include <vist/archive.hpp>
+#include <vist/exception.hpp>
 #include <vist/stringfy.hpp>
 
+#include <cstdint>
+#include <exception>
 #include <string>
 
 namespace vist {
 namespace policy {
 
+/// Not Archival, so that it has no vtable. Archive uses the friend operators.
 struct PolicyValue final {
 	explicit PolicyValue() noexcept = default;
-	explicit PolicyValue(int value) : stringfied(Stringify::Dump(value)) {}
+	explicit PolicyValue(std::int64_t value) noexcept :
+		type(Stringify::Type::Integer), integer(value) {}
 	explicit PolicyValue(const std::string& value, bool dumped = false)
-		: stringfied(dumped ? value : Stringify::Dump(value)) {}
+	{
+		if (!dumped) {
+			this->type = Stringify::Type::String;
+			this->text = value;
+			return;
+		}
+
+		if (value.size() < 2 || value[1] != '/')
+			THROW(ErrCode::LogicError) << "Invalid format: " << value;
+
+		switch (static_cast<Stringify::Type>(value[0])) {
+		case Stringify::Type::Integer:
+			this->type = Stringify::Type::Integer;
+			this->integer = Parse(value);
+			break;
+		case Stringify::Type::String:
+			this->type = Stringify::Type::String;
+			this->text = value.substr(2);
+			break;
+		default:
+			THROW(ErrCode::LogicError) << "Invalid format: " << value;
+		}
+	}
 	~PolicyValue() = default;
 
 	PolicyValue(const PolicyValue&) = default;
@@ -36,28 +70,82 @@ struct PolicyValue final {
 	PolicyValue(PolicyValue&&) noexcept = default;
 	PolicyValue& operator=(PolicyValue&&) noexcept = default;
 
-	inline std::string dump() const noexcept
+	inline std::string dump() const
 	{
-		return this->stringfied;
+		switch (this->type) {
+		case Stringify::Type::Integer:
+			return "I/" + std::to_string(this->integer);
+		case Stringify::Type::String:
+			return "S/" + this->text;
+		default:
+			return std::string();
+		}
 	}
 
-	inline Stringify::Type getType() const
+	inline Stringify::Type getType() const noexcept
 	{
-		return Stringify::GetType(this->stringfied);
+		return this->type;
 	}
 
-	operator int() const
+	/// The only integer conversion, another one would make "value == 1" ambiguous.
+	operator std::int64_t() const
 	{
-		return Stringify::Restore(this->stringfied);
+		if (this->type != Stringify::Type::Integer)
+			THROW(ErrCode::TypeUnsafed) << "Type is not safed.";
+
+		return this->integer;
 	}
 
 	operator std::string() const
 	{
-		return Stringify::Restore(this->stringfied);
+		if (this->type != Stringify::Type::String)
+			THROW(ErrCode::TypeUnsafed) << "Type is not safed.";
+
+		return this->text;
+	}
+
+	bool operator==(const PolicyValue& rhs) const noexcept
+	{
+		return this->type == rhs.type && this->integer == rhs.integer && this->text == rhs.text;
+	}
+
+	bool operator!=(const PolicyValue& rhs) const noexcept
+	{
+		return !(*this == rhs);
+	}
+
+	friend Archive& operator<<(Archive& archive, const PolicyValue& value)
+	{
+		return archive << static_cast<char>(value.type) << value.integer << value.text;
+	}
+
+	friend Archive& operator>>(Archive& archive, PolicyValue& value)
+	{
+		char type;
+		archive >> type >> value.integer >> value.text;
+		value.type = static_cast<Stringify::Type>(type);
+
+		return archive;
 	}
 
 private:
-	std::string stringfied;
+	/// The whole text after the "I/" tag should be a number.
+	static std::int64_t Parse(const std::string& dumped)
+	{
+		try {
+			std::size_t pos = 0;
+			auto integer = std::stoll(dumped.substr(2), &pos);
+			if (pos == dumped.size() - 2)
+				return static_cast<std::int64_t>(integer);
+		} catch (const std::exception&) {
+		}
+
+		THROW(ErrCode::LogicError) << "Invalid format: " << dumped;
+	}
+
+	Stringify::Type type = Stringify::Type::None;
+	std::int64_t integer = 0;
+	std::string text;
 };
 
 } // namespace policy
@@ -71,6 +71,45 @@ TEST(PolicySDKTests, policy_value_dump)
 	EXPECT_EQ("S/TEXT", strValue.dump());
 }
 
+TEST(PolicySDKTests, policy_value_restore)
+{
+	PolicyValue intValue("I/1000", true);
+	EXPECT_EQ(Stringify::Type::Integer, intValue.getType());
+	EXPECT_EQ(static_cast<int>(intValue), 1000);
+	EXPECT_EQ(intValue, PolicyValue(1000));
+
+	PolicyValue strValue("S/TEXT", true);
+	EXPECT_EQ(static_cast<std::string>(strValue), "TEXT");
+	EXPECT_NE(strValue, PolicyValue("TEXT2"));
+
+	EXPECT_THROW(PolicyValue("X/1", true), vist::Exception<ErrCode>);
+	EXPECT_THROW(PolicyValue("I/", true), vist::Exception<ErrCode>);
+	EXPECT_THROW(PolicyValue("I/12x", true), vist::Exception<ErrCode>);
+	EXPECT_THROW(PolicyValue("I/99999999999999999999", true), vist::Exception<ErrCode>);
+	EXPECT_THROW(static_cast<std::string>(intValue), vist::Exception<ErrCode>);
+}
+
+TEST(PolicySDKTests, policy_value_int64)
+{
+	std::int64_t large = 1LL << 40;
+	PolicyValue value("I/" + std::to_string(large), true);
+	EXPECT_EQ(static_cast<std::int64_t>(value), large);
+	EXPECT_EQ(value.dump(), "I/" + std::to_string(large));
+	EXPECT_EQ(value, PolicyValue(large));
+}
+
+TEST(PolicySDKTests, policy_value_archive)
+{
+	Archive archive;
+	archive << PolicyValue(7) << PolicyValue("TEXT") << PolicyValue(std::int64_t(1) << 40);
+
+	PolicyValue intValue, strValue, largeValue;
+	archive >> intValue >> strValue >> largeValue;
+	EXPECT_EQ(static_cast<int>(intValue), 7);
+	EXPECT_EQ(static_cast<std::string>(strValue), "TEXT");
+	EXPECT_EQ(static_cast<std::int64_t>(largeValue), std::int64_t(1) << 40);
+}
+
 TEST(PolicySDKTests, policy_model)
 {
 	TestPolicyModel policy;
@@ -18,8 +18,13 @@
 
 #include <vist/service/vistd.hpp>
 #include <vist/policy/api.hpp>
+#include <vist/policy/policy-manager.hpp>
+#include <vist/notification/notification.hpp>
+
+#include <osquery/tables.h>
 
 #include <iostream>
+#include <map>
 #include <chrono>
 
 using namespace vist;
@@ -60,3 +65,60 @@ TEST_F(CoreTests, query_update)
 
 	policy::API::Admin::Disenroll("vist-test");
 }
+
+TEST_F(CoreTests, query_update_batch)
+{
+	policy::API::Admin::Enroll("vist-test");
+
+	static std::map<std::string, std::string> notified;
+	Notification::instance().add("policy", [](const Row& row) {
+		notified[row.at("name")] = row.at("value");
+	});
+
+	/// Both rows are applied in a single transaction and notified as rows.
+	std::string statement = "UPDATE policy SET value = "
+							"CASE name WHEN 'sample_int_policy' THEN 'I/10' ELSE 'S/batch' END "
+							"WHERE name IN ('sample_int_policy', 'sample_str_policy')";
+	notified.clear();
+	Vistd::Query(statement);
+	EXPECT_EQ(notified.size(), 2);
+	EXPECT_EQ(notified["sample_int_policy"], "I/10");
+	EXPECT_EQ(notified["sample_str_policy"], "S/batch");
+
+	statement = "SELECT * FROM policy WHERE name = 'sample_int_policy'";
+	auto rows = Vistd::Query(statement);
+	EXPECT_EQ(rows[0]["value"], "I/10");
+
+	policy::API::Admin::Disenroll("vist-test");
+}
+
+TEST_F(CoreTests, query_policy_uncached)
+{
+	policy::API::Admin::Enroll("vist-test");
+
+	std::string statement = "SELECT * FROM policy WHERE name = 'sample_int_policy'";
+	auto rows = Vistd::Query(statement);
+	auto hits = osquery::TableCache::instance().getStats("policy").hits;
+
+	/// The policy table is not cached.
+	EXPECT_EQ(Vistd::Query(statement), rows);
+	EXPECT_EQ(osquery::TableCache::instance().getStats("policy").hits, hits);
+
+	/// A write which bypasses the virtual table is visible to the next query.
+	policy::PolicyManager::Instance().set("sample_int_policy",
+										  policy::PolicyValue(11), "vist-test");
+	rows = Vistd::Query(statement);
+	EXPECT_EQ(rows[0]["value"], "I/11");
+
+	policy::API::Admin::Disenroll("vist-test");
+}
+
+TEST_F(CoreTests, query_fetch)
+{
+	std::string statement = "SELECT * FROM policy WHERE name = 'sample_int_policy'";
+	auto result = Vistd::Fetch(statement);
+
+	EXPECT_EQ(result.size(), 1);
+	EXPECT_EQ(result.rows(), Vistd::Query(statement));
+	EXPECT_EQ(result.column<std::string>("name").front(), "sample_int_policy");
+}
@@ -23,17 +23,69 @@
 #include <vist/policy/policy-manager.hpp>
 #include <vist/rmi/gateway.hpp>
 #include <vist/table/dynamic-table.hpp>
+#include <vist/table/lazy-table.hpp>
+#include <vist/table/manifest.hpp>
 
 #include <tables/built-in/policy-admin.hpp>
 #include <tables/built-in/policy.hpp>
 
+#include <osquery/registry.h>
 #include <osquery/registry_interface.h>
 #include <osquery/sql.h>
+#include <osquery/tables.h>
 
+#include <algorithm>
 #include <filesystem>
 
 namespace {
+
 const std::string SOCK_ADDR = "/tmp/.vist";
+
+std::vector<std::string> difference(std::vector<std::string> after,
+									std::vector<std::string> before)
+{
+	std::sort(after.begin(), after.end());
+	std::sort(before.begin(), before.end());
+
+	std::vector<std::string> added;
+	std::set_difference(after.begin(), after.end(), before.begin(), before.end(),
+						std::back_inserter(added));
+	return added;
+}
+
+/// Load the library and record what it registers.
+vist::table::Manifest::Library loadLibrary(const std::string& path)
+{
+	using namespace vist;
+
+	auto& registry = osquery::RegistryFactory::get();
+	auto& pm = policy::PolicyManager::Instance();
+	auto tables = registry.names("table");
+	auto policies = pm.getNames();
+
+	DynamicLoader loader(path);
+	auto factory = loader.load<table::DynamicTable::FactoryType>("DynamicTableFactory");
+	std::unique_ptr<table::DynamicTable> dynamic((*factory)());
+	if (dynamic == nullptr)
+		THROW(ErrCode::RuntimeError) << "Failed to load table: " << path;
+
+	dynamic->init();
+
+	table::Manifest::Library library;
+	library.path = path;
+	library.stamp = table::Manifest::Stamp(path);
+	library.policies = difference(pm.getNames(), policies);
+
+	for (auto& name : difference(registry.names("table"), tables)) {
+		auto plugin = std::dynamic_pointer_cast<osquery::TablePlugin>(
+						  registry.plugin("table", name));
+		if (plugin != nullptr)
+			library.tables.push_back(table::Manifest::Table {name, plugin->columns()});
+	}
+
+	return library;
+}
+
 } // anonymous namespace
 
 namespace vist {
@@ -45,6 +97,11 @@ Vistd::Vistd()
 	this->loadStaticTable();
 	this->loadDynamicTable();
 
+	/// Writes through the policy API bypass the virtual tables.
+	policy::PolicyManager::Instance().addChangeListener([]() {
+		osquery::TableCache::instance().invalidateAll();
+	});
+
 	policy::API::Admin::Enroll(DEFAULT_POLICY_ADMIN);
 }
 
@@ -60,6 +117,7 @@ void Vistd::start()
 
 	rmi::Gateway gateway(SOCK_ADDR, type);
 	EXPOSE(gateway, *this, &Vistd::query);
+	EXPOSE(gateway, *this, &Vistd::fetch);
 
 	auto& pm = policy::PolicyManager::Instance();
 
@@ -84,6 +142,17 @@ Rows Vistd::query(const std::string& statement)
 	return sql.rows();
 }
 
+ResultSet Vistd::fetch(const std::string& statement)
+{
+	DEBUG(VIST) << "Excute query: " << statement;
+	ResultSet result;
+	auto status = osquery::queryColumnar(statement, result, true);
+	if (!status.ok())
+		THROW(ErrCode::RuntimeError) << "Faild to execute query: " << status.getMessage();
+
+	return result;
+}
+
 void Vistd::loadStaticTable()
 {
 	table::PolicyAdminTable::Init();
@@ -92,17 +161,36 @@ void Vistd::loadStaticTable()
 
 void Vistd::loadDynamicTable()
 {
+	auto manifest = table::Manifest::Load(TABLE_MANIFEST_PATH);
+
+	table::Manifest updated;
+	bool changed = false;
 	for (auto& iter : std::filesystem::directory_iterator(TABLE_INSTALL_DIR)) {
-		DEBUG(VIST) << "Load dynamic table: " << iter.path();
-		DynamicLoader loader(iter.path());
-		auto factory = loader.load<table::DynamicTable::FactoryType>("DynamicTableFactory");
-		if (auto table = (*factory)(); table != nullptr) {
-			table->init();
-			delete table;
-		} else {
-			ERROR(VIST) << "Failed to load table.";
+		std::string path = iter.path();
+		try {
+			/// Known library is registered without loading it.
+			if (auto library = manifest.find(path, table::Manifest::Stamp(path)); library) {
+				table::LazyLibrary::Register(*library);
+				updated.libraries.push_back(*library);
+				continue;
+			}
+
+			DEBUG(VIST) << "Load dynamic table: " << path;
+			updated.libraries.emplace_back(loadLibrary(path));
+			changed = true;
+		} catch (const std::exception& e) {
+			ERROR(VIST) << "Failed to load table[" << path << "]: " << e.what();
 		}
 	}
+
+	if (!changed && updated.libraries.size() == manifest.libraries.size())
+		return;
+
+	try {
+		updated.save(TABLE_MANIFEST_PATH);
+	} catch (const std::exception& e) {
+		WARN(VIST) << "Failed to save table manifest: " << e.what();
+	}
 }
 
 } // namespace vist
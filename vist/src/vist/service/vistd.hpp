@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vist/result-set.hpp>
+
 #include <map>
 #include <memory>
 #include <string>
@@ -23,9 +25,6 @@
 
 namespace vist {
 
-using Row = std::map<std::string, std::string>;
-using Rows = std::vector<Row>;
-
 class Vistd final : public std::enable_shared_from_this<Vistd> {
 public:
 	Vistd(const Vistd&) = delete;
@@ -36,6 +35,8 @@ public:
 
 	/// Exposed method (API)
 	Rows query(const std::string& statement);
+	/// Columnar variant of query(), values are kept as typed columns.
+	ResultSet fetch(const std::string& statement);
 
 	static Vistd& Instance()
 	{
@@ -48,6 +49,11 @@ public:
 		return Vistd::Instance().query(statement);
 	}
 
+	static ResultSet Fetch(const std::string& statement)
+	{
+		return Vistd::Instance().fetch(statement);
+	}
+
 	static void Start()
 	{
 		Vistd::Instance().start();
@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+#include "lazy-table.hpp"
+
+#include <vist/dynamic-loader.hpp>
+#include <vist/exception.hpp>
+#include <vist/logger.hpp>
+#include <vist/policy/policy-manager.hpp>
+#include <vist/table/dynamic-table.hpp>
+#include <vist/table/util.hpp>
+
+#include <osquery/registry.h>
+
+namespace vist {
+namespace table {
+
+LazyLibrary::LazyLibrary(const Manifest::Library& manifest) : manifest(manifest)
+{
+}
+
+void LazyLibrary::Register(const Manifest::Library& manifest)
+{
+	auto library = std::make_shared<LazyLibrary>(manifest);
+
+	auto registry = RegistryFactory::get().registry("table");
+	for (const auto& table : manifest.tables) {
+		auto status = registry->add(table.name, std::make_shared<LazyTable>(library, table.columns));
+		if (!status.ok())
+			ERROR(VIST) << "Failed to register table[" << table.name << "]: " << status.getMessage();
+	}
+
+	if (!manifest.policies.empty())
+		policy::PolicyManager::Instance().addLazyPolicies(manifest.policies,
+														 [library]() { library->load(); });
+
+	DEBUG(VIST) << "Registered " << manifest.tables.size() << "-tables without loading: "
+				<< manifest.path;
+}
+
+void LazyLibrary::load()
+{
+	if (this->loaded)
+		return;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->loaded)
+		return;
+
+	INFO(VIST) << "Load dynamic table on demand: " << this->manifest.path;
+
+	DynamicLoader loader(this->manifest.path);
+	auto factory = loader.load<DynamicTable::FactoryType>("DynamicTableFactory");
+	std::unique_ptr<DynamicTable> dynamic((*factory)());
+	if (dynamic == nullptr)
+		THROW(ErrCode::RuntimeError) << "Failed to load table: " << this->manifest.path;
+
+	/// The library registers the real tables with the same names.
+	auto registry = RegistryFactory::get().registry("table");
+	std::unordered_map<std::string, PluginRef> proxies;
+	for (const auto& table : this->manifest.tables) {
+		proxies[table.name] = registry->plugin(table.name);
+		registry->remove(table.name);
+	}
+
+	/// The proxies are registered again if the library fails.
+	auto restore = [&]() {
+		for (const auto& [name, proxy] : proxies) {
+			registry->remove(name);
+			if (proxy != nullptr)
+				registry->add(name, proxy);
+		}
+		this->tables.clear();
+	};
+
+	try {
+		dynamic->init();
+
+		for (const auto& table : this->manifest.tables) {
+			auto plugin = std::dynamic_pointer_cast<TablePlugin>(registry->plugin(table.name));
+			if (plugin == nullptr)
+				THROW(ErrCode::RuntimeError) << "Library[" << this->manifest.path
+											 << "] does not have the table: " << table.name;
+
+			this->tables[table.name] = std::move(plugin);
+		}
+	} catch (...) {
+		restore();
+		throw;
+	}
+
+	this->loaded = true;
+}
+
+std::shared_ptr<TablePlugin> LazyLibrary::get(const std::string& table)
+{
+	this->load();
+	return this->tables.at(table);
+}
+
+std::shared_ptr<TablePlugin> LazyLibrary::peek(const std::string& table) const
+{
+	if (!this->loaded)
+		return nullptr;
+
+	return this->tables.at(table);
+}
+
+size_t LazyTable::cacheTTL() const
+{
+	auto table = this->library->peek(this->getName());
+	return (table != nullptr) ? table->cacheTTL() : 0;
+}
+
+QueryData LazyTable::select(QueryContext& context)
+{
+	TABLE_EXCEPTION_GUARD_START
+
+	return this->library->get(this->getName())->select(context);
+
+	TABLE_EXCEPTION_GUARD_END
+}
+
+std::unique_ptr<RowGenerator> LazyTable::generate(QueryContext& context)
+{
+	/// Failure to load is reported by select().
+	try {
+		return this->library->get(this->getName())->generate(context);
+	} catch (const std::exception& e) {
+		ERROR(VIST) << "Failed to load table[" << this->getName() << "]: " << e.what();
+		return nullptr;
+	}
+}
+
+QueryData LazyTable::insert(QueryContext& context, const PluginRequest& request)
+{
+	TABLE_EXCEPTION_GUARD_START
+
+	return this->library->get(this->getName())->insert(context, request);
+
+	TABLE_EXCEPTION_GUARD_END
+}
+
+QueryData LazyTable::update(QueryContext& context, const PluginRequest& request)
+{
+	TABLE_EXCEPTION_GUARD_START
+
+	return this->library->get(this->getName())->update(context, request);
+
+	TABLE_EXCEPTION_GUARD_END
+}
+
+QueryData LazyTable::delete_(QueryContext& context, const PluginRequest& request)
+{
+	TABLE_EXCEPTION_GUARD_START
+
+	return this->library->get(this->getName())->delete_(context, request);
+
+	TABLE_EXCEPTION_GUARD_END
+}
+
+Status LazyTable::begin()
+{
+	return this->forward([](TablePlugin& table) { return table.begin(); });
+}
+
+Status LazyTable::sync()
+{
+	return this->forward([](TablePlugin& table) { return table.sync(); });
+}
+
+Status LazyTable::commit()
+{
+	return this->forward([](TablePlugin& table) { return table.commit(); });
+}
+
+Status LazyTable::rollback()
+{
+	return this->forward([](TablePlugin& table) { return table.rollback(); });
+}
+
+Status LazyTable::forward(const std::function<Status(TablePlugin&)>& call)
+{
+	try {
+		return call(*this->library->get(this->getName()));
+	} catch (const std::exception& e) {
+		ERROR(VIST) << "Failed to load table[" << this->getName() << "]: " << e.what();
+		return Status::failure(e.what());
+	}
+}
+
+} // namespace table
+} // namespace vist
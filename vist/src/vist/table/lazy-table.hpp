@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * Dynamic table which is registered from the manifest without loading.
+ *   - LazyTable has the schema only, so the table can be attached.
+ *   - The library is loaded when one of its tables or policies is used first,
+ *     then the proxies are replaced by the real tables in the registry.
+ *   - Virtual tables which were attached with a proxy keep forwarding to it.
+ */
+
+#pragma once
+
+#include <vist/table/manifest.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <osquery/tables.h>
+
+namespace vist {
+namespace table {
+
+class LazyLibrary final : public std::enable_shared_from_this<LazyLibrary> {
+public:
+	explicit LazyLibrary(const Manifest::Library& manifest);
+
+	/// Register the proxy tables and the policies of the library.
+	static void Register(const Manifest::Library& manifest);
+
+	/// Load the library once. Concurrent callers wait for the first one.
+	void load();
+
+	/// Return the real table after loading the library.
+	std::shared_ptr<osquery::TablePlugin> get(const std::string& table);
+	/// Return the real table if the library is loaded, nullptr otherwise.
+	std::shared_ptr<osquery::TablePlugin> peek(const std::string& table) const;
+
+private:
+	Manifest::Library manifest;
+
+	std::mutex mutex;
+	std::atomic<bool> loaded = false;
+	std::unordered_map<std::string, std::shared_ptr<osquery::TablePlugin>> tables;
+};
+
+class LazyTable final : public osquery::TablePlugin {
+public:
+	LazyTable(std::shared_ptr<LazyLibrary> library, osquery::TableColumns columns) :
+		library(std::move(library)), schema(std::move(columns)) {}
+
+	osquery::TableColumns columns() const override
+	{
+		return this->schema;
+	}
+
+	size_t cacheTTL() const override;
+
+	osquery::QueryData select(osquery::QueryContext& context) override;
+	std::unique_ptr<osquery::RowGenerator> generate(osquery::QueryContext& context) override;
+
+	osquery::QueryData insert(osquery::QueryContext& context,
+							  const osquery::PluginRequest& request) override;
+	osquery::QueryData update(osquery::QueryContext& context,
+							  const osquery::PluginRequest& request) override;
+	osquery::QueryData delete_(osquery::QueryContext& context,
+							   const osquery::PluginRequest& request) override;
+
+	osquery::Status begin() override;
+	osquery::Status sync() override;
+	osquery::Status commit() override;
+	osquery::Status rollback() override;
+
+private:
+	/// Failure to load the library is returned as a status.
+	osquery::Status forward(const std::function<osquery::Status(osquery::TablePlugin&)>& call);
+
+	std::shared_ptr<LazyLibrary> library;
+	osquery::TableColumns schema;
+};
+
+} // namespace table
+} // namespace vist
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+#include "manifest.hpp"
+
+#include <vist/exception.hpp>
+#include <vist/json.hpp>
+#include <vist/logger.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace vist {
+namespace table {
+
+Manifest Manifest::Load(const std::string& path)
+{
+	Manifest manifest;
+
+	std::ifstream file(path);
+	if (!file)
+		return manifest;
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+
+	try {
+		auto document = json::Document::Parse(buffer.str());
+		for (auto node : document.root()["libraries"]) {
+			Library library;
+			library.path = node["path"].get<std::string>();
+			library.stamp = node["stamp"].get<std::string>();
+
+			for (auto table : node["tables"]) {
+				Table schema;
+				schema.name = table["name"].get<std::string>();
+				for (auto column : table["columns"]) {
+					auto type = osquery::columnTypeName(column["type"].get<std::string>());
+					auto options = static_cast<osquery::ColumnOptions>(column["options"].get<int>());
+					schema.columns.emplace_back(column["name"].get<std::string>(), type, options);
+				}
+
+				library.tables.emplace_back(std::move(schema));
+			}
+
+			for (auto policy : node["policies"])
+				library.policies.emplace_back(policy.get<std::string>());
+
+			manifest.libraries.emplace_back(std::move(library));
+		}
+	} catch (const std::exception& e) {
+		WARN(VIST) << "Ignore the broken table manifest: " << e.what();
+		return Manifest();
+	}
+
+	return manifest;
+}
+
+std::string Manifest::Stamp(const std::string& path)
+{
+	auto size = std::filesystem::file_size(path);
+	auto mtime = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+	return std::to_string(size) + "-" + std::to_string(mtime);
+}
+
+void Manifest::save(const std::string& path) const
+{
+	json::Array libraries;
+	for (const auto& library : this->libraries) {
+		json::Array tables;
+		for (const auto& table : library.tables) {
+			json::Array columns;
+			for (const auto& [name, type, options] : table.columns) {
+				json::Object column;
+				column["name"] = name;
+				column["type"] = osquery::columnTypeName(type);
+				column["options"] = static_cast<int>(options);
+				columns.push(column);
+			}
+
+			json::Object schema;
+			schema["name"] = table.name;
+			schema.push("columns", columns);
+			tables.push(schema);
+		}
+
+		json::Array policies;
+		for (const auto& policy : library.policies)
+			policies.push(policy);
+
+		json::Object entry;
+		entry["path"] = library.path;
+		entry["stamp"] = library.stamp;
+		entry.push("tables", tables);
+		entry.push("policies", policies);
+		libraries.push(entry);
+	}
+
+	json::Json document;
+	document.push("libraries", libraries);
+
+	/// Replace the previous one at once, readers never see a partial file.
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		file << document.dump();
+		if (!file)
+			THROW(ErrCode::RuntimeError) << "Failed to write table manifest: " << temporary;
+	}
+
+	if (std::rename(temporary.c_str(), path.c_str()) != 0)
+		THROW(ErrCode::RuntimeError) << "Failed to replace table manifest: " << path;
+}
+
+const Manifest::Library* Manifest::find(const std::string& path,
+										const std::string& stamp) const
+{
+	for (const auto& library : this->libraries)
+		if (library.path == path && library.stamp == stamp)
+			return &library;
+
+	return nullptr;
+}
+
+} // namespace table
+} // namespace vist
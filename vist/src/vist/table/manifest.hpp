@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2020-present Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * Manifest of the dynamic table libraries.
+ *   - It keeps what each library registers: table schemas and policy names.
+ *   - An entry is valid while the stamp (size, mtime) of the library matches,
+ *     so the library can be registered without loading it.
+ */
+/*
+ * Usage:
+ *     auto manifest = Manifest::Load(TABLE_MANIFEST_PATH);
+ *     auto stamp = Manifest::Stamp(path);
+ *     if (auto library = manifest.find(path, stamp); library != nullptr)
+ *       ... register the schemas of library->tables
+ *
+ *     manifest.save(TABLE_MANIFEST_PATH);
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <osquery/tables.h>
+
+namespace vist {
+namespace table {
+
+struct Manifest {
+	struct Table {
+		std::string name;
+		osquery::TableColumns columns;
+	};
+
+	struct Library {
+		std::string path;
+		std::string stamp;
+		std::vector<Table> tables;
+		std::vector<std::string> policies;
+	};
+
+	/// Missing or broken manifest is treated as empty.
+	static Manifest Load(const std::string& path);
+	/// Return the stamp of the library which is changed when it is replaced.
+	static std::string Stamp(const std::string& path);
+
+	void save(const std::string& path) const;
+
+	/// Return the entry about the library only if the stamp matches.
+	const Library* find(const std::string& path, const std::string& stamp) const;
+
+	std::vector<Library> libraries;
+};
+
+} // namespace table
+} // namespace vist
@@ -17,31 +17,74 @@
 #pragma once
 
 #include <vist/exception.hpp>
-#include <vist/json.hpp>
+#include <vist/json/document.hpp>
 
 #include <osquery/tables.h>
 
+#include <string>
+#include <vector>
+
 using namespace osquery;
 
 namespace vist {
 namespace table {
 
-struct Parser {
-
-	template <typename T>
-	static auto column(const PluginRequest& request, std::size_t index) -> T
+/// The column values of an INSERT, UPDATE or DELETE request.
+/// json_values is decoded once, and the columns are addressed by index.
+class ParsedRequest final {
+public:
+	explicit ParsedRequest(const PluginRequest& request)
 	{
-		if (request.count("json_values") == 0)
+		auto iter = request.find("json_values");
+		if (iter == request.end())
 			THROW(ErrCode::LogicError) << "Wrong request format. Not found json value.";
 
-		json::Json document = json::Json::Parse(request.at("json_values"));
-		json::Array values = document.get<json::Array>("values");
-		if (values.size() < index)
-			THROW(ErrCode::LogicError) << "Wrong index.";
+		try {
+			this->document = json::Document::Parse(iter->second);
+			auto values = this->document.root()["values"];
+			this->values.reserve(values.size());
+			for (auto value : values)
+				this->values.emplace_back(value);
+		} catch (const std::exception& e) {
+			THROW(ErrCode::LogicError) << "Wrong request format: " << e.what();
+		}
+	}
+
+	/// The nodes refer to the document of this object.
+	ParsedRequest(const ParsedRequest&) = delete;
+	ParsedRequest& operator=(const ParsedRequest&) = delete;
+
+	std::size_t size() const noexcept
+	{
+		return this->values.size();
+	}
+
+	/// T: int, long long, double, std::string, std::string_view
+	template <typename T>
+	T column(std::size_t index) const
+	{
+		if (index >= this->values.size())
+			THROW(ErrCode::LogicError) << "Wrong index: " << index;
 
-		return static_cast<T>(values.at(index));
+		try {
+			return this->values[index].get<T>();
+		} catch (const std::exception& e) {
+			THROW(ErrCode::LogicError) << "Wrong column type at " << index << ": " << e.what();
+		}
 	}
 
+private:
+	json::Document document;
+	std::vector<json::Document::Node> values;
+};
+
+struct Parser {
+	/// Prefer ParsedRequest to read more than one column.
+	template <typename T>
+	static auto column(const PluginRequest& request, std::size_t index) -> T
+	{
+		return ParsedRequest(request).column<T>(index);
+	}
 };
 
 } // namespace table
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+#include <gtest/gtest.h>
+
+#include <vist/table/lazy-table.hpp>
+
+#include <osquery/registry.h>
+
+using namespace osquery;
+using namespace vist::table;
+
+TEST(LazyTableTests, load_failed)
+{
+	Manifest::Library library;
+	library.path = "/tmp/libvist-not-exist.so";
+	library.tables.push_back({"lazy_missing", {
+		std::make_tuple("value", TEXT_TYPE, ColumnOptions::DEFAULT)
+	}});
+	LazyLibrary::Register(library);
+
+	auto registry = RegistryFactory::get().registry("table");
+	auto proxy = std::dynamic_pointer_cast<TablePlugin>(registry->plugin("lazy_missing"));
+	ASSERT_NE(proxy, nullptr);
+
+	/// A failure to load is returned to the query instead of thrown.
+	QueryContext context;
+	EXPECT_EQ(proxy->generate(context), nullptr);
+	EXPECT_NO_THROW(proxy->select(context));
+	EXPECT_FALSE(proxy->begin().ok());
+
+	/// The proxy stays registered for the next connection.
+	EXPECT_EQ(registry->plugin("lazy_missing"), proxy);
+	registry->remove("lazy_missing");
+}
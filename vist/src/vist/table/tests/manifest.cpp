@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+#include <gtest/gtest.h>
+
+#include <vist/table/manifest.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace osquery;
+using namespace vist::table;
+
+TEST(TableManifestTests, save_and_load)
+{
+	const std::string path = "/tmp/vist-test-manifest.json";
+
+	Manifest::Library library;
+	library.path = "/tmp/libvist-sample.so";
+	library.stamp = "100-200";
+	library.tables.push_back({"sample_policy", {
+		std::make_tuple("sample_int_policy", INTEGER_TYPE, ColumnOptions::DEFAULT),
+		std::make_tuple("sample_str_policy", TEXT_TYPE, ColumnOptions::INDEX)
+	}});
+	library.policies = {"sample_int_policy", "sample_str_policy"};
+
+	Manifest manifest;
+	manifest.libraries.push_back(library);
+	manifest.save(path);
+
+	auto loaded = Manifest::Load(path);
+	std::remove(path.c_str());
+
+	EXPECT_EQ(loaded.find(library.path, "100-201"), nullptr);
+
+	auto found = loaded.find(library.path, library.stamp);
+	ASSERT_NE(found, nullptr);
+	ASSERT_EQ(found->tables.size(), 1);
+	EXPECT_EQ(found->tables[0].name, "sample_policy");
+	EXPECT_EQ(found->tables[0].columns, library.tables[0].columns);
+	EXPECT_EQ(found->policies, library.policies);
+}
+
+TEST(TableManifestTests, load_broken)
+{
+	const std::string path = "/tmp/vist-test-manifest.json";
+	EXPECT_TRUE(Manifest::Load(path).libraries.empty());
+
+	std::ofstream(path) << "{ \"libraries\": [ { \"path\": 1 } ] }";
+	EXPECT_TRUE(Manifest::Load(path).libraries.empty());
+	std::remove(path.c_str());
+}
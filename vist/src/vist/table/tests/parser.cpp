@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+
+#include <gtest/gtest.h>
+
+#include <vist/exception.hpp>
+#include <vist/table/parser.hpp>
+
+using namespace vist;
+using namespace vist::table;
+
+TEST(TableParserTests, parsed_request)
+{
+	PluginRequest request;
+	request["json_values"] = "{ \"values\": [ \"admin\", 1, 2.5 ] }";
+
+	ParsedRequest values(request);
+	EXPECT_EQ(values.size(), 3);
+	EXPECT_EQ(values.column<std::string>(0), "admin");
+	EXPECT_EQ(values.column<int>(1), 1);
+	EXPECT_EQ(values.column<double>(2), 2.5);
+
+	EXPECT_EQ(Parser::column<int>(request, 1), 1);
+}
+
+TEST(TableParserTests, parsed_request_failed)
+{
+	PluginRequest request;
+	EXPECT_THROW(ParsedRequest{request}, vist::Exception<ErrCode>);
+
+	request["json_values"] = "{ \"values\": [ \"admin\" ] }";
+	ParsedRequest values(request);
+	EXPECT_THROW(values.column<std::string>(1), vist::Exception<ErrCode>);
+	EXPECT_THROW(values.column<int>(0), vist::Exception<ErrCode>);
+}
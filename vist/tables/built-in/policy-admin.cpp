@@ -94,6 +94,8 @@ QueryData PolicyAdminTable::select(QueryContext& context)
 	TABLE_EXCEPTION_GUARD_END
 }
 
+/// Enroll, disenroll and activate are applied by each row, not batched as
+/// policy updates are, so a failed statement does not roll them back.
 QueryData PolicyAdminTable::insert(QueryContext&, const PluginRequest& request)
 {
 	TABLE_EXCEPTION_GUARD_START
@@ -130,8 +132,9 @@ QueryData PolicyAdminTable::update(QueryContext&, const PluginRequest& request)
 
 	INFO(VIST) << "Update query about policy-admin table.";
 
-	auto name = Parser::column<std::string>(request, 0);
-	auto activated = Parser::column<int>(request, 1);
+	ParsedRequest values(request);
+	auto name = values.column<std::string>(0);
+	auto activated = values.column<int>(1);
 
 	vist::policy::API::Admin::Activate(name, activated);
 
@@ -18,6 +18,7 @@
 
 #include <vist/exception.hpp>
 #include <vist/logger.hpp>
+#include <vist/notification/notification.hpp>
 #include <vist/policy/api.hpp>
 #include <vist/table/builder.hpp>
 #include <vist/table/parser.hpp>
@@ -26,6 +27,8 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace vist {
 namespace table {
@@ -41,6 +44,20 @@ Row convert(const std::string& name, const vist::policy::PolicyValue& value)
 	return r;
 }
 
+/// Updates of the running statement, which are called by the same thread.
+struct Pending {
+	bool running = false;
+	std::vector<std::pair<std::string, vist::policy::PolicyValue>> changes;
+
+	void reset()
+	{
+		this->running = false;
+		this->changes.clear();
+	}
+};
+
+thread_local Pending pending;
+
 } // anonymous namespace
 
 void PolicyTable::Init()
@@ -64,10 +81,11 @@ QueryData PolicyTable::select(QueryContext& context)
 
 	QueryData results;
 	if (context.constraints["name"].exists(EQUALS)) { /// where clause
-		auto names = context.constraints["name"].getAll(EQUALS);
-		for (const auto& name : names) {
-			auto value = vist::policy::API::Get(name);
-			auto row = convert(name, value);
+		auto constraints = context.constraints["name"].getAll(EQUALS);
+		std::vector<std::string> names(constraints.begin(), constraints.end());
+		auto values = vist::policy::API::GetMany(names);
+		for (std::size_t i = 0; i < names.size(); i++) {
+			auto row = convert(names[i], values[i]);
 
 			results.emplace_back(std::move(row));
 		}
@@ -91,15 +109,71 @@ QueryData PolicyTable::update(QueryContext&, const PluginRequest& request)
 
 	INFO(VIST) << "Update query about policy table.";
 
-	auto name = Parser::column<std::string>(request, 0);
-	auto dumpedValue = Parser::column<std::string>(request, 1);
+	ParsedRequest values(request);
+	auto name = values.column<std::string>(0);
+	auto dumpedValue = values.column<std::string>(1);
+
+	vist::policy::PolicyValue value(dumpedValue, true);
+	if (pending.running) {
+		pending.changes.emplace_back(std::move(name), std::move(value));
+		return success();
+	}
+
+	vist::policy::API::Admin::Set(name, value);
 
-	vist::policy::API::Admin::Set(name, vist::policy::PolicyValue(dumpedValue, true));
+	/// Async subscribers are dispatched off this path.
+	Notification::instance().emit("policy", convert(name, value));
 
 	return success();
 
 	TABLE_EXCEPTION_GUARD_END
 }
 
+Status PolicyTable::begin()
+{
+	pending.reset();
+	pending.running = true;
+
+	return Status::success();
+}
+
+Status PolicyTable::sync()
+{
+	if (pending.changes.empty())
+		return Status::success();
+
+	try {
+		INFO(VIST) << "Apply " << pending.changes.size() << "-policies at once.";
+		vist::policy::API::Admin::SetMany(pending.changes);
+	} catch (const std::exception& e) {
+		ERROR(VIST) << "Failed to apply policies: " << e.what();
+		return Status::failure(e.what());
+	}
+
+	return Status::success();
+}
+
+Status PolicyTable::commit()
+{
+	/// The changed policies are notified once, after all of them are applied.
+	if (!pending.changes.empty()) {
+		Rows rows;
+		rows.reserve(pending.changes.size());
+		for (const auto& [name, value] : pending.changes)
+			rows.emplace_back(convert(name, value));
+
+		Notification::instance().emitBatch("policy", rows);
+	}
+
+	pending.reset();
+	return Status::success();
+}
+
+Status PolicyTable::rollback()
+{
+	pending.reset();
+	return Status::success();
+}
+
 } // namespace table
 } // namespace vist
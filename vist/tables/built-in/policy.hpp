@@ -29,6 +29,12 @@ private:
 	TableColumns columns() const override;
 	QueryData select(QueryContext&) override;
 	QueryData update(QueryContext&, const PluginRequest& request) override;
+
+	/// Updates of a statement are applied in a single transaction.
+	Status begin() override;
+	Status sync() override;
+	Status commit() override;
+	Status rollback() override;
 };
 
 } // namespace table
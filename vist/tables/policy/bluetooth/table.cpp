@@ -39,10 +39,9 @@ void setPolicy(const std::string& name, int value)
 	vist::policy::API::Admin::Set(name, vist::policy::PolicyValue(value));
 }
 
-std::string getPolicy(const std::string& name)
+std::string dump(const vist::policy::PolicyValue& value)
 {
-	int value = vist::policy::API::Get(name);
-	return std::to_string(value);
+	return std::to_string(static_cast<int>(value));
 }
 
 } // anonymous namespace
@@ -85,12 +84,18 @@ QueryData BluetoothTable::select(QueryContext&)
 	using namespace policy;
 	// Policy name format: bluetooth-xxx
 	// Virtual table column name formant: xxx
+	auto values = API::GetMany({
+		GetPolicyName(Bluetooth::State),
+		GetPolicyName(Bluetooth::DesktopConnectivity),
+		GetPolicyName(Bluetooth::Pairing),
+		GetPolicyName(Bluetooth::Tethering)
+	});
+
 	Row row;
-	row[Bluetooth::State.name] = getPolicy(GetPolicyName(Bluetooth::State));
-	row[Bluetooth::DesktopConnectivity.name] =
-		getPolicy(GetPolicyName(Bluetooth::DesktopConnectivity));
-	row[Bluetooth::Pairing.name] = getPolicy(GetPolicyName(Bluetooth::Pairing));
-	row[Bluetooth::Tethering.name] = getPolicy(GetPolicyName(Bluetooth::Tethering));
+	row[Bluetooth::State.name] = dump(values[0]);
+	row[Bluetooth::DesktopConnectivity.name] = dump(values[1]);
+	row[Bluetooth::Pairing.name] = dump(values[2]);
+	row[Bluetooth::Tethering.name] = dump(values[3]);
 
 	QueryData results;
 	results.emplace_back(std::move(row));
@@ -108,10 +113,11 @@ QueryData BluetoothTable::update(QueryContext&, const PluginRequest& request)
 
 	using namespace schema;
 	using namespace policy;
-	setPolicy(GetPolicyName(Bluetooth::State), Parser::column<int>(request, 0));
-	setPolicy(GetPolicyName(Bluetooth::DesktopConnectivity), Parser::column<int>(request, 1));
-	setPolicy(GetPolicyName(Bluetooth::Pairing), Parser::column<int>(request, 2));
-	setPolicy(GetPolicyName(Bluetooth::Tethering), Parser::column<int>(request, 3));
+	ParsedRequest values(request);
+	setPolicy(GetPolicyName(Bluetooth::State), values.column<int>(0));
+	setPolicy(GetPolicyName(Bluetooth::DesktopConnectivity), values.column<int>(1));
+	setPolicy(GetPolicyName(Bluetooth::Pairing), values.column<int>(2));
+	setPolicy(GetPolicyName(Bluetooth::Tethering), values.column<int>(3));
 
 	return success();
 
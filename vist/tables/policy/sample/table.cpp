@@ -82,8 +82,9 @@ QueryData SamplePolicyTable::update(QueryContext&, const PluginRequest& request)
 
 	INFO(VIST) << "Update query about sample-policy table.";
 
-	auto intPolicy = Parser::column<int>(request, 0);
-	auto strPolicy = Parser::column<std::string>(request, 1);
+	ParsedRequest values(request);
+	auto intPolicy = values.column<int>(0);
+	auto strPolicy = values.column<std::string>(1);
 
 	policy::API::Admin::Set("sample_int_policy", policy::PolicyValue(intPolicy));
 	policy::API::Admin::Set("sample_str_policy", policy::PolicyValue(strPolicy));